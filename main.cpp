@@ -1,12 +1,69 @@
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QMessageBox>
 #include <QWidget>
 
 #include "controllers/Navigation.h"
+#include "ui/BoardView.h"
+
+namespace {
+
+// Opens game `id` (or the first game) of a replay journal in a BoardView.
+BoardView *openReplay(const QString &journalPath, const QString &id, QString &errorMessage)
+{
+    model::ReplayJournalReader reader;
+    if (!reader.open(journalPath, errorMessage)) {
+        return nullptr;
+    }
+
+    model::ReplayGame game;
+    while (reader.next(game, errorMessage)) {
+        if (id.isEmpty() || game.id == id.toULongLong()) {
+            auto *view = new BoardView(QStringLiteral("A"), QStringLiteral("B"), game.scenarioPath);
+            if (!view->loadReplay(game, -1, errorMessage)) {
+                delete view;
+                return nullptr;
+            }
+            return view;
+        }
+    }
+    if (errorMessage.isEmpty()) {
+        errorMessage = QStringLiteral("No game %1 in %2").arg(id, journalPath);
+    }
+    return nullptr;
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
     QApplication app(argc, argv);
 
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    const QCommandLineOption replayOption(QStringLiteral("replay"), QStringLiteral("Show a game from a replay journal."), QStringLiteral("journal"));
+    const QCommandLineOption gameOption(QStringLiteral("game"), QStringLiteral("Game id within the journal (default: the first)."), QStringLiteral("id"));
+    const QCommandLineOption overlayOption(QStringLiteral("dev-overlay"), QStringLiteral("Show frame-time and input-latency timings on the board (F3 toggles, F4 exports CSV)."));
+    parser.addOption(replayOption);
+    parser.addOption(gameOption);
+    parser.addOption(overlayOption);
+    parser.process(app);
+
+    BoardView::setDeveloperOverlayDefault(parser.isSet(overlayOption));
+
+    if (parser.isSet(replayOption)) {
+        QString errorMessage;
+        BoardView *view = openReplay(parser.value(replayOption), parser.value(gameOption), errorMessage);
+        if (view == nullptr) {
+            QMessageBox::critical(nullptr, QStringLiteral("Undaunted"), errorMessage);
+            return 1;
+        }
+        view->setAttribute(Qt::WA_DeleteOnClose);
+        view->setWindowTitle("Undaunted - Replay");
+        view->show();
+        return app.exec();
+    }
+
     Navigation navigation;
 
     QWidget *window = navigation.window();
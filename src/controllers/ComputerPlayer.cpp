@@ -0,0 +1,143 @@
+#include "ComputerPlayer.h"
+
+#include <QMetaObject>
+#include <QThread>
+
+#include <algorithm>
+
+ComputerPlayer::ComputerPlayer(QObject *parent)
+    : QObject(parent)
+{
+}
+
+ComputerPlayer::~ComputerPlayer()
+{
+    stopWorker();
+    // Stopped searches still post back to this object; let them all return
+    // before it goes away.
+    for (QThread *thread : findChildren<QThread *>(QString(), Qt::FindDirectChildrenOnly)) {
+        thread->wait();
+    }
+}
+
+bool ComputerPlayer::setBoard(const model::BoardState &boardState, QString &errorMessage)
+{
+    cancel();
+
+    tablebase.reset();
+    auto packed = std::make_shared<model::PackedBoard>();
+    if (!model::buildPackedBoard(boardState, *packed, errorMessage)) {
+        board.reset();
+        return false;
+    }
+    board = std::move(packed);
+    return true;
+}
+
+bool ComputerPlayer::loadTablebase(const QString &path, QString &errorMessage)
+{
+    cancel();
+    tablebase.reset();
+
+    if (!board) {
+        errorMessage = tr("Computer player has no board.");
+        return false;
+    }
+
+    auto loaded = std::make_shared<model::Tablebase>();
+    if (!loaded->open(path, *board, errorMessage)) {
+        return false;
+    }
+    tablebase = std::move(loaded);
+    return true;
+}
+
+void ComputerPlayer::setThinkTime(qint64 milliseconds)
+{
+    options.timeMs = std::max<qint64>(milliseconds, 1);
+}
+
+bool ComputerPlayer::isThinking() const
+{
+    return thinking;
+}
+
+void ComputerPlayer::startTurn(const model::GameState &state)
+{
+    cancel();
+
+    if (!board) {
+        emit failed(tr("Computer player has no board."));
+        return;
+    }
+
+    model::PackedState snapshot;
+    QString error;
+    if (!model::packGameState(state, *board, snapshot, error)) {
+        emit failed(error);
+        return;
+    }
+
+    const quint64 turnId = ++currentTurnId;
+    const std::shared_ptr<const model::PackedBoard> searchBoard = board;
+    // The worker holds its own references, so a board or tablebase swap on
+    // the GUI thread cannot pull the data out from under a running search.
+    const std::shared_ptr<const model::Tablebase> searchTablebase = tablebase;
+    const model::SearchOptions searchOptions = options;
+    cancelFlag = std::make_shared<std::atomic_bool>(false);
+    const std::shared_ptr<std::atomic_bool> flag = cancelFlag;
+
+    thinking = true;
+    QThread *worker = QThread::create([this, turnId, searchBoard, searchTablebase, searchOptions, snapshot, flag]() {
+        const auto onProgress = [this, turnId, searchBoard](const model::SearchInfo &info) {
+            const QString text = model::actionText(model::toGameAction(*searchBoard, info.action));
+            QMetaObject::invokeMethod(this, [this, turnId, info, text]() {
+                if (turnId == currentTurnId && thinking) {
+                    emit progress(info.depth, text, info.score, info.nodes);
+                }
+            }, Qt::QueuedConnection);
+        };
+
+        model::SearchOptions withTablebase = searchOptions;
+        withTablebase.tablebase = searchTablebase.get();
+        const model::SearchInfo result =
+            model::searchBestAction(*searchBoard, snapshot, withTablebase, flag.get(), onProgress);
+        QMetaObject::invokeMethod(this, [this, turnId, result]() {
+            finishTurn(turnId, result);
+        }, Qt::QueuedConnection);
+    });
+    // A finished or abandoned search deletes its own thread.
+    worker->setParent(this);
+    connect(worker, &QThread::finished, worker, &QObject::deleteLater);
+    worker->start();
+}
+
+void ComputerPlayer::cancel()
+{
+    thinking = false;
+    stopWorker();
+}
+
+void ComputerPlayer::stopWorker()
+{
+    // Never blocks the GUI thread on a search: it stops at its next poll of
+    // the flag, and its result is dropped because the turn id has moved on or
+    // thinking is false.
+    if (cancelFlag) {
+        cancelFlag->store(true);
+    }
+}
+
+void ComputerPlayer::finishTurn(quint64 turnId, const model::SearchInfo &info)
+{
+    if (turnId != currentTurnId || !thinking) {
+        return;
+    }
+
+    thinking = false;
+    if (!info.hasAction) {
+        emit failed(tr("Computer player found no legal action."));
+        return;
+    }
+    emit actionChosen(model::toGameAction(*board, info.action));
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+
+#include "game/GameModel.h"
+#include "game/ai/Search.h"
+#include "game/ai/Tablebase.h"
+
+#include <atomic>
+#include <memory>
+
+// Runs the expectimax search for one side on a background thread. The search
+// works on a PackedState snapshot, so the GUI thread keeps owning gameState;
+// results come back through queued calls and are dropped if the turn was
+// cancelled or superseded in the meantime. Cancelling never waits for the
+// search thread; only the destructor does.
+class ComputerPlayer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ComputerPlayer(QObject *parent = nullptr);
+    ~ComputerPlayer() override;
+
+    bool setBoard(const model::BoardState &board, QString &errorMessage);
+    // Must be called after setBoard(); the file has to match that board.
+    bool loadTablebase(const QString &path, QString &errorMessage);
+    void setThinkTime(qint64 milliseconds);
+
+    bool isThinking() const;
+    void startTurn(const model::GameState &state);
+    void cancel();
+
+signals:
+    void progress(int depth, const QString &bestAction, int score, qint64 nodes);
+    void actionChosen(const model::GameAction &action);
+    void failed(const QString &message);
+
+private:
+    void stopWorker();
+    void finishTurn(quint64 turnId, const model::SearchInfo &info);
+
+    std::shared_ptr<const model::PackedBoard> board;
+    std::shared_ptr<const model::Tablebase> tablebase;
+    model::SearchOptions options;
+
+    std::shared_ptr<std::atomic_bool> cancelFlag;
+    quint64 currentTurnId{0};
+    bool thinking{false};
+};
@@ -35,8 +35,8 @@ void Navigation::setupConnections()
         login->setFocus();
     });
 
-    connect(login, &LoginScreen::startRequested, this, [this](const QString &p1, const QString &p2, const QString &map) {
-        auto *boardView = new BoardView(p1, p2, map);
+    connect(login, &LoginScreen::startRequested, this, [this](const QString &p1, const QString &p2, const QString &map, bool vsComputer) {
+        auto *boardView = new BoardView(p1, p2, map, vsComputer);
         boardView->setAttribute(Qt::WA_DeleteOnClose, true);
         boardView->setWindowTitle("Undaunted - Battle");
         boardView->resize(1200, 800);
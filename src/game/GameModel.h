@@ -1,16 +1,38 @@
 #pragma once
 
 #include "agents/AgentBehavior.h"
+#include "archive/GameArchive.h"
+#include "ai/EndgameSolver.h"
+#include "ai/Evaluation.h"
+#include "ai/Features.h"
+#include "ai/Network.h"
+#include "ai/Search.h"
+#include "ai/Tablebase.h"
 #include "board/BoardGraph.h"
 #include "actions/Combat.h"
+#include "actions/LegalActions.h"
 #include "actions/Movement.h"
 #include "actions/TacticalActions.h"
 #include "model/Init.h"
+#include "model/PackedState.h"
 #include "model/Types.h"
+#include "rules/PackedRules.h"
 #include "rules/Victory.h"
 #include "scenario/ScenarioLoader.h"
 #include "session/SessionTypes.h"
 #include "session/TurnEngine.h"
 #include "session/GameSession.h"
 #include "session/ActionCommand.h"
+#include "protocol/EngineProtocol.h"
+#include "protocol/WireProtocol.h"
+#include "replay/ReplayJournal.h"
+#include "replay/Replayer.h"
+#include "replay/ReplayTimeline.h"
+#include "sim/BalanceAnalyzer.h"
+#include "sim/BatchPlayout.h"
+#include "sim/FeatureExport.h"
+#include "sim/Perft.h"
+#include "sim/SelfPlay.h"
+#include "sim/SpsaTuner.h"
+#include "sim/Tournament.h"
 #include "turn/TurnSystem.h"
@@ -157,12 +157,12 @@ int computeAttackThresholdInternal(const GameState &state,
     return threshold;
 }
 
-} // namespace
-
-AttackResult attack(GameState &state,
-                    PlayerId attackerOwner,
-                    AgentType attackerType,
-                    const QString &targetCellId)
+AttackResult resolveAttackInternal(GameState &state,
+                                   PlayerId attackerOwner,
+                                   AgentType attackerType,
+                                   const QString &targetCellId,
+                                   QRandomGenerator *rng,
+                                   const QVector<int> &presetRolls)
 {
     AttackResult result;
     result.attackerOwner = attackerOwner;
@@ -199,12 +199,24 @@ AttackResult attack(GameState &state,
     }
 
     const int diceCount = behavior->attackDiceCount();
+    if (rng == nullptr && presetRolls.size() != diceCount) {
+        result.errorMessage = QStringLiteral("%1 attacks with %2 dice, got %3 rolls.")
+                                  .arg(agentTypeName(attackerType))
+                                  .arg(diceCount)
+                                  .arg(presetRolls.size());
+        return result;
+    }
+
     result.rolls.reserve(diceCount);
     bool success = false;
 
-    auto *rng = QRandomGenerator::global();
     for (int i = 0; i < diceCount; ++i) {
-        const int roll = rng->bounded(1, 11);
+        const int roll = rng != nullptr ? rng->bounded(1, 11) : presetRolls[i];
+        if (roll < 1 || roll > 10) {
+            result.rolls.clear();
+            result.errorMessage = QStringLiteral("Invalid die roll: %1").arg(roll);
+            return result;
+        }
         result.rolls.push_back(roll);
         if (roll >= threshold) {
             success = true;
@@ -242,4 +254,50 @@ AttackResult attack(GameState &state,
     return result;
 }
 
+} // namespace
+
+bool canAttack(const GameState &state,
+               PlayerId attackerOwner,
+               AgentType attackerType,
+               const QString &targetCellId,
+               QString &errorMessage)
+{
+    return canAttackInternal(state, attackerOwner, attackerType, targetCellId, errorMessage);
+}
+
+AttackResult attack(GameState &state,
+                    PlayerId attackerOwner,
+                    AgentType attackerType,
+                    const QString &targetCellId)
+{
+    return attack(state, attackerOwner, attackerType, targetCellId, *QRandomGenerator::global());
+}
+
+AttackResult attack(GameState &state,
+                    PlayerId attackerOwner,
+                    AgentType attackerType,
+                    const QString &targetCellId,
+                    QRandomGenerator &rng)
+{
+    return resolveAttackInternal(state, attackerOwner, attackerType, targetCellId, &rng, QVector<int>());
+}
+
+AttackResult attackWithRolls(GameState &state,
+                             PlayerId attackerOwner,
+                             AgentType attackerType,
+                             const QString &targetCellId,
+                             const QVector<int> &rolls)
+{
+    return resolveAttackInternal(state, attackerOwner, attackerType, targetCellId, nullptr, rolls);
+}
+
+int attackThreshold(const GameState &state,
+                    PlayerId attackerOwner,
+                    AgentType attackerType,
+                    const QString &targetCellId,
+                    QString &errorMessage)
+{
+    return computeAttackThresholdInternal(state, attackerOwner, attackerType, targetCellId, errorMessage);
+}
+
 } // namespace model
@@ -2,6 +2,8 @@
 
 #include "../model/Types.h"
 
+class QRandomGenerator;
+
 namespace model {
 
 struct AttackResult {
@@ -22,9 +24,35 @@ struct AttackResult {
     QString errorMessage;
 };
 
+bool canAttack(const GameState &state,
+               PlayerId attackerOwner,
+               AgentType attackerType,
+               const QString &targetCellId,
+               QString &errorMessage);
+
 AttackResult attack(GameState &state,
                     PlayerId attackerOwner,
                     AgentType attackerType,
                     const QString &targetCellId);
+AttackResult attack(GameState &state,
+                    PlayerId attackerOwner,
+                    AgentType attackerType,
+                    const QString &targetCellId,
+                    QRandomGenerator &rng);
+
+// Resolves an attack with caller-supplied dice (one per attack die, 1..10)
+// instead of rolling; used by replays and search.
+AttackResult attackWithRolls(GameState &state,
+                             PlayerId attackerOwner,
+                             AgentType attackerType,
+                             const QString &targetCellId,
+                             const QVector<int> &rolls);
+
+// Clamped attack threshold, or 0 with errorMessage set if the attack is illegal.
+int attackThreshold(const GameState &state,
+                    PlayerId attackerOwner,
+                    AgentType attackerType,
+                    const QString &targetCellId,
+                    QString &errorMessage);
 
 } // namespace model
@@ -0,0 +1,134 @@
+#include "LegalActions.h"
+
+#include "Combat.h"
+#include "Movement.h"
+
+#include "../board/BoardGraph.h"
+#include "../model/Init.h"
+
+namespace model {
+
+bool GameAction::operator==(const GameAction &other) const
+{
+    if (kind != other.kind) {
+        return false;
+    }
+    if (kind == ActionKind::Special) {
+        return special == other.special;
+    }
+    return cellId == other.cellId;
+}
+
+bool GameAction::operator!=(const GameAction &other) const
+{
+    return !(*this == other);
+}
+
+QVector<GameAction> legalActions(const GameState &state)
+{
+    QVector<GameAction> actions;
+    if (state.status != GameStatus::InProgress || !state.turn.hasActiveCard) {
+        return actions;
+    }
+
+    const PlayerId owner = state.turn.currentPlayer;
+    const AgentType type = state.turn.activeCard.agent;
+    const PlayerState *player = playerById(state, owner);
+    const PlayerState *enemy = playerById(state, opponentOf(owner));
+    const AgentBehavior *behavior = behaviorFor(type);
+    if (player == nullptr || enemy == nullptr || behavior == nullptr) {
+        return actions;
+    }
+
+    const AgentState *agent = findAgent(*player, type);
+    if (agent == nullptr || !agent->alive || agent->cellId.isEmpty()) {
+        return actions;
+    }
+
+    QString error;
+    const CellNode *from = findCell(state.board, agent->cellId);
+    if (from != nullptr) {
+        for (const CellNode *neighbor : from->neighbors) {
+            if (canMoveAgent(state, owner, type, neighbor->id, error)) {
+                actions.push_back(GameAction{ActionKind::Move, neighbor->id, AgentSpecialAction::ScoutMark});
+            }
+        }
+    }
+
+    for (const AgentState &target : enemy->agents) {
+        if (!target.alive || target.cellId.isEmpty()) {
+            continue;
+        }
+        if (canAttack(state, owner, type, target.cellId, error)) {
+            actions.push_back(GameAction{ActionKind::Attack, target.cellId, AgentSpecialAction::ScoutMark});
+        }
+    }
+
+    const AgentSpecialAction specials[] = {
+        AgentSpecialAction::ScoutMark,
+        AgentSpecialAction::SergeantControl,
+        AgentSpecialAction::SergeantRelease
+    };
+    for (AgentSpecialAction special : specials) {
+        if (behavior->supportsSpecial(special) &&
+            behavior->canExecuteSpecial(state, owner, special, error)) {
+            actions.push_back(GameAction{ActionKind::Special, QString(), special});
+        }
+    }
+
+    return actions;
+}
+
+QString actionText(const GameAction &action)
+{
+    switch (action.kind) {
+    case ActionKind::Move:
+        return QStringLiteral("move %1").arg(action.cellId);
+    case ActionKind::Attack:
+        return QStringLiteral("attack %1").arg(action.cellId);
+    case ActionKind::Special:
+        switch (action.special) {
+        case AgentSpecialAction::ScoutMark:
+            return QStringLiteral("mark");
+        case AgentSpecialAction::SergeantControl:
+            return QStringLiteral("control");
+        case AgentSpecialAction::SergeantRelease:
+            return QStringLiteral("release");
+        }
+        break;
+    }
+    return QStringLiteral("unknown");
+}
+
+bool parseActionText(const QString &text, GameAction &out, QString &errorMessage)
+{
+    const QStringList parts = text.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    const QString verb = parts.value(0).toLower();
+
+    if ((verb == QLatin1String("move") || verb == QLatin1String("attack")) && parts.size() == 2) {
+        out = GameAction{verb == QLatin1String("move") ? ActionKind::Move : ActionKind::Attack,
+                         parts[1].toUpper(),
+                         AgentSpecialAction::ScoutMark};
+        return true;
+    }
+
+    if (parts.size() == 1) {
+        if (verb == QLatin1String("mark")) {
+            out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::ScoutMark};
+            return true;
+        }
+        if (verb == QLatin1String("control")) {
+            out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantControl};
+            return true;
+        }
+        if (verb == QLatin1String("release")) {
+            out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantRelease};
+            return true;
+        }
+    }
+
+    errorMessage = QStringLiteral("Invalid action: %1").arg(text.trimmed());
+    return false;
+}
+
+} // namespace model
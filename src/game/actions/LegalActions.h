@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../agents/AgentBehavior.h"
+
+namespace model {
+
+enum class ActionKind {
+    Move,
+    Attack,
+    Special
+};
+
+// Value form of one turn action. cellId is the move destination or attack
+// target; special is only meaningful for ActionKind::Special.
+struct GameAction {
+    ActionKind kind{ActionKind::Move};
+    QString cellId;
+    AgentSpecialAction special{AgentSpecialAction::ScoutMark};
+
+    bool operator==(const GameAction &other) const;
+    bool operator!=(const GameAction &other) const;
+};
+
+// All actions the current player can take with the active card, ordered as
+// moves (neighbour order), attacks (Scout, Sniper, Sergeant targets), specials.
+QVector<GameAction> legalActions(const GameState &state);
+
+QString actionText(const GameAction &action);
+
+// Inverse of actionText(): "move <cell>", "attack <cell>", "mark", "control"
+// or "release". Only the syntax is checked, not legality.
+bool parseActionText(const QString &text, GameAction &out, QString &errorMessage);
+
+} // namespace model
@@ -116,6 +116,11 @@ bool canMoveAgentInternal(const GameState &state, PlayerId owner, AgentType type
 
 } // namespace
 
+bool canMoveAgent(const GameState &state, PlayerId owner, AgentType type, const QString &toCellId, QString &errorMessage)
+{
+    return canMoveAgentInternal(state, owner, type, toCellId, errorMessage);
+}
+
 bool moveAgent(GameState &state, PlayerId owner, AgentType type, const QString &toCellId, QString &errorMessage)
 {
     if (!canMoveAgentInternal(state, owner, type, toCellId, errorMessage)) {
@@ -4,6 +4,7 @@
 
 namespace model {
 
+bool canMoveAgent(const GameState &state, PlayerId owner, AgentType type, const QString &toCellId, QString &errorMessage);
 bool moveAgent(GameState &state, PlayerId owner, AgentType type, const QString &toCellId, QString &errorMessage);
 
 } // namespace model
@@ -99,6 +99,11 @@ bool canScoutMarkInternal(const GameState &state, PlayerId owner, QString &error
     return true;
 }
 
+bool canScoutMark(const GameState &state, PlayerId owner, QString &errorMessage)
+{
+    return canScoutMarkInternal(state, owner, errorMessage);
+}
+
 bool scoutMark(GameState &state, PlayerId owner, QString &errorMessage)
 {
     if (!canScoutMarkInternal(state, owner, errorMessage)) {
@@ -148,6 +153,11 @@ bool canSergeantControlInternal(const GameState &state, PlayerId owner, QString
     return true;
 }
 
+bool canSergeantControl(const GameState &state, PlayerId owner, QString &errorMessage)
+{
+    return canSergeantControlInternal(state, owner, errorMessage);
+}
+
 bool sergeantControl(GameState &state, PlayerId owner, QString &errorMessage)
 {
     if (!canSergeantControlInternal(state, owner, errorMessage)) {
@@ -189,6 +199,11 @@ bool canSergeantReleaseInternal(const GameState &state, PlayerId owner, QString
     return true;
 }
 
+bool canSergeantRelease(const GameState &state, PlayerId owner, QString &errorMessage)
+{
+    return canSergeantReleaseInternal(state, owner, errorMessage);
+}
+
 bool sergeantRelease(GameState &state, PlayerId owner, QString &errorMessage)
 {
     if (!canSergeantReleaseInternal(state, owner, errorMessage)) {
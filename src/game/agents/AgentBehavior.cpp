@@ -39,6 +39,19 @@ public:
         return action == AgentSpecialAction::ScoutMark;
     }
 
+    bool canExecuteSpecial(const GameState &state,
+                           PlayerId owner,
+                           AgentSpecialAction action,
+                           QString &errorMessage) const override
+    {
+        if (action != AgentSpecialAction::ScoutMark) {
+            errorMessage = QStringLiteral("Scout does not support this special action.");
+            return false;
+        }
+
+        return canScoutMark(state, owner, errorMessage);
+    }
+
     bool executeSpecial(GameState &state,
                         PlayerId owner,
                         AgentSpecialAction action,
@@ -76,6 +89,12 @@ public:
         return false;
     }
 
+    bool canExecuteSpecial(const GameState &, PlayerId, AgentSpecialAction, QString &errorMessage) const override
+    {
+        errorMessage = QStringLiteral("Sniper has no special action.");
+        return false;
+    }
+
     bool executeSpecial(GameState &, PlayerId, AgentSpecialAction, QString &errorMessage) const override
     {
         errorMessage = QStringLiteral("Sniper has no special action.");
@@ -107,6 +126,22 @@ public:
                action == AgentSpecialAction::SergeantRelease;
     }
 
+    bool canExecuteSpecial(const GameState &state,
+                           PlayerId owner,
+                           AgentSpecialAction action,
+                           QString &errorMessage) const override
+    {
+        if (action == AgentSpecialAction::SergeantControl) {
+            return canSergeantControl(state, owner, errorMessage);
+        }
+        if (action == AgentSpecialAction::SergeantRelease) {
+            return canSergeantRelease(state, owner, errorMessage);
+        }
+
+        errorMessage = QStringLiteral("Sergeant does not support this special action.");
+        return false;
+    }
+
     bool executeSpecial(GameState &state,
                         PlayerId owner,
                         AgentSpecialAction action,
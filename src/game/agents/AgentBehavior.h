@@ -22,6 +22,10 @@ public:
     virtual int attackDiceCount() const = 0;
 
     virtual bool supportsSpecial(AgentSpecialAction action) const = 0;
+    virtual bool canExecuteSpecial(const GameState &state,
+                                   PlayerId owner,
+                                   AgentSpecialAction action,
+                                   QString &errorMessage) const = 0;
     virtual bool executeSpecial(GameState &state,
                                 PlayerId owner,
                                 AgentSpecialAction action,
@@ -0,0 +1,198 @@
+#include "EndgameSolver.h"
+
+#include "Evaluation.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cmath>
+
+namespace model {
+
+EndgameSolver::EndgameSolver(const PackedBoard &board, const EndgameSolveOptions &options)
+    : board_(board),
+      options_(options)
+{
+    firstEdge_.append(0);
+}
+
+bool EndgameSolver::addSeed(const PackedState &state)
+{
+    if (!isEndgamePosition(state, options_.maxCards)) {
+        return false;
+    }
+
+    const int stateCount = states_.size();
+    const int edgeCount = edges_.size();
+    seedStart_ = stateCount;
+    PackedState seed = state;
+    seed.turnIndex = 0;
+    if (indexState(seed) < 0) {
+        rollback(stateCount, edgeCount);
+        ++stats_.skippedSeeds;
+        return false;
+    }
+
+    // States are appended in discovery order, so expanding them in index
+    // order is a breadth-first walk of everything reachable from the seed.
+    for (int index = stateCount; index < states_.size(); ++index) {
+        const PackedState current = states_[index];
+        PackedAction actions[kMaxPackedActions];
+        const int count = packedLegalActions(board_, current, actions);
+        for (int i = 0; i < count; ++i) {
+            const PackedAction &action = actions[i];
+            Edge edge;
+
+            PackedState hitChild = current;
+            applyPackedAction(board_, hitChild, action, true);
+            edge.hit = outcome(hitChild);
+
+            if (action.kind == PackedActionKind::Attack) {
+                const int threshold = packedAttackThreshold(board_, current, action);
+                edge.hitPerMille = static_cast<quint16>(attackHitChance(packedAttackDice(current.activeCard), threshold));
+                PackedState missChild = current;
+                applyPackedAction(board_, missChild, action, false);
+                edge.miss = outcome(missChild);
+            } else {
+                edge.miss = edge.hit;
+            }
+
+            if (edge.hit == kOverBudget || edge.miss == kOverBudget) {
+                rollback(stateCount, edgeCount);
+                ++stats_.skippedSeeds;
+                return false;
+            }
+            edges_.append(edge);
+        }
+        firstEdge_.append(edges_.size());
+    }
+
+    ++stats_.seeds;
+    stats_.states = states_.size();
+    return true;
+}
+
+bool EndgameSolver::solve(const std::atomic_bool *cancel)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    values_.fill(0.0, states_.size());
+    stats_.iterations = 0;
+    stats_.residual = 0.0;
+
+    // Gauss-Seidel sweeps in reverse discovery order: later states tend to be
+    // closer to the end of the game, so their values propagate back faster.
+    for (int iteration = 0; iteration < options_.maxIterations; ++iteration) {
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+            stats_.elapsedMs = timer.elapsed();
+            return false;
+        }
+
+        double residual = 0.0;
+        for (int index = states_.size() - 1; index >= 0; --index) {
+            const int begin = firstEdge_[index];
+            const int end = firstEdge_[index + 1];
+            if (begin == end) {
+                continue;
+            }
+
+            double best = -1.0;
+            for (int e = begin; e < end; ++e) {
+                const Edge &edge = edges_[e];
+                const double p = edge.hitPerMille / 1000.0;
+                double value = p * outcomeValue(edge.hit);
+                if (edge.hitPerMille < 1000) {
+                    value += (1.0 - p) * outcomeValue(edge.miss);
+                }
+                best = std::max(best, value);
+            }
+            residual = std::max(residual, std::abs(best - values_[index]));
+            values_[index] = best;
+        }
+
+        stats_.iterations = iteration + 1;
+        stats_.residual = residual;
+        if (residual < options_.tolerance) {
+            break;
+        }
+    }
+
+    stats_.elapsedMs = timer.elapsed();
+    return true;
+}
+
+QVector<TablebaseEntry> EndgameSolver::entries() const
+{
+    QVector<TablebaseEntry> out;
+    out.reserve(states_.size());
+    for (int index = 0; index < states_.size(); ++index) {
+        const double value = index < values_.size() ? values_[index] : 0.0;
+        const double winProbability = std::clamp((value + 1.0) / 2.0, 0.0, 1.0);
+        out.append(TablebaseEntry{keys_[index], static_cast<quint16>(std::lround(winProbability * 65535.0))});
+    }
+    return out;
+}
+
+const EndgameSolveStats &EndgameSolver::stats() const
+{
+    return stats_;
+}
+
+// `child` has had the mover's action applied. Terminal results are returned
+// as codes; otherwise the turn is passed and the opponent's position indexed.
+int EndgameSolver::outcome(PackedState child)
+{
+    if (child.status != GameStatus::InProgress) {
+        const int winner = child.status == GameStatus::WonByA ? 0 : 1;
+        return winner == child.currentSide ? kMoverWins : kMoverLoses;
+    }
+
+    endPackedTurn(child);
+    drawPackedCard(child);
+    child.turnIndex = 0;
+    return indexState(child);
+}
+
+int EndgameSolver::indexState(const PackedState &state)
+{
+    const quint64 key = hashPackedState(state);
+    const auto found = indexByKey_.constFind(key);
+    if (found != indexByKey_.constEnd()) {
+        return found.value();
+    }
+    if (states_.size() >= options_.maxStates || states_.size() - seedStart_ >= options_.maxSeedStates) {
+        return kOverBudget;
+    }
+
+    const int index = states_.size();
+    states_.append(state);
+    keys_.append(key);
+    indexByKey_.insert(key, index);
+    return index;
+}
+
+// Value of an outcome for the side that chose it.
+double EndgameSolver::outcomeValue(int outcome) const
+{
+    if (outcome == kMoverWins) {
+        return 1.0;
+    }
+    if (outcome == kMoverLoses) {
+        return -1.0;
+    }
+    return -values_[outcome];
+}
+
+void EndgameSolver::rollback(int stateCount, int edgeCount)
+{
+    for (int index = stateCount; index < keys_.size(); ++index) {
+        indexByKey_.remove(keys_[index]);
+    }
+    states_.resize(stateCount);
+    keys_.resize(stateCount);
+    firstEdge_.resize(stateCount + 1);
+    edges_.resize(edgeCount);
+}
+
+} // namespace model
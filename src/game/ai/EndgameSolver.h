@@ -0,0 +1,78 @@
+#pragma once
+
+#include "Tablebase.h"
+#include "../rules/PackedRules.h"
+
+#include <atomic>
+
+namespace model {
+
+struct EndgameSolveOptions {
+    int maxCards{3};
+    // Seeds reaching more than maxSeedStates new positions, or pushing the
+    // total past maxStates, are skipped. A live Scout can mark any cell it
+    // walks over, so its endgames are usually far too large.
+    int maxStates{1000000};
+    int maxSeedStates{50000};
+    int maxIterations{10000};
+    double tolerance{1e-9};
+};
+
+struct EndgameSolveStats {
+    qint64 seeds{0};
+    qint64 skippedSeeds{0};
+    qint64 states{0};
+    int iterations{0};
+    double residual{0.0};
+    qint64 elapsedMs{0};
+};
+
+// Exact solver for single-agent duels. Every seed is expanded to the full set
+// of positions reachable from it; since agents can walk back and forth that
+// graph has cycles, so values are found by value iteration rather than by
+// backward induction. A game that never ends scores 1/2 for both sides.
+class EndgameSolver
+{
+public:
+    EndgameSolver(const PackedBoard &board, const EndgameSolveOptions &options);
+
+    // Returns false if the state is not covered or its closure is too large.
+    bool addSeed(const PackedState &state);
+
+    // Returns false if cancelled; values are then only partially converged.
+    bool solve(const std::atomic_bool *cancel = nullptr);
+
+    QVector<TablebaseEntry> entries() const;
+    const EndgameSolveStats &stats() const;
+
+private:
+    // Outcome codes: >= 0 is a state index, the rest are not expanded.
+    static constexpr int kMoverWins = -1;
+    static constexpr int kMoverLoses = -2;
+    static constexpr int kOverBudget = -3;
+
+    struct Edge {
+        quint16 hitPerMille{1000};
+        int hit{kMoverWins};
+        int miss{kMoverWins};
+    };
+
+    int indexState(const PackedState &state);
+    int outcome(PackedState child);
+    double outcomeValue(int outcome) const;
+    void rollback(int stateCount, int edgeCount);
+
+    const PackedBoard &board_;
+    EndgameSolveOptions options_;
+    EndgameSolveStats stats_;
+
+    QVector<PackedState> states_;
+    QVector<quint64> keys_;
+    QHash<quint64, int> indexByKey_;
+    QVector<int> firstEdge_;
+    QVector<Edge> edges_;
+    QVector<double> values_;
+    int seedStart_{0};
+};
+
+} // namespace model
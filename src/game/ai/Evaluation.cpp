@@ -0,0 +1,261 @@
+#include "Evaluation.h"
+
+#include "../rules/PackedRules.h"
+#include "../rules/Victory.h"
+
+#include <QFile>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+struct WeightField {
+    const char *key;
+    int EvalWeights::*member;
+};
+
+const WeightField kWeightFields[] = {
+    {"control_cell", &EvalWeights::controlCell},
+    {"control_near_win", &EvalWeights::controlNearWin},
+    {"agent_alive", &EvalWeights::agentAlive},
+    {"scout_card", &EvalWeights::scoutCard},
+    {"sniper_card", &EvalWeights::sniperCard},
+    {"sergeant_card", &EvalWeights::sergeantCard},
+    {"sniper_mobility", &EvalWeights::sniperMobility},
+    {"sergeant_mobility", &EvalWeights::sergeantMobility},
+    {"exposure", &EvalWeights::exposure},
+    {"exposure_lethal", &EvalWeights::exposureLethal},
+    {"side_to_move", &EvalWeights::sideToMove},
+};
+
+struct HitChanceTable {
+    int perMille[4][11]{};
+
+    HitChanceTable()
+    {
+        for (int dice = 1; dice <= 3; ++dice) {
+            for (int threshold = 1; threshold <= 10; ++threshold) {
+                int missNumerator = 1;
+                int denominator = 1;
+                for (int i = 0; i < dice; ++i) {
+                    missNumerator *= threshold - 1;
+                    denominator *= 10;
+                }
+                perMille[dice][threshold] = 1000 - (missNumerator * 1000) / denominator;
+            }
+        }
+    }
+};
+
+const HitChanceTable kHitChance;
+
+// Cards left for an agent type, counting the active card of the side to move.
+int cardsLeft(const PackedState &state, int side, int type)
+{
+    int cards = state.sides[side].cardCount[type];
+    if (state.hasActiveCard && state.currentSide == side && state.activeCard == type) {
+        ++cards;
+    }
+    return cards;
+}
+
+int cardWeight(const EvalWeights &weights, int type)
+{
+    switch (static_cast<AgentType>(type)) {
+    case AgentType::Scout:
+        return weights.scoutCard;
+    case AgentType::Sniper:
+        return weights.sniperCard;
+    case AgentType::Sergeant:
+        return weights.sergeantCard;
+    }
+    return 0;
+}
+
+int sideScore(const PackedBoard &board,
+              const PackedState &state,
+              int side,
+              const CellMask &occupied,
+              const EvalWeights &weights)
+{
+    const PackedSide &own = state.sides[side];
+    const PackedSide &enemy = state.sides[side ^ 1];
+    int score = 0;
+
+    const int control = own.control.count();
+    score += weights.controlCell * control;
+    score += weights.controlNearWin / std::max(1, kControlCellsToWin - control);
+
+    score += weights.agentAlive * int(qPopulationCount(own.aliveMask));
+
+    for (int type = 0; type < kAgentTypeCount; ++type) {
+        score += cardWeight(weights, type) * cardsLeft(state, side, type);
+    }
+
+    const CellMask freeMarked = own.marks & ~occupied;
+    const qint8 sniperCell = own.agentCell[static_cast<int>(AgentType::Sniper)];
+    if (sniperCell != kNoCell) {
+        score += weights.sniperMobility * (board.neighbors[sniperCell] & freeMarked).count();
+    }
+    const qint8 sergeantCell = own.agentCell[static_cast<int>(AgentType::Sergeant)];
+    if (sergeantCell != kNoCell) {
+        score += weights.sergeantMobility * (board.neighbors[sergeantCell] & freeMarked).count();
+    }
+
+    // Exposure: the best hit chance any enemy agent has against each of ours.
+    for (int target = 0; target < kAgentTypeCount; ++target) {
+        const qint8 targetCell = own.agentCell[target];
+        if (targetCell == kNoCell) {
+            continue;
+        }
+
+        int worst = 0;
+        for (int attacker = 0; attacker < kAgentTypeCount; ++attacker) {
+            const qint8 attackerCell = enemy.agentCell[attacker];
+            if (attackerCell == kNoCell || !board.reachable[attackerCell].test(targetCell)) {
+                continue;
+            }
+            const int threshold =
+                std::clamp(board.pathShield[attackerCell][targetCell] + own.hp[target], 1, 10);
+            worst = std::max(worst, kHitChance.perMille[packedAttackDice(attacker)][threshold]);
+        }
+
+        const int penalty = cardsLeft(state, side, target) <= 1 ? weights.exposureLethal : weights.exposure;
+        score -= (penalty * worst) / 1000;
+    }
+
+    return score;
+}
+
+} // namespace
+
+bool loadEvalWeights(EvalWeights &weights, const QString &path, QString &errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errorMessage = QStringLiteral("Cannot open weights file: %1").arg(path);
+        return false;
+    }
+
+    EvalWeights loaded;
+    QTextStream in(&file);
+    int lineNo = 0;
+
+    while (!in.atEnd()) {
+        ++lineNo;
+        const QString rawLine = in.readLine().section(QLatin1Char('#'), 0, 0).trimmed();
+        if (rawLine.isEmpty()) {
+            continue;
+        }
+
+        const int sep = rawLine.indexOf(QLatin1Char(':'));
+        if (sep <= 0) {
+            errorMessage = QStringLiteral("Invalid weights line %1: %2").arg(lineNo).arg(rawLine);
+            return false;
+        }
+
+        const QString key = rawLine.left(sep).trimmed().toLower();
+        bool ok = false;
+        const int value = rawLine.mid(sep + 1).trimmed().toInt(&ok);
+        if (!ok) {
+            errorMessage = QStringLiteral("Invalid weight value at line %1: %2").arg(lineNo).arg(rawLine);
+            return false;
+        }
+
+        const auto field = std::find_if(std::begin(kWeightFields), std::end(kWeightFields),
+                                        [&key](const WeightField &f) {
+                                            return key == QLatin1String(f.key);
+                                        });
+        if (field == std::end(kWeightFields)) {
+            errorMessage = QStringLiteral("Unknown weight at line %1: %2").arg(lineNo).arg(key);
+            return false;
+        }
+        loaded.*(field->member) = value;
+    }
+
+    weights = loaded;
+    return true;
+}
+
+bool saveEvalWeights(const EvalWeights &weights, const QString &path, QString &errorMessage)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorMessage = QStringLiteral("Cannot write weights file: %1").arg(path);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "# Static evaluation weights (key: integer value).\n";
+    for (const WeightField &field : kWeightFields) {
+        out << field.key << ": " << weights.*(field.member) << '\n';
+    }
+    out.flush();
+
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("Failed to write weights file: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+QStringList evalWeightKeys()
+{
+    QStringList keys;
+    for (const WeightField &field : kWeightFields) {
+        keys.append(QLatin1String(field.key));
+    }
+    return keys;
+}
+
+QVector<int> evalWeightValues(const EvalWeights &weights)
+{
+    QVector<int> values;
+    for (const WeightField &field : kWeightFields) {
+        values.append(weights.*(field.member));
+    }
+    return values;
+}
+
+EvalWeights evalWeightsFromValues(const QVector<int> &values)
+{
+    EvalWeights weights;
+    int index = 0;
+    for (const WeightField &field : kWeightFields) {
+        if (index < values.size()) {
+            weights.*(field.member) = values[index];
+        }
+        ++index;
+    }
+    return weights;
+}
+
+int attackHitChance(int diceCount, int threshold)
+{
+    return kHitChance.perMille[std::clamp(diceCount, 1, 3)][std::clamp(threshold, 1, 10)];
+}
+
+int evaluatePosition(const PackedBoard &board,
+                     const PackedState &state,
+                     int side,
+                     const EvalWeights &weights)
+{
+    if (state.status == GameStatus::WonByA) {
+        return side == 0 ? kEvalWinScore : -kEvalWinScore;
+    }
+    if (state.status == GameStatus::WonByB) {
+        return side == 1 ? kEvalWinScore : -kEvalWinScore;
+    }
+
+    const CellMask occupied = packedOccupiedCells(state);
+    int score = sideScore(board, state, side, occupied, weights) -
+                sideScore(board, state, side ^ 1, occupied, weights);
+    score += state.currentSide == side ? weights.sideToMove : -weights.sideToMove;
+    return score;
+}
+
+} // namespace model
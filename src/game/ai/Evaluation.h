@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../model/PackedState.h"
+
+namespace model {
+
+constexpr int kEvalWinScore = 100000;
+
+struct EvalWeights {
+    int controlCell{40};
+    int controlNearWin{160};
+    int agentAlive{260};
+    int scoutCard{30};
+    int sniperCard{45};
+    int sergeantCard{35};
+    int sniperMobility{6};
+    int sergeantMobility{8};
+    int exposure{90};
+    int exposureLethal{140};
+    int sideToMove{12};
+};
+
+bool loadEvalWeights(EvalWeights &weights, const QString &path, QString &errorMessage);
+bool saveEvalWeights(const EvalWeights &weights, const QString &path, QString &errorMessage);
+
+// The weights as a vector in file order, for tools that tune them.
+QStringList evalWeightKeys();
+QVector<int> evalWeightValues(const EvalWeights &weights);
+EvalWeights evalWeightsFromValues(const QVector<int> &values);
+
+// Hit chance in per-mille for an attack with the given dice count and threshold.
+int attackHitChance(int diceCount, int threshold);
+
+// Static score of the position from the point of view of `side` (0 = A, 1 = B).
+// Terminal positions return +/- kEvalWinScore.
+int evaluatePosition(const PackedBoard &board,
+                     const PackedState &state,
+                     int side,
+                     const EvalWeights &weights);
+
+} // namespace model
@@ -0,0 +1,164 @@
+#include "Features.h"
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+constexpr int kPlaneSize = kFeatureRows * kFeatureCols;
+constexpr int kScalarBase = kFeaturePlanes * kPlaneSize;
+// Scalar offsets; see encodeFeatures().
+constexpr int kScalarActiveCard = kScalarBase + 1;
+constexpr int kScalarSides = kScalarActiveCard + kAgentTypeCount;
+
+int planeIndex(const PackedBoard &board, int plane, int cell)
+{
+    return plane * kPlaneSize + board.row[cell] * kFeatureCols + board.col[cell];
+}
+
+class ChangeList
+{
+public:
+    explicit ChangeList(FeatureChange *out)
+        : out(out)
+    {
+    }
+
+    void add(int index, int delta)
+    {
+        if (delta == 0) {
+            return;
+        }
+        if (count < kMaxFeatureChanges) {
+            out[count] = FeatureChange{static_cast<qint16>(index), static_cast<qint8>(delta)};
+        }
+        ++count;
+    }
+
+    void addMask(const PackedBoard &board, int plane, const CellMask &from, const CellMask &to)
+    {
+        for (int word = 0; word < 2; ++word) {
+            quint64 changed = from.words[word] ^ to.words[word];
+            while (changed != 0) {
+                const int bit = qCountTrailingZeroBits(changed);
+                changed &= changed - 1;
+                const int cell = word * 64 + bit;
+                add(planeIndex(board, plane, cell), to.test(cell) ? 1 : -1);
+            }
+        }
+    }
+
+    int result() const
+    {
+        return count <= kMaxFeatureChanges ? count : -1;
+    }
+
+private:
+    FeatureChange *out;
+    int count{0};
+};
+
+int activeCardFeature(const PackedState &state)
+{
+    return state.hasActiveCard ? kScalarActiveCard + state.activeCard : -1;
+}
+
+} // namespace
+
+bool boardFitsFeatures(const PackedBoard &board, QString &errorMessage)
+{
+    for (int i = 0; i < board.cellCount; ++i) {
+        if (board.row[i] >= kFeatureRows || board.col[i] >= kFeatureCols) {
+            errorMessage = QStringLiteral("Cell %1 lies outside the %2 x %3 feature grid.")
+                               .arg(board.cellIds[i])
+                               .arg(kFeatureRows)
+                               .arg(kFeatureCols);
+            return false;
+        }
+    }
+    return true;
+}
+
+void encodeFeatures(const PackedBoard &board, const PackedState &state, qint8 *out)
+{
+    std::fill(out, out + kFeatureCount, qint8(0));
+    const auto plane = [out](int index) {
+        return out + index * kPlaneSize;
+    };
+
+    for (int i = 0; i < board.cellCount; ++i) {
+        const int at = board.row[i] * kFeatureCols + board.col[i];
+        plane(PlaneOnBoard)[at] = 1;
+        plane(PlaneShield)[at] = static_cast<qint8>(std::min<int>(board.shield[i], 127));
+        plane(PlaneMarksA)[at] = state.sides[0].marks.test(i) ? 1 : 0;
+        plane(PlaneMarksB)[at] = state.sides[1].marks.test(i) ? 1 : 0;
+        plane(PlaneControlA)[at] = state.sides[0].control.test(i) ? 1 : 0;
+        plane(PlaneControlB)[at] = state.sides[1].control.test(i) ? 1 : 0;
+    }
+
+    qint8 *scalars = out + kScalarBase;
+    *scalars++ = static_cast<qint8>(state.currentSide);
+    for (int type = 0; type < kAgentTypeCount; ++type) {
+        *scalars++ = state.hasActiveCard && state.activeCard == type ? 1 : 0;
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        const PackedSide &packed = state.sides[side];
+        const int agentPlane = side == 0 ? PlaneAgentsA : PlaneAgentsB;
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            const int cell = packed.agentCell[type];
+            if (cell != kNoCell && (packed.aliveMask >> type) & 1u) {
+                out[planeIndex(board, agentPlane + type, cell)] = 1;
+            }
+            *scalars++ = static_cast<qint8>(packed.cardCount[type]);
+        }
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            *scalars++ = static_cast<qint8>((packed.aliveMask >> type) & 1u ? packed.hp[type] : 0);
+        }
+    }
+}
+
+int featureChanges(const PackedBoard &board, const PackedState &from, const PackedState &to, FeatureChange *out)
+{
+    ChangeList changes(out);
+    changes.add(kScalarBase, int(to.currentSide) - int(from.currentSide));
+    const int fromCard = activeCardFeature(from);
+    const int toCard = activeCardFeature(to);
+    if (fromCard != toCard) {
+        if (fromCard >= 0) {
+            changes.add(fromCard, -1);
+        }
+        if (toCard >= 0) {
+            changes.add(toCard, 1);
+        }
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        const PackedSide &before = from.sides[side];
+        const PackedSide &after = to.sides[side];
+        const int agentPlane = side == 0 ? PlaneAgentsA : PlaneAgentsB;
+        const int scalars = kScalarSides + side * 2 * kAgentTypeCount;
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            const bool wasOn = before.agentCell[type] != kNoCell && (before.aliveMask >> type) & 1u;
+            const bool isOn = after.agentCell[type] != kNoCell && (after.aliveMask >> type) & 1u;
+            if (wasOn != isOn || (isOn && before.agentCell[type] != after.agentCell[type])) {
+                if (wasOn) {
+                    changes.add(planeIndex(board, agentPlane + type, before.agentCell[type]), -1);
+                }
+                if (isOn) {
+                    changes.add(planeIndex(board, agentPlane + type, after.agentCell[type]), 1);
+                }
+            }
+            changes.add(scalars + type, int(after.cardCount[type]) - int(before.cardCount[type]));
+            const int hpBefore = (before.aliveMask >> type) & 1u ? before.hp[type] : 0;
+            const int hpAfter = (after.aliveMask >> type) & 1u ? after.hp[type] : 0;
+            changes.add(scalars + kAgentTypeCount + type, hpAfter - hpBefore);
+        }
+        changes.addMask(board, side == 0 ? PlaneMarksA : PlaneMarksB, before.marks, after.marks);
+        changes.addMask(board, side == 0 ? PlaneControlA : PlaneControlB, before.control, after.control);
+    }
+    return changes.result();
+}
+
+} // namespace model
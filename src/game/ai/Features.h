@@ -0,0 +1,51 @@
+#pragma once
+
+#include "../model/PackedState.h"
+
+namespace model {
+
+// Dense input encoding for trained evaluators. Cells are laid out on a fixed
+// grid by their board row and column; every plane is kFeatureRows x
+// kFeatureCols values, row-major, followed by the scalar features.
+constexpr int kFeatureRows = 12;
+constexpr int kFeatureCols = 12;
+
+enum FeaturePlane {
+    PlaneOnBoard,      // 1 where the board has a cell
+    PlaneShield,       // CellNode::shield
+    PlaneAgentsA,      // + AgentType: 1 where A's agent of that type stands
+    PlaneAgentsB = PlaneAgentsA + kAgentTypeCount,
+    PlaneMarksA = PlaneAgentsB + kAgentTypeCount,
+    PlaneMarksB,
+    PlaneControlA,
+    PlaneControlB,
+    kFeaturePlanes
+};
+
+// Scalars: side to move (0 = A, 1 = B), active card one-hot by AgentType,
+// then per side (A, B) the cards left in the deck by type and agent hp by type.
+constexpr int kFeatureScalars = 1 + kAgentTypeCount + 2 * 2 * kAgentTypeCount;
+constexpr int kFeatureCount = kFeaturePlanes * kFeatureRows * kFeatureCols + kFeatureScalars;
+
+// One feature value changing by delta between two positions.
+struct FeatureChange {
+    qint16 index{0};
+    qint8 delta{0};
+};
+
+// A move, attack or special plus the turn change touches a handful of
+// features; more than this and a full re-encode is cheaper anyway.
+constexpr int kMaxFeatureChanges = 48;
+
+// False (with a message) if a cell lies outside the feature grid.
+bool boardFitsFeatures(const PackedBoard &board, QString &errorMessage);
+
+// Writes kFeatureCount values; the board must pass boardFitsFeatures().
+void encodeFeatures(const PackedBoard &board, const PackedState &state, qint8 *out);
+
+// The features that differ between two positions on the same board, such
+// that encode(from) + changes == encode(to). Returns the number of changes
+// written to out, or -1 if there are more than kMaxFeatureChanges.
+int featureChanges(const PackedBoard &board, const PackedState &from, const PackedState &to, FeatureChange *out);
+
+} // namespace model
@@ -0,0 +1,362 @@
+#include "Network.h"
+
+#include "Evaluation.h"
+
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace model {
+
+namespace {
+
+constexpr char kMagic[4] = {'U', 'D', 'N', 'N'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 32;
+// Network scores stay clear of forced-win scores.
+constexpr int kMaxNetworkScore = kEvalWinScore / 2 - 1;
+
+constexpr qint64 weightBytes()
+{
+    return qint64(kNetworkHidden) * 2 + qint64(kFeatureCount) * kNetworkHidden * 2 + kNetworkHidden2 * 4 +
+           qint64(kNetworkHidden2) * kNetworkHidden + 4 + kNetworkHidden2;
+}
+
+template <typename T>
+void readArray(const uchar *&at, QVector<T> &out, int count)
+{
+    out.resize(count);
+    for (int i = 0; i < count; ++i) {
+        out[i] = qFromLittleEndian<T>(at + i * int(sizeof(T)));
+    }
+    at += qint64(count) * sizeof(T);
+}
+
+template <typename T>
+void writeArray(QByteArray &out, const QVector<T> &values)
+{
+    const qsizetype at = out.size();
+    out.resize(at + values.size() * qsizetype(sizeof(T)));
+    uchar *bytes = reinterpret_cast<uchar *>(out.data()) + at;
+    for (int i = 0; i < values.size(); ++i) {
+        qToLittleEndian(values[i], bytes + i * int(sizeof(T)));
+    }
+}
+
+// accumulator += delta * column, kNetworkHidden lanes.
+void addColumn(qint16 *accumulator, const qint16 *column, int delta)
+{
+#if defined(__AVX2__)
+    const __m256i scale = _mm256_set1_epi16(static_cast<qint16>(delta));
+    for (int i = 0; i < kNetworkHidden; i += 16) {
+        const __m256i weights = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(column + i));
+        __m256i *target = reinterpret_cast<__m256i *>(accumulator + i);
+        const __m256i scaled = delta == 1 ? weights : _mm256_mullo_epi16(weights, scale);
+        _mm256_store_si256(target, _mm256_add_epi16(_mm256_load_si256(target), scaled));
+    }
+#elif defined(__SSE2__)
+    const __m128i scale = _mm_set1_epi16(static_cast<qint16>(delta));
+    for (int i = 0; i < kNetworkHidden; i += 8) {
+        const __m128i weights = _mm_loadu_si128(reinterpret_cast<const __m128i *>(column + i));
+        __m128i *target = reinterpret_cast<__m128i *>(accumulator + i);
+        const __m128i scaled = delta == 1 ? weights : _mm_mullo_epi16(weights, scale);
+        _mm_store_si128(target, _mm_add_epi16(_mm_load_si128(target), scaled));
+    }
+#else
+    for (int i = 0; i < kNetworkHidden; ++i) {
+        accumulator[i] = static_cast<qint16>(accumulator[i] + delta * column[i]);
+    }
+#endif
+}
+
+// Clamps the accumulator to [0, 127] as unsigned bytes.
+void clippedRelu(const qint16 *in, quint8 *out)
+{
+#if defined(__AVX2__)
+    for (int i = 0; i < kNetworkHidden; i += 32) {
+        const __m256i low = _mm256_load_si256(reinterpret_cast<const __m256i *>(in + i));
+        const __m256i high = _mm256_load_si256(reinterpret_cast<const __m256i *>(in + i + 16));
+        // packs works per 128-bit lane; the permute restores element order.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packs_epi16(low, high), 0xD8);
+        const __m256i clamped = _mm256_max_epi8(packed, _mm256_setzero_si256());
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), clamped);
+    }
+#elif defined(__SSE2__)
+    const __m128i one = _mm_set1_epi16(kNetworkActivationOne);
+    for (int i = 0; i < kNetworkHidden; i += 16) {
+        __m128i low = _mm_load_si128(reinterpret_cast<const __m128i *>(in + i));
+        __m128i high = _mm_load_si128(reinterpret_cast<const __m128i *>(in + i + 8));
+        low = _mm_min_epi16(_mm_max_epi16(low, _mm_setzero_si128()), one);
+        high = _mm_min_epi16(_mm_max_epi16(high, _mm_setzero_si128()), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), _mm_packus_epi16(low, high));
+    }
+#else
+    for (int i = 0; i < kNetworkHidden; ++i) {
+        out[i] = static_cast<quint8>(std::clamp<int>(in[i], 0, kNetworkActivationOne));
+    }
+#endif
+}
+
+// Sum of kNetworkHidden unsigned activations times signed weights.
+qint32 dotHidden(const quint8 *activations, const qint8 *weights)
+{
+#if defined(__AVX2__)
+    // Activations are at most 127, so maddubs pair sums cannot saturate.
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i sum = _mm256_setzero_si256();
+    for (int i = 0; i < kNetworkHidden; i += 32) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(activations + i));
+        const __m256i w = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(weights + i));
+        sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_maddubs_epi16(a, w), ones));
+    }
+    __m128i half = _mm_add_epi32(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4E));
+    half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xB1));
+    return _mm_cvtsi128_si32(half);
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sum = zero;
+    for (int i = 0; i < kNetworkHidden; i += 16) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(activations + i));
+        const __m128i w = _mm_loadu_si128(reinterpret_cast<const __m128i *>(weights + i));
+        // Widen to 16 bits: zero-extend activations, sign-extend weights.
+        const __m128i aLow = _mm_unpacklo_epi8(a, zero);
+        const __m128i aHigh = _mm_unpackhi_epi8(a, zero);
+        const __m128i wLow = _mm_srai_epi16(_mm_unpacklo_epi8(w, w), 8);
+        const __m128i wHigh = _mm_srai_epi16(_mm_unpackhi_epi8(w, w), 8);
+        sum = _mm_add_epi32(sum, _mm_add_epi32(_mm_madd_epi16(aLow, wLow), _mm_madd_epi16(aHigh, wHigh)));
+    }
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0x4E));
+    sum = _mm_add_epi32(sum, _mm_shuffle_epi32(sum, 0xB1));
+    return _mm_cvtsi128_si32(sum);
+#else
+    qint32 sum = 0;
+    for (int i = 0; i < kNetworkHidden; ++i) {
+        sum += qint32(activations[i]) * weights[i];
+    }
+    return sum;
+#endif
+}
+
+} // namespace
+
+bool EvalNetwork::load(const QString &path, QString &errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("Cannot open network file: %1").arg(path);
+        return false;
+    }
+    const QByteArray data = file.readAll();
+    const uchar *at = reinterpret_cast<const uchar *>(data.constData());
+    if (data.size() < kHeaderSize || !std::equal(std::begin(kMagic), std::end(kMagic), data.constData())) {
+        errorMessage = QStringLiteral("Not a network file: %1").arg(path);
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(at + 4) != kVersion) {
+        errorMessage = QStringLiteral("Unsupported network version in %1").arg(path);
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(at + 8) != quint32(kFeatureCount) ||
+        qFromLittleEndian<quint32>(at + 12) != quint32(kNetworkHidden) ||
+        qFromLittleEndian<quint32>(at + 16) != quint32(kNetworkHidden2)) {
+        errorMessage = QStringLiteral("Network %1 has a different shape (expected %2-%3-%4-1).")
+                           .arg(path)
+                           .arg(kFeatureCount)
+                           .arg(kNetworkHidden)
+                           .arg(kNetworkHidden2);
+        return false;
+    }
+    if (data.size() != kHeaderSize + weightBytes()) {
+        errorMessage = QStringLiteral("Network file has the wrong size: %1").arg(path);
+        return false;
+    }
+
+    outputScale = qFromLittleEndian<qint32>(at + 20);
+    at += kHeaderSize;
+    readArray(at, bias1, kNetworkHidden);
+    readArray(at, weights1, kFeatureCount * kNetworkHidden);
+    readArray(at, bias2, kNetworkHidden2);
+    readArray(at, weights2, kNetworkHidden2 * kNetworkHidden);
+    bias3 = qFromLittleEndian<qint32>(at);
+    at += 4;
+    readArray(at, weights3, kNetworkHidden2);
+    return true;
+}
+
+bool EvalNetwork::save(const QString &path, QString &errorMessage) const
+{
+    QByteArray data(kHeaderSize, '\0');
+    uchar *header = reinterpret_cast<uchar *>(data.data());
+    std::copy(std::begin(kMagic), std::end(kMagic), header);
+    qToLittleEndian(kVersion, header + 4);
+    qToLittleEndian(quint32(kFeatureCount), header + 8);
+    qToLittleEndian(quint32(kNetworkHidden), header + 12);
+    qToLittleEndian(quint32(kNetworkHidden2), header + 16);
+    qToLittleEndian(qint32(outputScale), header + 20);
+    writeArray(data, bias1);
+    writeArray(data, weights1);
+    writeArray(data, bias2);
+    writeArray(data, weights2);
+    writeArray(data, QVector<qint32>{bias3});
+    writeArray(data, weights3);
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size() || !file.commit()) {
+        errorMessage = QStringLiteral("Cannot write network file: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+void EvalNetwork::randomize(quint32 seed, int scale)
+{
+    QRandomGenerator rng(seed);
+    const auto noise = [&rng](int range) {
+        return int(rng.bounded(2 * range + 1)) - range;
+    };
+
+    bias1.resize(kNetworkHidden);
+    weights1.resize(kFeatureCount * kNetworkHidden);
+    bias2.resize(kNetworkHidden2);
+    weights2.resize(kNetworkHidden2 * kNetworkHidden);
+    weights3.resize(kNetworkHidden2);
+    for (qint16 &value : bias1) {
+        value = static_cast<qint16>(noise(32));
+    }
+    for (qint16 &value : weights1) {
+        value = static_cast<qint16>(noise(8));
+    }
+    for (qint32 &value : bias2) {
+        value = noise(1 << 10);
+    }
+    for (qint8 &value : weights2) {
+        value = static_cast<qint8>(noise(32));
+    }
+    bias3 = 0;
+    for (qint8 &value : weights3) {
+        value = static_cast<qint8>(noise(64));
+    }
+    outputScale = scale;
+}
+
+bool EvalNetwork::isLoaded() const
+{
+    return !weights1.isEmpty();
+}
+
+void EvalNetwork::refresh(const PackedBoard &board, const PackedState &state, NetworkAccumulator &out) const
+{
+    qint8 features[kFeatureCount];
+    encodeFeatures(board, state, features);
+    std::copy(bias1.cbegin(), bias1.cend(), out.values);
+    for (int i = 0; i < kFeatureCount; ++i) {
+        if (features[i] != 0) {
+            addColumn(out.values, weights1.constData() + i * kNetworkHidden, features[i]);
+        }
+    }
+}
+
+void EvalNetwork::update(const NetworkAccumulator &from,
+                         const FeatureChange *changes,
+                         int count,
+                         NetworkAccumulator &out) const
+{
+    if (&out != &from) {
+        out = from;
+    }
+    for (int i = 0; i < count; ++i) {
+        addColumn(out.values, weights1.constData() + changes[i].index * kNetworkHidden, changes[i].delta);
+    }
+}
+
+int EvalNetwork::evaluate(const NetworkAccumulator &accumulator) const
+{
+    alignas(32) quint8 hidden[kNetworkHidden];
+    clippedRelu(accumulator.values, hidden);
+
+    qint64 output = bias3;
+    for (int j = 0; j < kNetworkHidden2; ++j) {
+        const qint32 sum = bias2[j] + dotHidden(hidden, weights2.constData() + j * kNetworkHidden);
+        output += qint64(std::clamp(sum >> kNetworkWeightShift, 0, kNetworkActivationOne)) * weights3[j];
+    }
+    const qint64 score = output * outputScale / (kNetworkActivationOne << kNetworkWeightShift);
+    return int(std::clamp<qint64>(score, -kMaxNetworkScore, kMaxNetworkScore));
+}
+
+NetworkEvaluator::NetworkEvaluator(const EvalNetwork &network, const PackedBoard &board)
+    : network(network),
+      board(board)
+{
+}
+
+void NetworkEvaluator::reset(const PackedState &root)
+{
+    top = -1;
+    push(root);
+    network.refresh(board, root, stack[0].accumulator);
+    stack[0].computed = true;
+}
+
+void NetworkEvaluator::push(const PackedState &state)
+{
+    if (++top == int(stack.size())) {
+        stack.emplace_back();
+    }
+    stack[top].state = state;
+    stack[top].computed = false;
+}
+
+void NetworkEvaluator::pop()
+{
+    --top;
+}
+
+int NetworkEvaluator::evaluate(int side)
+{
+    Entry &entry = stack[top];
+    if (entry.state.status != GameStatus::InProgress) {
+        const int winner = entry.state.status == GameStatus::WonByA ? 0 : 1;
+        return winner == side ? kEvalWinScore : -kEvalWinScore;
+    }
+
+    int base = top;
+    while (!stack[base].computed) {
+        --base;
+    }
+    FeatureChange changes[kMaxFeatureChanges];
+    for (int i = base + 1; i <= top; ++i) {
+        const int count = featureChanges(board, stack[i - 1].state, stack[i].state, changes);
+        if (count < 0) {
+            network.refresh(board, stack[i].state, stack[i].accumulator);
+        } else {
+            network.update(stack[i - 1].accumulator, changes, count, stack[i].accumulator);
+        }
+        stack[i].computed = true;
+    }
+
+    const int score = network.evaluate(entry.accumulator);
+    return side == entry.state.currentSide ? score : -score;
+}
+
+const char *networkSimdBackend()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace model
@@ -0,0 +1,96 @@
+#pragma once
+
+#include "Features.h"
+
+#include <QVector>
+
+#include <vector>
+
+namespace model {
+
+// Small quantised network over the Features.h encoding:
+//   kFeatureCount int8 inputs -> kNetworkHidden int16 accumulator
+//   -> clamp to [0, 127] -> kNetworkHidden2 -> clamp to [0, 127] -> 1.
+// The first layer is the only large one and is linear in the inputs, so it
+// is kept as an accumulator and updated by the few features a move changes.
+constexpr int kNetworkHidden = 128;
+constexpr int kNetworkHidden2 = 32;
+// Hidden activations use 127 for 1.0; second and third layer weights use 64.
+constexpr int kNetworkActivationOne = 127;
+constexpr int kNetworkWeightShift = 6;
+
+struct NetworkAccumulator {
+    alignas(32) qint16 values[kNetworkHidden];
+};
+
+// Network weights, immutable once loaded and safe to share between threads.
+class EvalNetwork
+{
+public:
+    // Weights file (".udnn"), little-endian:
+    //   header (32 bytes): magic "UDNN", version, inputs, hidden, hidden2,
+    //                      output scale, 8 reserved bytes
+    //   int16 bias1[hidden], int16 weights1[inputs][hidden]
+    //   int32 bias2[hidden2], int8 weights2[hidden2][hidden]
+    //   int32 bias3, int8 weights3[hidden2]
+    // Sizes must match the constants above. The output, divided by
+    // 127 * 64, times the output scale is the score in evaluation units for
+    // the side to move.
+    bool load(const QString &path, QString &errorMessage);
+    bool save(const QString &path, QString &errorMessage) const;
+
+    // Fills every weight with small deterministic noise; for benchmarks and
+    // as a starting point for trainers.
+    void randomize(quint32 seed, int outputScale);
+
+    bool isLoaded() const;
+
+    // First layer from scratch.
+    void refresh(const PackedBoard &board, const PackedState &state, NetworkAccumulator &out) const;
+    // First layer from a neighbouring position's accumulator.
+    void update(const NetworkAccumulator &from, const FeatureChange *changes, int count, NetworkAccumulator &out) const;
+    // Remaining layers; score for the side to move.
+    int evaluate(const NetworkAccumulator &accumulator) const;
+
+private:
+    QVector<qint16> bias1;
+    QVector<qint16> weights1;
+    QVector<qint32> bias2;
+    QVector<qint8> weights2;
+    qint32 bias3{0};
+    QVector<qint8> weights3;
+    int outputScale{0};
+};
+
+// Per-search stack of positions along the current line. Accumulators are
+// computed lazily, when a position is evaluated, from the nearest ancestor
+// that already has one, so interior nodes cost nothing.
+class NetworkEvaluator
+{
+public:
+    NetworkEvaluator(const EvalNetwork &network, const PackedBoard &board);
+
+    void reset(const PackedState &root);
+    void push(const PackedState &state);
+    void pop();
+
+    // Score of the top position from the point of view of `side`; terminal
+    // positions return +/- kEvalWinScore like evaluatePosition().
+    int evaluate(int side);
+
+private:
+    struct Entry {
+        PackedState state;
+        NetworkAccumulator accumulator;
+        bool computed{false};
+    };
+
+    const EvalNetwork &network;
+    const PackedBoard &board;
+    std::vector<Entry> stack;
+    int top{-1};
+};
+
+const char *networkSimdBackend();
+
+} // namespace model
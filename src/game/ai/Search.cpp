@@ -0,0 +1,255 @@
+#include "Search.h"
+
+#include "Tablebase.h"
+
+#include <QElapsedTimer>
+
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <optional>
+
+namespace model {
+
+namespace {
+
+constexpr qint64 kStopCheckInterval = 2048;
+
+class Expectimax
+{
+public:
+    Expectimax(const PackedBoard &board,
+               const SearchOptions &options,
+               const std::atomic_bool *cancel)
+        : board_(board),
+          options_(options),
+          cancel_(cancel)
+    {
+        // A board outside the feature grid cannot be encoded; such searches
+        // keep evaluatePosition().
+        QString unused;
+        if (options.network && boardFitsFeatures(board, unused)) {
+            network_.emplace(*options.network, board);
+        }
+        timer_.start();
+    }
+
+    // Best action for the side to move at `depth` plies. Returns false if the
+    // iteration was stopped before every root action was scored.
+    bool searchRoot(const PackedState &root, int depth, SearchInfo &info)
+    {
+        PackedAction actions[kMaxPackedActions];
+        const int count = packedLegalActions(board_, root, actions);
+        if (count == 0) {
+            return false;
+        }
+
+        enforceTimeLimit_ = depth > 1;
+        if (network_) {
+            network_->reset(root);
+        }
+        int bestScore = std::numeric_limits<int>::min();
+        PackedAction best = actions[0];
+        for (int i = 0; i < count; ++i) {
+            const int score = actionValue(root, actions[i], depth, 0);
+            if (stopped_) {
+                return false;
+            }
+            if (score > bestScore) {
+                bestScore = score;
+                best = actions[i];
+            }
+        }
+
+        info.hasAction = true;
+        info.action = best;
+        info.score = bestScore;
+        info.depth = depth;
+        return true;
+    }
+
+    bool cancelled() const
+    {
+        return cancel_ != nullptr && cancel_->load(std::memory_order_relaxed);
+    }
+
+    qint64 nodes() const
+    {
+        return nodes_;
+    }
+
+    qint64 elapsedMs() const
+    {
+        return timer_.elapsed();
+    }
+
+private:
+    bool shouldStop()
+    {
+        if (stopped_) {
+            return true;
+        }
+        if (++nodes_ % kStopCheckInterval != 0) {
+            return false;
+        }
+        if (cancelled() || (enforceTimeLimit_ && timer_.elapsed() >= options_.timeMs)) {
+            stopped_ = true;
+        }
+        return stopped_;
+    }
+
+    // The network evaluator tracks the line from the root; every state that
+    // may reach staticValue() is pushed first.
+    void pushPosition(const PackedState &state)
+    {
+        if (network_) {
+            network_->push(state);
+        }
+    }
+
+    void popPosition()
+    {
+        if (network_) {
+            network_->pop();
+        }
+    }
+
+    int staticValue(const PackedState &state, int side)
+    {
+        if (network_) {
+            return network_->evaluate(side);
+        }
+        return evaluatePosition(board_, state, side, options_.weights);
+    }
+
+    // Value for the side to move in `state`.
+    int nodeValue(const PackedState &state, int depth, int ply)
+    {
+        if (shouldStop()) {
+            return 0;
+        }
+        double winProbability = 0.0;
+        if (options_.tablebase != nullptr && options_.tablebase->probe(state, winProbability)) {
+            // Kept below forced-win scores so a certain win is still played out.
+            return static_cast<int>((2.0 * winProbability - 1.0) * (kEvalWinScore / 2));
+        }
+        if (depth == 0) {
+            return staticValue(state, state.currentSide);
+        }
+
+        PackedAction actions[kMaxPackedActions];
+        const int count = packedLegalActions(board_, state, actions);
+        if (count == 0) {
+            return staticValue(state, state.currentSide);
+        }
+
+        int best = std::numeric_limits<int>::min();
+        for (int i = 0; i < count && !stopped_; ++i) {
+            best = std::max(best, actionValue(state, actions[i], depth, ply));
+        }
+        return best;
+    }
+
+    int actionValue(const PackedState &state, const PackedAction &action, int depth, int ply)
+    {
+        if (action.kind != PackedActionKind::Attack) {
+            return outcomeValue(state, action, false, depth, ply);
+        }
+
+        const int threshold = packedAttackThreshold(board_, state, action);
+        const int hitChance = attackHitChance(packedAttackDice(state.activeCard), threshold);
+        const qint64 hit = outcomeValue(state, action, true, depth, ply);
+        const qint64 miss = hitChance < 1000 ? outcomeValue(state, action, false, depth, ply) : 0;
+        return static_cast<int>((hitChance * hit + (1000 - hitChance) * miss) / 1000);
+    }
+
+    // Applies one outcome of `action`, passes the turn and averages over the
+    // opponent's possible draws. Returned from the mover's point of view.
+    int outcomeValue(const PackedState &state, const PackedAction &action, bool hit, int depth, int ply)
+    {
+        PackedState child = state;
+        const int mover = state.currentSide;
+        applyPackedAction(board_, child, action, hit);
+
+        if (child.status != GameStatus::InProgress) {
+            const int winner = child.status == GameStatus::WonByA ? 0 : 1;
+            const int score = kEvalWinScore - (ply + 1);
+            return winner == mover ? score : -score;
+        }
+
+        endPackedTurn(child);
+        const PackedSide &next = child.sides[child.currentSide];
+        if (next.deckSize == 0) {
+            pushPosition(child);
+            const int value = staticValue(child, mover);
+            popPosition();
+            return value;
+        }
+
+        qint64 total = 0;
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            const int cards = next.cardCount[type];
+            if (cards == 0) {
+                continue;
+            }
+            PackedState drawn = child;
+            drawPackedCard(drawn, type);
+            pushPosition(drawn);
+            total -= qint64(cards) * nodeValue(drawn, depth - 1, ply + 1);
+            popPosition();
+            if (stopped_) {
+                return 0;
+            }
+        }
+        return static_cast<int>(total / next.deckSize);
+    }
+
+    const PackedBoard &board_;
+    const SearchOptions &options_;
+    const std::atomic_bool *cancel_;
+    std::optional<NetworkEvaluator> network_;
+    QElapsedTimer timer_;
+    qint64 nodes_{0};
+    bool enforceTimeLimit_{false};
+    bool stopped_{false};
+};
+
+} // namespace
+
+SearchInfo searchBestAction(const PackedBoard &board,
+                            const PackedState &root,
+                            const SearchOptions &options,
+                            const std::atomic_bool *cancel,
+                            const SearchProgressFn &onProgress)
+{
+    SearchInfo best;
+    if (root.status != GameStatus::InProgress || !root.hasActiveCard) {
+        return best;
+    }
+
+    Expectimax search(board, options, cancel);
+    for (int depth = 1; depth <= std::max(1, options.maxDepth); ++depth) {
+        SearchInfo iteration;
+        if (!search.searchRoot(root, depth, iteration)) {
+            break;
+        }
+        best = iteration;
+        best.nodes = search.nodes();
+        best.elapsedMs = search.elapsedMs();
+        if (onProgress) {
+            onProgress(best);
+        }
+        if (std::abs(best.score) >= kEvalWinScore - options.maxDepth - 1) {
+            break;
+        }
+    }
+
+    if (search.cancelled()) {
+        return SearchInfo{};
+    }
+    best.nodes = search.nodes();
+    best.elapsedMs = search.elapsedMs();
+    return best;
+}
+
+} // namespace model
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Evaluation.h"
+#include "Network.h"
+#include "../rules/PackedRules.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+namespace model {
+
+class Tablebase;
+
+struct SearchOptions {
+    EvalWeights weights;
+    int maxDepth{6};
+    // Wall-clock budget; depth 1 always completes so a move is always found.
+    qint64 timeMs{1500};
+    // Exact endgame values; positions it covers are not searched further.
+    const Tablebase *tablebase{nullptr};
+    // Replaces evaluatePosition() (and the weights) when set, on boards that
+    // pass boardFitsFeatures().
+    std::shared_ptr<const EvalNetwork> network;
+};
+
+struct SearchInfo {
+    bool hasAction{false};
+    PackedAction action;
+    int score{0};
+    int depth{0};
+    qint64 nodes{0};
+    qint64 elapsedMs{0};
+};
+
+using SearchProgressFn = std::function<void(const SearchInfo &)>;
+
+// Iterative-deepening expectimax over PackedState. Attacks are chance nodes
+// weighted by the hit probability; the card drawn after every turn is a
+// chance node over the card types left in that deck, weighted by count (the
+// searcher never peeks at deck order). onProgress is called after every
+// completed depth. If cancel becomes true the search stops and returns
+// hasAction == false.
+SearchInfo searchBestAction(const PackedBoard &board,
+                            const PackedState &root,
+                            const SearchOptions &options,
+                            const std::atomic_bool *cancel = nullptr,
+                            const SearchProgressFn &onProgress = SearchProgressFn());
+
+} // namespace model
@@ -0,0 +1,184 @@
+#include "Tablebase.h"
+
+#include <QSaveFile>
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+// File layout, all little-endian:
+//   header (32 bytes): magic "UDTB", version, maxCards, reserved,
+//                      board fingerprint (u64), entry count (u64)
+//   keys:   count x u64, ascending
+//   scores: count x u16
+constexpr char kMagic[4] = {'U', 'D', 'T', 'B'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 32;
+
+void putU32(uchar *at, quint32 value)
+{
+    qToLittleEndian(value, at);
+}
+
+void putU64(uchar *at, quint64 value)
+{
+    qToLittleEndian(value, at);
+}
+
+} // namespace
+
+bool isEndgamePosition(const PackedState &state, int maxCards)
+{
+    if (state.status != GameStatus::InProgress || !state.hasActiveCard) {
+        return false;
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        const PackedSide &packed = state.sides[side];
+        if (qPopulationCount(packed.aliveMask) != 1) {
+            return false;
+        }
+        const int cards = packed.deckSize + (state.currentSide == side ? 1 : 0);
+        if (cards > maxCards) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool writeTablebase(const QString &path,
+                    const PackedBoard &board,
+                    int maxCards,
+                    QVector<TablebaseEntry> entries,
+                    QString &errorMessage)
+{
+    std::sort(entries.begin(), entries.end(), [](const TablebaseEntry &a, const TablebaseEntry &b) {
+        return a.key < b.key;
+    });
+
+    const qint64 count = entries.size();
+    QByteArray data(kHeaderSize + count * 10, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(data.data());
+
+    std::copy(std::begin(kMagic), std::end(kMagic), bytes);
+    putU32(bytes + 4, kVersion);
+    putU32(bytes + 8, static_cast<quint32>(maxCards));
+    putU64(bytes + 16, packedBoardFingerprint(board));
+    putU64(bytes + 24, static_cast<quint64>(count));
+
+    uchar *keyOut = bytes + kHeaderSize;
+    uchar *scoreOut = keyOut + count * 8;
+    for (qint64 i = 0; i < count; ++i) {
+        putU64(keyOut + i * 8, entries[i].key);
+        qToLittleEndian(entries[i].score, scoreOut + i * 2);
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorMessage = QStringLiteral("Cannot write tablebase: %1").arg(path);
+        return false;
+    }
+    if (file.write(data) != data.size() || !file.commit()) {
+        errorMessage = QStringLiteral("Failed to write tablebase: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool Tablebase::open(const QString &path, const PackedBoard &board, QString &errorMessage)
+{
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("Cannot open tablebase: %1").arg(path);
+        return false;
+    }
+
+    const qint64 fileSize = file.size();
+    const uchar *mapped = fileSize >= kHeaderSize ? file.map(0, fileSize) : nullptr;
+    if (mapped == nullptr || !std::equal(std::begin(kMagic), std::end(kMagic), mapped)) {
+        errorMessage = QStringLiteral("Not a tablebase file: %1").arg(path);
+        close();
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(mapped + 4) != kVersion) {
+        errorMessage = QStringLiteral("Unsupported tablebase version: %1").arg(path);
+        close();
+        return false;
+    }
+    if (qFromLittleEndian<quint64>(mapped + 16) != packedBoardFingerprint(board)) {
+        errorMessage = QStringLiteral("Tablebase %1 was built for a different board.").arg(path);
+        close();
+        return false;
+    }
+
+    const qint64 entries = static_cast<qint64>(qFromLittleEndian<quint64>(mapped + 24));
+    if (entries < 0 || fileSize != kHeaderSize + entries * 10) {
+        errorMessage = QStringLiteral("Tablebase file is truncated: %1").arg(path);
+        close();
+        return false;
+    }
+
+    coveredCards = static_cast<int>(qFromLittleEndian<quint32>(mapped + 8));
+    count = entries;
+    keys = mapped + kHeaderSize;
+    scores = keys + entries * 8;
+    return true;
+}
+
+void Tablebase::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+    keys = nullptr;
+    scores = nullptr;
+    count = 0;
+    coveredCards = 0;
+}
+
+bool Tablebase::isOpen() const
+{
+    return keys != nullptr;
+}
+
+qint64 Tablebase::size() const
+{
+    return count;
+}
+
+int Tablebase::maxCards() const
+{
+    return coveredCards;
+}
+
+bool Tablebase::probe(const PackedState &state, double &winProbability) const
+{
+    if (keys == nullptr || !isEndgamePosition(state, coveredCards)) {
+        return false;
+    }
+
+    const quint64 key = hashPackedState(state);
+    qint64 lo = 0;
+    qint64 hi = count;
+    while (lo < hi) {
+        const qint64 mid = lo + (hi - lo) / 2;
+        if (qFromLittleEndian<quint64>(keys + mid * 8) < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    if (lo >= count || qFromLittleEndian<quint64>(keys + lo * 8) != key) {
+        return false;
+    }
+
+    winProbability = qFromLittleEndian<quint16>(scores + lo * 2) / 65535.0;
+    return true;
+}
+
+} // namespace model
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "../model/PackedState.h"
+
+#include <QFile>
+
+namespace model {
+
+struct TablebaseEntry {
+    quint64 key{0};
+    // Expected score for the side to move under best play by both sides:
+    // win = 1, loss = 0, never-ending = 1/2; scaled to 0..65535.
+    quint16 score{0};
+};
+
+// Covered positions: both sides have exactly one live agent (so the order of
+// the remaining cards carries no information) and at most `maxCards` cards
+// each, counting the active card.
+bool isEndgamePosition(const PackedState &state, int maxCards);
+
+bool writeTablebase(const QString &path,
+                    const PackedBoard &board,
+                    int maxCards,
+                    QVector<TablebaseEntry> entries,
+                    QString &errorMessage);
+
+// Read-only, memory-mapped view of a tablebase file. Probing is a binary
+// search over the sorted key array and is safe from several threads.
+class Tablebase
+{
+public:
+    Tablebase() = default;
+    Tablebase(const Tablebase &) = delete;
+    Tablebase &operator=(const Tablebase &) = delete;
+
+    bool open(const QString &path, const PackedBoard &board, QString &errorMessage);
+    void close();
+
+    bool isOpen() const;
+    qint64 size() const;
+    int maxCards() const;
+
+    // Win probability for the side to move, or false if not covered.
+    bool probe(const PackedState &state, double &winProbability) const;
+
+private:
+    QFile file;
+    const uchar *keys = nullptr;
+    const uchar *scores = nullptr;
+    qint64 count{0};
+    int coveredCards{0};
+};
+
+} // namespace model
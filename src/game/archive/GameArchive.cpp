@@ -0,0 +1,451 @@
+#include "GameArchive.h"
+
+#include <QFileInfo>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QtEndian>
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+// File layout, all little-endian:
+//   header (16 bytes): magic "UDCA", version, chunk rows, map count
+//   maps:    map count x (u16 length, UTF-8 name)
+//   columns: kArchiveColumnCount x (u8 width, 3 reserved, u32 max value,
+//            u64 rows, u32 chunk count, chunk count x (u64 offset, u32 size))
+//   chunks:  qCompress()ed arrays of `width`-byte values
+constexpr char kMagic[4] = {'U', 'D', 'C', 'A'};
+constexpr quint32 kVersion = 1;
+constexpr qint64 kHeaderSize = 16;
+constexpr qint64 kColumnHeaderSize = 20;
+constexpr qint64 kChunkEntrySize = 12;
+// Cap on the cells of one cross tabulation; every worker holds one 8 MB
+// accumulator at the cap.
+constexpr qint64 kMaxCrossCells = qint64(1) << 20;
+
+const char *const kColumnNames[kArchiveColumnCount] = {
+    "game.map",     "game.winner", "game.turns",       "action.kind", "action.side",
+    "action.agent", "attack.threshold", "attack.dice", "attack.hit",  "roll",
+};
+
+int columnWidth(ArchiveColumn column)
+{
+    return column == ArchiveColumn::GameMap || column == ArchiveColumn::GameTurns ? 2 : 1;
+}
+
+// Columns of one table share row numbering.
+int columnTable(ArchiveColumn column)
+{
+    switch (column) {
+    case ArchiveColumn::GameMap:
+    case ArchiveColumn::GameWinner:
+    case ArchiveColumn::GameTurns:
+        return 0;
+    case ArchiveColumn::ActionKind:
+    case ArchiveColumn::ActionSide:
+    case ArchiveColumn::ActionAgent:
+        return 1;
+    case ArchiveColumn::AttackThreshold:
+    case ArchiveColumn::AttackDice:
+    case ArchiveColumn::AttackHit:
+        return 2;
+    case ArchiveColumn::Roll:
+        break;
+    }
+    return 3;
+}
+
+// False if a value lies outside the column's recorded maximum.
+template <typename A, typename B>
+bool tabulate(const QByteArray &first, const QByteArray &second, qint64 stride, QVector<qint64> &counts)
+{
+    const auto *a = reinterpret_cast<const A *>(first.constData());
+    const auto *b = reinterpret_cast<const B *>(second.constData());
+    const qint64 rows = first.size() / qint64(sizeof(A));
+    const quint64 cells = quint64(counts.size());
+    qint64 *out = counts.data();
+    for (qint64 i = 0; i < rows; ++i) {
+        const quint64 cell = quint64(qFromLittleEndian(a[i])) * quint64(stride) + qFromLittleEndian(b[i]);
+        if (cell >= cells) {
+            return false;
+        }
+        ++out[cell];
+    }
+    return true;
+}
+
+} // namespace
+
+QString archiveColumnName(ArchiveColumn column)
+{
+    return QString::fromLatin1(kColumnNames[static_cast<int>(column)]);
+}
+
+bool parseArchiveColumn(const QString &name, ArchiveColumn &out)
+{
+    for (int i = 0; i < kArchiveColumnCount; ++i) {
+        if (name == QLatin1String(kColumnNames[i])) {
+            out = static_cast<ArchiveColumn>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+GameArchiveWriter::GameArchiveWriter()
+{
+    for (int i = 0; i < kArchiveColumnCount; ++i) {
+        columns[i].width = columnWidth(static_cast<ArchiveColumn>(i));
+    }
+}
+
+bool GameArchiveWriter::addGame(const ReplayGame &game, QString &errorMessage)
+{
+    PackedState state;
+    const PackedBoard *board = starts.start(game, state, errorMessage);
+    if (board == nullptr) {
+        return false;
+    }
+
+    // Derive everything first so a game that fails to replay adds no rows.
+    struct Row {
+        PackedReplayStep step;
+        quint8 side;
+        quint8 agent;
+    };
+    QVector<Row> rows;
+    rows.reserve(game.actions.size());
+    for (int i = 0; i < game.actions.size(); ++i) {
+        Row row;
+        row.side = state.currentSide;
+        row.agent = state.activeCard;
+        if (!packReplayAction(*board, state, game.actions[i], row.step, errorMessage) ||
+            !applyReplayAction(*board, state, game.actions[i], errorMessage)) {
+            errorMessage = QStringLiteral("Game %1, action %2: %3").arg(game.id).arg(i + 1).arg(errorMessage);
+            return false;
+        }
+        rows.append(row);
+    }
+
+    const QString map = QFileInfo(game.scenarioPath).completeBaseName();
+    auto index = mapIndex.find(map);
+    if (index == mapIndex.end()) {
+        index = mapIndex.insert(map, mapNames.size());
+        mapNames.append(map);
+    }
+
+    append(ArchiveColumn::GameMap, static_cast<quint32>(*index));
+    append(ArchiveColumn::GameWinner, static_cast<quint32>(game.finalStatus));
+    append(ArchiveColumn::GameTurns, static_cast<quint32>(std::min<int>(game.actions.size(), 0xffff)));
+    for (int i = 0; i < rows.size(); ++i) {
+        const ReplayAction &action = game.actions[i];
+        append(ArchiveColumn::ActionKind, static_cast<quint32>(action.kind));
+        append(ArchiveColumn::ActionSide, rows[i].side);
+        append(ArchiveColumn::ActionAgent, rows[i].agent);
+        if (action.kind != PackedActionKind::Attack) {
+            continue;
+        }
+        append(ArchiveColumn::AttackThreshold, static_cast<quint32>(rows[i].step.threshold));
+        append(ArchiveColumn::AttackDice, action.rollCount);
+        append(ArchiveColumn::AttackHit, rows[i].step.hit ? 1 : 0);
+        for (int r = 0; r < action.rollCount; ++r) {
+            append(ArchiveColumn::Roll, action.rolls[r]);
+        }
+    }
+    return true;
+}
+
+qint64 GameArchiveWriter::gameCount() const
+{
+    return columns[static_cast<int>(ArchiveColumn::GameMap)].rows;
+}
+
+void GameArchiveWriter::append(ArchiveColumn id, quint32 value)
+{
+    Column &column = columns[static_cast<int>(id)];
+    if (column.width == 2) {
+        char bytes[2];
+        qToLittleEndian(static_cast<quint16>(value), bytes);
+        column.pending.append(bytes, 2);
+    } else {
+        column.pending.append(static_cast<char>(value));
+    }
+    column.maxValue = std::max(column.maxValue, value);
+    ++column.rows;
+    if (column.pending.size() == qsizetype(kArchiveChunkRows) * column.width) {
+        flush(column);
+    }
+}
+
+void GameArchiveWriter::flush(Column &column)
+{
+    if (!column.pending.isEmpty()) {
+        column.chunks.append(qCompress(column.pending));
+        column.pending.clear();
+    }
+}
+
+bool GameArchiveWriter::write(const QString &path, QString &errorMessage)
+{
+    for (Column &column : columns) {
+        flush(column);
+    }
+
+    QByteArray header(kHeaderSize, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(header.data());
+    std::copy(std::begin(kMagic), std::end(kMagic), bytes);
+    qToLittleEndian(kVersion, bytes + 4);
+    qToLittleEndian(static_cast<quint32>(kArchiveChunkRows), bytes + 8);
+    qToLittleEndian(static_cast<quint32>(mapNames.size()), bytes + 12);
+    for (const QString &map : mapNames) {
+        const QByteArray name = map.toUtf8();
+        char length[2];
+        qToLittleEndian(static_cast<quint16>(name.size()), length);
+        header.append(length, 2);
+        header.append(name);
+    }
+
+    qint64 directorySize = 0;
+    for (const Column &column : columns) {
+        directorySize += kColumnHeaderSize + column.chunks.size() * kChunkEntrySize;
+    }
+
+    qint64 offset = header.size() + directorySize;
+    QByteArray directory(directorySize, '\0');
+    uchar *at = reinterpret_cast<uchar *>(directory.data());
+    for (const Column &column : columns) {
+        at[0] = static_cast<uchar>(column.width);
+        qToLittleEndian(column.maxValue, at + 4);
+        qToLittleEndian(static_cast<quint64>(column.rows), at + 8);
+        qToLittleEndian(static_cast<quint32>(column.chunks.size()), at + 16);
+        at += kColumnHeaderSize;
+        for (const QByteArray &chunk : column.chunks) {
+            qToLittleEndian(static_cast<quint64>(offset), at);
+            qToLittleEndian(static_cast<quint32>(chunk.size()), at + 8);
+            at += kChunkEntrySize;
+            offset += chunk.size();
+        }
+    }
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorMessage = QStringLiteral("Cannot write archive: %1").arg(path);
+        return false;
+    }
+    bool ok = file.write(header) == header.size() && file.write(directory) == directory.size();
+    for (const Column &column : columns) {
+        for (const QByteArray &chunk : column.chunks) {
+            ok = ok && file.write(chunk) == chunk.size();
+        }
+    }
+    if (!ok || !file.commit()) {
+        errorMessage = QStringLiteral("Failed to write archive: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool GameArchive::open(const QString &path, QString &errorMessage)
+{
+    close();
+
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("Cannot open archive: %1").arg(path);
+        return false;
+    }
+
+    size = file.size();
+    data = size >= kHeaderSize ? file.map(0, size) : nullptr;
+    if (data == nullptr || !std::equal(std::begin(kMagic), std::end(kMagic), data)) {
+        errorMessage = QStringLiteral("Not a game archive: %1").arg(path);
+        close();
+        return false;
+    }
+    if (qFromLittleEndian<quint32>(data + 4) != kVersion ||
+        qFromLittleEndian<quint32>(data + 8) != quint32(kArchiveChunkRows)) {
+        errorMessage = QStringLiteral("Unsupported archive version: %1").arg(path);
+        close();
+        return false;
+    }
+
+    const auto truncated = [&]() {
+        errorMessage = QStringLiteral("Archive file is truncated: %1").arg(path);
+        close();
+        return false;
+    };
+
+    qint64 at = kHeaderSize;
+    const quint32 mapCount = qFromLittleEndian<quint32>(data + 12);
+    for (quint32 i = 0; i < mapCount; ++i) {
+        if (size - at < 2) {
+            return truncated();
+        }
+        const int length = qFromLittleEndian<quint16>(data + at);
+        if (size - at - 2 < length) {
+            return truncated();
+        }
+        maps.append(QString::fromUtf8(reinterpret_cast<const char *>(data + at + 2), length));
+        at += 2 + length;
+    }
+
+    for (Column &column : columns) {
+        if (size - at < kColumnHeaderSize) {
+            return truncated();
+        }
+        column.width = data[at];
+        column.maxValue = qFromLittleEndian<quint32>(data + at + 4);
+        column.rows = static_cast<qint64>(qFromLittleEndian<quint64>(data + at + 8));
+        const qint64 chunkCount = qFromLittleEndian<quint32>(data + at + 16);
+        at += kColumnHeaderSize;
+        if ((column.width != 1 && column.width != 2) || column.rows < 0 ||
+            chunkCount != (column.rows + kArchiveChunkRows - 1) / kArchiveChunkRows ||
+            size - at < chunkCount * kChunkEntrySize) {
+            return truncated();
+        }
+        for (qint64 i = 0; i < chunkCount; ++i) {
+            Chunk chunk;
+            chunk.offset = static_cast<qint64>(qFromLittleEndian<quint64>(data + at));
+            chunk.size = qFromLittleEndian<quint32>(data + at + 8);
+            chunk.rows = static_cast<int>(std::min<qint64>(kArchiveChunkRows, column.rows - i * kArchiveChunkRows));
+            if (chunk.offset < 0 || chunk.offset > size || size - chunk.offset < chunk.size) {
+                return truncated();
+            }
+            column.chunks.append(chunk);
+            at += kChunkEntrySize;
+        }
+    }
+
+    // Columns of one table are read row by row together.
+    for (int i = 0; i < kArchiveColumnCount; ++i) {
+        for (int j = 0; j < i; ++j) {
+            if (columnTable(static_cast<ArchiveColumn>(i)) == columnTable(static_cast<ArchiveColumn>(j)) &&
+                columns[i].rows != columns[j].rows) {
+                errorMessage = QStringLiteral("Archive columns %1 and %2 have different row counts: %3")
+                                   .arg(archiveColumnName(static_cast<ArchiveColumn>(j)),
+                                        archiveColumnName(static_cast<ArchiveColumn>(i)), path);
+                close();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+void GameArchive::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+    data = nullptr;
+    size = 0;
+    maps.clear();
+    columns = {};
+}
+
+const QStringList &GameArchive::mapNames() const
+{
+    return maps;
+}
+
+qint64 GameArchive::rows(ArchiveColumn column) const
+{
+    return columns[static_cast<int>(column)].rows;
+}
+
+quint32 GameArchive::maxValue(ArchiveColumn column) const
+{
+    return columns[static_cast<int>(column)].maxValue;
+}
+
+qint64 GameArchive::storedBytes(ArchiveColumn column) const
+{
+    qint64 total = 0;
+    for (const Chunk &chunk : columns[static_cast<int>(column)].chunks) {
+        total += chunk.size;
+    }
+    return total;
+}
+
+bool GameArchive::crossTabulate(ArchiveColumn a,
+                                ArchiveColumn b,
+                                int threads,
+                                QVector<qint64> &counts,
+                                QString &errorMessage) const
+{
+    if (columnTable(a) != columnTable(b)) {
+        errorMessage = QStringLiteral("Columns %1 and %2 do not describe the same rows.")
+                           .arg(archiveColumnName(a), archiveColumnName(b));
+        return false;
+    }
+
+    const Column &first = columns[static_cast<int>(a)];
+    const Column &second = columns[static_cast<int>(b)];
+    const qint64 stride = qint64(second.maxValue) + 1;
+    const qint64 cells = (qint64(first.maxValue) + 1) * stride;
+    if (cells > kMaxCrossCells) {
+        errorMessage = QStringLiteral("Too many value pairs for %1 x %2.").arg(archiveColumnName(a), archiveColumnName(b));
+        return false;
+    }
+
+    counts = QVector<qint64>(cells, 0);
+    QMutex mergeMutex;
+    bool failed = false;
+
+    // One contiguous range of chunks per worker, each with its own
+    // accumulator merged once, so zeroing and merging cost O(cells) per
+    // worker rather than per chunk.
+    const int chunkCount = first.chunks.size();
+    const int workers = std::min(threads > 0 ? threads : QThread::idealThreadCount(), chunkCount);
+    QThreadPool pool;
+    pool.setMaxThreadCount(std::max(workers, 1));
+    for (int worker = 0; worker < workers; ++worker) {
+        const int begin = int(qint64(chunkCount) * worker / workers);
+        const int end = int(qint64(chunkCount) * (worker + 1) / workers);
+        pool.start([&, begin, end]() {
+            QVector<qint64> local(cells, 0);
+            bool valid = true;
+            for (int index = begin; valid && index < end; ++index) {
+                const Chunk &left = first.chunks[index];
+                const Chunk &right = second.chunks[index];
+                const QByteArray leftValues = qUncompress(data + left.offset, left.size);
+                const QByteArray rightValues = a == b ? leftValues : qUncompress(data + right.offset, right.size);
+
+                valid = leftValues.size() == qsizetype(left.rows) * first.width &&
+                        rightValues.size() == qsizetype(right.rows) * second.width;
+                if (valid && first.width == 1 && second.width == 1) {
+                    valid = tabulate<quint8, quint8>(leftValues, rightValues, stride, local);
+                } else if (valid && first.width == 1) {
+                    valid = tabulate<quint8, quint16>(leftValues, rightValues, stride, local);
+                } else if (valid && second.width == 1) {
+                    valid = tabulate<quint16, quint8>(leftValues, rightValues, stride, local);
+                } else if (valid) {
+                    valid = tabulate<quint16, quint16>(leftValues, rightValues, stride, local);
+                }
+            }
+
+            QMutexLocker locker(&mergeMutex);
+            if (!valid) {
+                failed = true;
+                return;
+            }
+            for (qint64 i = 0; i < cells; ++i) {
+                counts[i] += local[i];
+            }
+        });
+    }
+    pool.waitForDone();
+
+    if (failed) {
+        errorMessage = QStringLiteral("Archive chunk is damaged.");
+        return false;
+    }
+    return true;
+}
+
+} // namespace model
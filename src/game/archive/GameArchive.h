@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../replay/Replayer.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QVector>
+
+#include <array>
+
+namespace model {
+
+// Columns of a game archive. Each column is one array of unsigned values; the
+// columns of one table have the same row count, so row i of GameMap and row i
+// of GameWinner describe the same game.
+enum class ArchiveColumn : quint8 {
+    // One row per game.
+    GameMap,     // index into mapNames()
+    GameWinner,  // GameStatus: 0 unfinished, 1 A, 2 B
+    GameTurns,   // actions played (one per turn)
+    // One row per action.
+    ActionKind,  // PackedActionKind
+    ActionSide,  // 0 = A, 1 = B
+    ActionAgent, // AgentType of the active card
+    // One row per attack.
+    AttackThreshold,
+    AttackDice,
+    AttackHit,   // 1 if any die reached the threshold
+    // One row per attack die.
+    Roll
+};
+
+constexpr int kArchiveColumnCount = 10;
+// Rows per compressed chunk; chunks are the unit of decompression and of
+// parallel work, and line up across the columns of a table.
+constexpr int kArchiveChunkRows = 1 << 16;
+
+QString archiveColumnName(ArchiveColumn column);
+bool parseArchiveColumn(const QString &name, ArchiveColumn &out);
+
+// Collects finished games column by column and writes the archive. Full
+// chunks are compressed as they fill, so memory stays close to the
+// compressed size.
+class GameArchiveWriter
+{
+public:
+    GameArchiveWriter();
+
+    // Replays the game to derive the per-action columns.
+    bool addGame(const ReplayGame &game, QString &errorMessage);
+    bool write(const QString &path, QString &errorMessage);
+
+    qint64 gameCount() const;
+
+private:
+    struct Column {
+        int width{1};
+        qint64 rows{0};
+        quint32 maxValue{0};
+        QByteArray pending;
+        QVector<QByteArray> chunks;
+    };
+
+    void append(ArchiveColumn column, quint32 value);
+    void flush(Column &column);
+
+    std::array<Column, kArchiveColumnCount> columns;
+    QStringList mapNames;
+    QHash<QString, int> mapIndex;
+    ReplayStartCache starts;
+};
+
+// Read-only, memory-mapped archive. Chunks are decompressed on demand, and
+// every query splits the chunks into one contiguous range per pool thread.
+class GameArchive
+{
+public:
+    GameArchive() = default;
+    GameArchive(const GameArchive &) = delete;
+    GameArchive &operator=(const GameArchive &) = delete;
+
+    bool open(const QString &path, QString &errorMessage);
+    void close();
+
+    const QStringList &mapNames() const;
+    qint64 rows(ArchiveColumn column) const;
+    quint32 maxValue(ArchiveColumn column) const;
+    qint64 storedBytes(ArchiveColumn column) const;
+
+    // Row counts for every (a, b) value pair of two columns of the same
+    // table: counts[a * (maxValue(b) + 1) + b]. With b == a this is a plain
+    // histogram of a (only the diagonal is filled).
+    bool crossTabulate(ArchiveColumn a,
+                       ArchiveColumn b,
+                       int threads,
+                       QVector<qint64> &counts,
+                       QString &errorMessage) const;
+
+private:
+    struct Chunk {
+        qint64 offset{0};
+        qint64 size{0};
+        int rows{0};
+    };
+    struct Column {
+        int width{1};
+        qint64 rows{0};
+        quint32 maxValue{0};
+        QVector<Chunk> chunks;
+    };
+
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size{0};
+    QStringList maps;
+    std::array<Column, kArchiveColumnCount> columns;
+};
+
+} // namespace model
@@ -123,6 +123,34 @@ bool loadBoardFromMapFile(BoardState &board, const QString &path, QString &error
     return true;
 }
 
+void cloneBoard(const BoardState &from, BoardState &to)
+{
+    to.cells.clear();
+    to.byId.clear();
+    to.cells.reserve(from.cells.size());
+    to.byId.reserve(static_cast<int>(from.cells.size()));
+
+    QHash<const CellNode *, CellNode *> mapping;
+    mapping.reserve(static_cast<int>(from.cells.size()));
+
+    for (const auto &cell : from.cells) {
+        auto node = std::make_unique<CellNode>(*cell);
+        node->neighbors.clear();
+        CellNode *raw = node.get();
+        mapping.insert(cell.get(), raw);
+        to.byId.insert(raw->id, raw);
+        to.cells.push_back(std::move(node));
+    }
+
+    for (std::size_t i = 0; i < from.cells.size(); ++i) {
+        CellNode *copy = to.cells[i].get();
+        copy->neighbors.reserve(from.cells[i]->neighbors.size());
+        for (const CellNode *neighbor : from.cells[i]->neighbors) {
+            copy->neighbors.push_back(mapping.value(neighbor));
+        }
+    }
+}
+
 QVector<CellNode *> neighborsOf(BoardState &board, const QString &cellId)
 {
     const CellNode *cell = findCell(static_cast<const BoardState &>(board), cellId);
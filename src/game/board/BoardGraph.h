@@ -8,6 +8,7 @@ CellNode *findCell(BoardState &board, const QString &cellId);
 const CellNode *findCell(const BoardState &board, const QString &cellId);
 
 bool loadBoardFromMapFile(BoardState &board, const QString &path, QString &errorMessage);
+void cloneBoard(const BoardState &from, BoardState &to);
 QVector<CellNode *> neighborsOf(BoardState &board, const QString &cellId);
 QVector<const CellNode *> neighborsOf(const BoardState &board, const QString &cellId);
 
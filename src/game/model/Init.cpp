@@ -1,7 +1,10 @@
 #include "Init.h"
 
+#include "../board/BoardGraph.h"
 #include "../turn/TurnSystem.h"
 
+#include <QRandomGenerator>
+
 namespace model {
 
 int defaultHp(AgentType type)
@@ -85,11 +88,18 @@ PlayerState buildDefaultPlayer(PlayerId id, const QString &name)
 }
 
 GameState buildInitialGameState(const QString &playerAName, const QString &playerBName)
+{
+    return buildInitialGameState(playerAName, playerBName, *QRandomGenerator::global());
+}
+
+GameState buildInitialGameState(const QString &playerAName,
+                                const QString &playerBName,
+                                QRandomGenerator &rng)
 {
     GameState state;
     state.playerA = buildDefaultPlayer(PlayerId::A, playerAName);
     state.playerB = buildDefaultPlayer(PlayerId::B, playerBName);
-    shuffleAllDecks(state);
+    shuffleAllDecks(state, rng);
     state.turn.currentPlayer = PlayerId::A;
     state.turn.turnIndex = 1;
     state.turn.hasActiveCard = false;
@@ -97,6 +107,17 @@ GameState buildInitialGameState(const QString &playerAName, const QString &playe
     return state;
 }
 
+GameState cloneGameState(const GameState &state)
+{
+    GameState copy;
+    cloneBoard(state.board, copy.board);
+    copy.playerA = state.playerA;
+    copy.playerB = state.playerB;
+    copy.turn = state.turn;
+    copy.status = state.status;
+    return copy;
+}
+
 PlayerState *playerById(GameState &state, PlayerId id)
 {
     switch (id) {
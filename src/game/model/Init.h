@@ -2,6 +2,8 @@
 
 #include "Types.h"
 
+class QRandomGenerator;
+
 namespace model {
 
 int defaultHp(AgentType type);
@@ -10,6 +12,10 @@ DeckState buildDefaultDeck();
 QVector<AgentState> buildDefaultAgents(PlayerId owner);
 PlayerState buildDefaultPlayer(PlayerId id, const QString &name);
 GameState buildInitialGameState(const QString &playerAName, const QString &playerBName);
+GameState buildInitialGameState(const QString &playerAName,
+                                const QString &playerBName,
+                                QRandomGenerator &rng);
+GameState cloneGameState(const GameState &state);
 
 PlayerState *playerById(GameState &state, PlayerId id);
 const PlayerState *playerById(const GameState &state, PlayerId id);
@@ -0,0 +1,256 @@
+#include "PackedState.h"
+
+#include "Init.h"
+#include "../board/BoardGraph.h"
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+constexpr quint64 kFnvOffset = 14695981039346656037ull;
+constexpr quint64 kFnvPrime = 1099511628211ull;
+
+void mixByte(quint64 &hash, quint8 value)
+{
+    hash ^= value;
+    hash *= kFnvPrime;
+}
+
+void mixWord(quint64 &hash, quint64 value)
+{
+    for (int i = 0; i < 8; ++i) {
+        mixByte(hash, static_cast<quint8>(value >> (i * 8)));
+    }
+}
+
+} // namespace
+
+int sideIndex(PlayerId id)
+{
+    return id == PlayerId::B ? 1 : 0;
+}
+
+PlayerId sideOwner(int side)
+{
+    return side == 1 ? PlayerId::B : PlayerId::A;
+}
+
+bool buildPackedBoard(const BoardState &board, PackedBoard &out, QString &errorMessage)
+{
+    const int count = static_cast<int>(board.cells.size());
+    if (count == 0) {
+        errorMessage = QStringLiteral("Board is not loaded.");
+        return false;
+    }
+    if (count > kMaxPackedCells) {
+        errorMessage = QStringLiteral("Board has %1 cells; packed state supports at most %2.")
+                           .arg(count)
+                           .arg(kMaxPackedCells);
+        return false;
+    }
+
+    out = PackedBoard{};
+    out.cellCount = count;
+    out.cellIds.reserve(count);
+    out.indexById.reserve(count);
+
+    for (int i = 0; i < count; ++i) {
+        const CellNode *cell = board.cells[i].get();
+        out.cellIds.push_back(cell->id);
+        out.indexById.insert(cell->id, i);
+        out.shield[i] = static_cast<quint8>(std::clamp(cell->shield, 0, 255));
+        out.row[i] = static_cast<quint8>(std::clamp(cell->row, 0, 255));
+        out.col[i] = static_cast<quint8>(std::clamp(cell->col, 0, 255));
+    }
+
+    for (int i = 0; i < count; ++i) {
+        for (const CellNode *neighbor : board.cells[i]->neighbors) {
+            out.neighbors[i].set(out.indexById.value(neighbor->id));
+        }
+    }
+
+    for (int from = 0; from < count; ++from) {
+        for (int to = 0; to < count; ++to) {
+            const QVector<const CellNode *> path = shortestPath(board, out.cellIds[from], out.cellIds[to]);
+            if (path.isEmpty()) {
+                continue;
+            }
+            out.reachable[from].set(to);
+            out.pathShield[from][to] = static_cast<quint8>(std::min(pathShieldSum(path, true), 10));
+        }
+    }
+
+    return true;
+}
+
+quint64 packedBoardFingerprint(const PackedBoard &board)
+{
+    quint64 hash = kFnvOffset;
+    mixWord(hash, static_cast<quint64>(board.cellCount));
+    for (int i = 0; i < board.cellCount; ++i) {
+        for (const QChar ch : board.cellIds[i]) {
+            mixWord(hash, ch.unicode());
+        }
+        mixByte(hash, board.shield[i]);
+        mixWord(hash, board.neighbors[i].words[0]);
+        mixWord(hash, board.neighbors[i].words[1]);
+    }
+    return hash;
+}
+
+quint64 hashPackedState(const PackedState &state)
+{
+    quint64 hash = kFnvOffset;
+    for (const PackedSide &side : state.sides) {
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            mixByte(hash, static_cast<quint8>(side.agentCell[type]));
+            mixByte(hash, side.hp[type]);
+        }
+        mixByte(hash, side.deckSize);
+        for (int i = 0; i < side.deckSize; ++i) {
+            mixByte(hash, side.deck[i]);
+        }
+        mixWord(hash, side.marks.words[0]);
+        mixWord(hash, side.marks.words[1]);
+        mixWord(hash, side.control.words[0]);
+        mixWord(hash, side.control.words[1]);
+    }
+    mixByte(hash, state.currentSide);
+    mixByte(hash, state.hasActiveCard ? 1 : 0);
+    mixByte(hash, state.hasActiveCard ? state.activeCard : 0);
+    return hash;
+}
+
+CellMask changedPackedCells(const PackedState &from, const PackedState &to)
+{
+    CellMask changed;
+    for (int side = 0; side < 2; ++side) {
+        const PackedSide &a = from.sides[side];
+        const PackedSide &b = to.sides[side];
+        changed = changed | (a.marks ^ b.marks) | (a.control ^ b.control);
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            const bool aliveA = (a.aliveMask >> type) & 1u;
+            const bool aliveB = (b.aliveMask >> type) & 1u;
+            if (a.agentCell[type] == b.agentCell[type] && aliveA == aliveB) {
+                continue;
+            }
+            if (a.agentCell[type] != kNoCell) {
+                changed.set(a.agentCell[type]);
+            }
+            if (b.agentCell[type] != kNoCell) {
+                changed.set(b.agentCell[type]);
+            }
+        }
+    }
+    return changed;
+}
+
+bool packGameState(const GameState &state,
+                   const PackedBoard &board,
+                   PackedState &out,
+                   QString &errorMessage)
+{
+    if (static_cast<int>(state.board.cells.size()) != board.cellCount) {
+        errorMessage = QStringLiteral("Packed board does not match game board.");
+        return false;
+    }
+
+    out = PackedState{};
+
+    for (int side = 0; side < 2; ++side) {
+        const PlayerState *player = playerById(state, sideOwner(side));
+        PackedSide &packed = out.sides[side];
+
+        for (const AgentState &agent : player->agents) {
+            const int type = static_cast<int>(agent.type);
+            packed.hp[type] = static_cast<quint8>(std::max(agent.hp, 0));
+            if (!agent.alive) {
+                continue;
+            }
+            packed.aliveMask |= quint8(1u << type);
+            if (!agent.cellId.isEmpty()) {
+                packed.agentCell[type] = static_cast<qint8>(board.indexById.value(agent.cellId, kNoCell));
+            }
+        }
+
+        if (player->deck.drawPile.size() > kMaxDeckCards) {
+            errorMessage = QStringLiteral("Player %1 has more than %2 cards in deck.")
+                               .arg(playerIdName(player->id))
+                               .arg(kMaxDeckCards);
+            return false;
+        }
+        for (const Card &card : player->deck.drawPile) {
+            const int type = static_cast<int>(card.agent);
+            packed.deck[packed.deckSize++] = static_cast<quint8>(type);
+            ++packed.cardCount[type];
+        }
+    }
+
+    for (int i = 0; i < board.cellCount; ++i) {
+        const CellNode *cell = state.board.cells[i].get();
+        if (cell->markedByA) {
+            out.sides[0].marks.set(i);
+        }
+        if (cell->markedByB) {
+            out.sides[1].marks.set(i);
+        }
+        if (cell->controlledBy == PlayerId::A) {
+            out.sides[0].control.set(i);
+        } else if (cell->controlledBy == PlayerId::B) {
+            out.sides[1].control.set(i);
+        }
+    }
+
+    out.currentSide = static_cast<quint8>(sideIndex(state.turn.currentPlayer));
+    out.hasActiveCard = state.turn.hasActiveCard;
+    out.activeCard = static_cast<quint8>(state.turn.activeCard.agent);
+    out.status = state.status;
+    out.turnIndex = state.turn.turnIndex;
+    return true;
+}
+
+void unpackGameState(const PackedState &packed, const PackedBoard &board, GameState &state)
+{
+    for (int i = 0; i < board.cellCount; ++i) {
+        CellNode *cell = state.board.cells[i].get();
+        cell->markedByA = packed.sides[0].marks.test(i);
+        cell->markedByB = packed.sides[1].marks.test(i);
+        cell->controlledBy = packed.sides[0].control.test(i)   ? PlayerId::A
+                             : packed.sides[1].control.test(i) ? PlayerId::B
+                                                               : PlayerId::None;
+        cell->occupantA.reset();
+        cell->occupantB.reset();
+    }
+
+    for (int side = 0; side < 2; ++side) {
+        PlayerState *player = playerById(state, sideOwner(side));
+        const PackedSide &source = packed.sides[side];
+
+        for (AgentState &agent : player->agents) {
+            const int type = static_cast<int>(agent.type);
+            agent.hp = source.hp[type];
+            agent.alive = (source.aliveMask >> type) & 1u;
+            const int cell = agent.alive ? source.agentCell[type] : kNoCell;
+            agent.cellId = cell != kNoCell ? board.cellIds[cell] : QString();
+            if (cell != kNoCell) {
+                auto &occupant = side == 0 ? state.board.cells[cell]->occupantA : state.board.cells[cell]->occupantB;
+                occupant = agent.type;
+            }
+        }
+
+        player->deck.drawPile.clear();
+        for (int i = 0; i < source.deckSize; ++i) {
+            player->deck.drawPile.append(Card{static_cast<AgentType>(source.deck[i])});
+        }
+    }
+
+    state.turn.currentPlayer = sideOwner(packed.currentSide);
+    state.turn.turnIndex = packed.turnIndex;
+    state.turn.hasActiveCard = packed.hasActiveCard;
+    state.turn.activeCard = Card{static_cast<AgentType>(packed.activeCard)};
+    state.status = packed.status;
+}
+
+} // namespace model
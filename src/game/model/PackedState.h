@@ -0,0 +1,143 @@
+#pragma once
+
+#include "Types.h"
+
+#include <QtAlgorithms>
+
+#include <array>
+
+namespace model {
+
+constexpr int kMaxPackedCells = 128;
+constexpr int kAgentTypeCount = 3;
+constexpr int kMaxDeckCards = 10;
+constexpr qint8 kNoCell = -1;
+
+struct CellMask {
+    std::array<quint64, 2> words{};
+
+    bool test(int index) const
+    {
+        return (words[index >> 6] >> (index & 63)) & 1u;
+    }
+
+    void set(int index)
+    {
+        words[index >> 6] |= quint64(1) << (index & 63);
+    }
+
+    void reset(int index)
+    {
+        words[index >> 6] &= ~(quint64(1) << (index & 63));
+    }
+
+    bool any() const
+    {
+        return (words[0] | words[1]) != 0;
+    }
+
+    int count() const
+    {
+        return int(qPopulationCount(words[0]) + qPopulationCount(words[1]));
+    }
+
+    CellMask operator&(const CellMask &other) const
+    {
+        return CellMask{{words[0] & other.words[0], words[1] & other.words[1]}};
+    }
+
+    CellMask operator|(const CellMask &other) const
+    {
+        return CellMask{{words[0] | other.words[0], words[1] | other.words[1]}};
+    }
+
+    CellMask operator^(const CellMask &other) const
+    {
+        return CellMask{{words[0] ^ other.words[0], words[1] ^ other.words[1]}};
+    }
+
+    CellMask operator~() const
+    {
+        return CellMask{{~words[0], ~words[1]}};
+    }
+
+    bool operator==(const CellMask &other) const
+    {
+        return words == other.words;
+    }
+
+    bool operator!=(const CellMask &other) const
+    {
+        return words != other.words;
+    }
+};
+
+// Index-based copy of the board topology. Everything the rules need per cell
+// pair is precomputed so packed consumers never touch QString ids or BFS.
+struct PackedBoard {
+    int cellCount{0};
+    QVector<QString> cellIds;
+    QHash<QString, int> indexById;
+
+    std::array<quint8, kMaxPackedCells> shield{};
+    // Grid position from the board file (row, column within the row).
+    std::array<quint8, kMaxPackedCells> row{};
+    std::array<quint8, kMaxPackedCells> col{};
+    std::array<CellMask, kMaxPackedCells> neighbors{};
+
+    // Shield sum on the engine's shortestPath() between two cells, endpoints
+    // excluded, clamped to 10 (the attack threshold cap).
+    std::array<std::array<quint8, kMaxPackedCells>, kMaxPackedCells> pathShield{};
+    std::array<CellMask, kMaxPackedCells> reachable{};
+};
+
+struct PackedSide {
+    std::array<qint8, kAgentTypeCount> agentCell{{kNoCell, kNoCell, kNoCell}};
+    std::array<quint8, kAgentTypeCount> hp{};
+    std::array<quint8, kAgentTypeCount> cardCount{};
+    std::array<quint8, kMaxDeckCards> deck{};
+    quint8 deckSize{0};
+    quint8 aliveMask{0};
+    CellMask marks;
+    CellMask control;
+};
+
+// Fixed-size snapshot of a GameState. Sides are indexed 0 = A, 1 = B; agents
+// and cards are indexed by AgentType. cardCount mirrors countCards(), i.e. it
+// excludes the active card of the player whose turn it is.
+struct PackedState {
+    std::array<PackedSide, 2> sides{};
+    quint8 currentSide{0};
+    bool hasActiveCard{false};
+    quint8 activeCard{0};
+    GameStatus status{GameStatus::InProgress};
+    int turnIndex{1};
+};
+
+int sideIndex(PlayerId id);
+PlayerId sideOwner(int side);
+
+bool buildPackedBoard(const BoardState &board, PackedBoard &out, QString &errorMessage);
+
+// Identifies the board topology and shields; used to tie saved data to a board.
+quint64 packedBoardFingerprint(const PackedBoard &board);
+
+// Hash of everything that affects play from here on: agents, hp, deck order,
+// marks, control, side to move and active card. Ignores turnIndex and the
+// unused tail of the deck arrays.
+quint64 hashPackedState(const PackedState &state);
+
+// Cells whose occupants, marks or control differ between two states on the
+// same board; what a view has to repaint when it moves from one to the other.
+CellMask changedPackedCells(const PackedState &from, const PackedState &to);
+
+bool packGameState(const GameState &state,
+                   const PackedBoard &board,
+                   PackedState &out,
+                   QString &errorMessage);
+
+// Inverse of packGameState() for a state already loaded on the same board:
+// overwrites agents, decks, marks, control, occupants, turn and status.
+void unpackGameState(const PackedState &packed, const PackedBoard &board, GameState &state);
+
+} // namespace model
@@ -0,0 +1,379 @@
+#include "EngineProtocol.h"
+
+#include "../actions/LegalActions.h"
+#include "../ai/Evaluation.h"
+#include "../model/Init.h"
+#include "../rules/PackedRules.h"
+#include "../session/ActionCommand.h"
+#include "../turn/TurnSystem.h"
+
+#include <QThread>
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+constexpr int kProtocolVersion = 1;
+
+QString statusName(GameStatus status)
+{
+    switch (status) {
+    case GameStatus::InProgress:
+        return QStringLiteral("in_progress");
+    case GameStatus::WonByA:
+        return QStringLiteral("won_by_a");
+    case GameStatus::WonByB:
+        return QStringLiteral("won_by_b");
+    }
+    return QStringLiteral("unknown");
+}
+
+QString statusLine(const GameState &state)
+{
+    return QStringLiteral("status %1 turn %2 side %3 card %4")
+        .arg(statusName(state.status))
+        .arg(state.turn.turnIndex)
+        .arg(playerIdName(state.turn.currentPlayer),
+             state.turn.hasActiveCard ? agentTypeName(state.turn.activeCard.agent) : QStringLiteral("none"));
+}
+
+} // namespace
+
+EngineProtocol::EngineProtocol(EngineOutputFn output)
+    : output_(std::move(output)),
+      session_(state_),
+      searching_(std::make_shared<std::atomic_bool>(false))
+{
+}
+
+EngineProtocol::~EngineProtocol()
+{
+    stopSearch();
+}
+
+bool EngineProtocol::handleLine(const QString &line)
+{
+    const QStringList parts = line.simplified().split(QLatin1Char(' '), Qt::SkipEmptyParts);
+    if (parts.isEmpty()) {
+        return true;
+    }
+
+    const QString command = parts[0].toLower();
+    const QStringList args = parts.mid(1);
+
+    if (command == QLatin1String("uei")) {
+        reply(QStringLiteral("id name undaunted"));
+        reply(QStringLiteral("id protocol %1").arg(kProtocolVersion));
+        reply(QStringLiteral("ueiok"));
+        return true;
+    }
+    if (command == QLatin1String("isready")) {
+        reply(QStringLiteral("readyok"));
+        return true;
+    }
+    if (command == QLatin1String("quit")) {
+        stopSearch();
+        return false;
+    }
+    if (command == QLatin1String("stop")) {
+        stopSearch();
+        return true;
+    }
+    if (command == QLatin1String("legal")) {
+        handleLegal();
+        return true;
+    }
+    if (command == QLatin1String("show")) {
+        handleShow();
+        return true;
+    }
+
+    const bool changesPosition = command == QLatin1String("load") || command == QLatin1String("seed") ||
+                                 command == QLatin1String("weights") || command == QLatin1String("network") ||
+                                 command == QLatin1String("tablebase") ||
+                                 command == QLatin1String("push") || command == QLatin1String("go");
+    if (changesPosition && isSearching()) {
+        reply(QStringLiteral("error search in progress"));
+        return true;
+    }
+
+    if (command == QLatin1String("load")) {
+        handleLoad(args);
+    } else if (command == QLatin1String("seed")) {
+        handleSeed(args);
+    } else if (command == QLatin1String("weights")) {
+        handleWeights(args);
+    } else if (command == QLatin1String("network")) {
+        handleNetwork(args);
+    } else if (command == QLatin1String("tablebase")) {
+        handleTablebase(args);
+    } else if (command == QLatin1String("push")) {
+        handlePush(args.join(QLatin1Char(' ')));
+    } else if (command == QLatin1String("go")) {
+        handleGo(args);
+    } else {
+        reply(QStringLiteral("error unknown command: %1").arg(command));
+    }
+    return true;
+}
+
+bool EngineProtocol::isSearching() const
+{
+    return searching_->load();
+}
+
+void EngineProtocol::stopSearch()
+{
+    if (cancel_) {
+        cancel_->store(true);
+    }
+    joinSearch();
+}
+
+void EngineProtocol::waitForSearch()
+{
+    joinSearch();
+}
+
+void EngineProtocol::reply(const QString &line) const
+{
+    if (output_) {
+        output_(line);
+    }
+}
+
+void EngineProtocol::handleLoad(const QStringList &args)
+{
+    if (args.size() != 2) {
+        reply(QStringLiteral("error usage: load <board> <scenario>"));
+        return;
+    }
+
+    // Every load starts from the last `seed`, so the same commands always
+    // deal the same decks and dice.
+    session_.setSeed(session_.seed());
+
+    QString errorMessage;
+    auto board = std::make_shared<PackedBoard>();
+    if (!session_.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), args[0], args[1], true, errorMessage) ||
+        !buildPackedBoard(state_.board, *board, errorMessage) ||
+        (options_.network && !boardFitsFeatures(*board, errorMessage))) {
+        board_.reset();
+        reply(QStringLiteral("error %1").arg(errorMessage));
+        return;
+    }
+
+    board_ = std::move(board);
+    tablebase_.reset();
+    reply(QStringLiteral("ok loaded %1 cells").arg(board_->cellCount));
+}
+
+void EngineProtocol::handleSeed(const QStringList &args)
+{
+    bool ok = args.size() == 1;
+    const quint32 seed = ok ? args[0].toUInt(&ok) : 0;
+    if (!ok) {
+        reply(QStringLiteral("error usage: seed <unsigned>"));
+        return;
+    }
+    session_.setSeed(seed);
+    reply(QStringLiteral("ok seed %1").arg(seed));
+}
+
+void EngineProtocol::handleWeights(const QStringList &args)
+{
+    QString errorMessage;
+    if (args.size() != 1) {
+        reply(QStringLiteral("error usage: weights <path>"));
+    } else if (!loadEvalWeights(options_.weights, args[0], errorMessage)) {
+        reply(QStringLiteral("error %1").arg(errorMessage));
+    } else {
+        reply(QStringLiteral("ok weights"));
+    }
+}
+
+void EngineProtocol::handleNetwork(const QStringList &args)
+{
+    if (args.size() != 1) {
+        reply(QStringLiteral("error usage: network <path> | network off"));
+        return;
+    }
+    if (args[0] == QLatin1String("off")) {
+        options_.network.reset();
+        reply(QStringLiteral("ok network off"));
+        return;
+    }
+
+    QString errorMessage;
+    auto network = std::make_shared<EvalNetwork>();
+    if (!network->load(args[0], errorMessage) || (board_ && !boardFitsFeatures(*board_, errorMessage))) {
+        reply(QStringLiteral("error %1").arg(errorMessage));
+        return;
+    }
+    options_.network = std::move(network);
+    reply(QStringLiteral("ok network %1").arg(QString::fromLatin1(networkSimdBackend())));
+}
+
+void EngineProtocol::handleTablebase(const QStringList &args)
+{
+    if (args.size() != 1) {
+        reply(QStringLiteral("error usage: tablebase <path>"));
+        return;
+    }
+    if (!board_) {
+        reply(QStringLiteral("error load a board first"));
+        return;
+    }
+
+    QString errorMessage;
+    auto tablebase = std::make_shared<Tablebase>();
+    if (!tablebase->open(args[0], *board_, errorMessage)) {
+        reply(QStringLiteral("error %1").arg(errorMessage));
+        return;
+    }
+    tablebase_ = std::move(tablebase);
+    reply(QStringLiteral("ok tablebase %1 positions").arg(tablebase_->size()));
+}
+
+void EngineProtocol::handleLegal()
+{
+    QStringList texts;
+    for (const GameAction &action : legalActions(state_)) {
+        texts.append(actionText(action));
+    }
+    reply(QStringLiteral("legal %1 %2").arg(texts.size()).arg(texts.join(QLatin1Char(';'))).trimmed());
+}
+
+void EngineProtocol::handlePush(const QString &text)
+{
+    GameAction action;
+    QString errorMessage;
+    if (!parseActionText(text, action, errorMessage)) {
+        reply(QStringLiteral("error %1").arg(errorMessage));
+        return;
+    }
+
+    const CommandResult result = executeAction(session_, action);
+    if (!result.ok) {
+        reply(QStringLiteral("error %1").arg(result.message));
+        return;
+    }
+    reply(QStringLiteral("ok %1").arg(result.message));
+    reply(statusLine(state_));
+}
+
+void EngineProtocol::handleShow()
+{
+    reply(statusLine(state_));
+    for (const PlayerState *player : {&state_.playerA, &state_.playerB}) {
+        const QString side = playerIdName(player->id);
+        for (const AgentState &agent : player->agents) {
+            reply(QStringLiteral("agent %1 %2 %3 hp %4 cards %5")
+                      .arg(side, agentTypeName(agent.type),
+                           agent.alive && !agent.cellId.isEmpty() ? agent.cellId : QStringLiteral("-"))
+                      .arg(agent.hp)
+                      .arg(countCards(*player, agent.type)));
+        }
+
+        QStringList marks;
+        QStringList control;
+        for (const auto &cell : state_.board.cells) {
+            if (player->id == PlayerId::A ? cell->markedByA : cell->markedByB) {
+                marks.append(cell->id);
+            }
+            if (cell->controlledBy == player->id) {
+                control.append(cell->id);
+            }
+        }
+        reply(QStringLiteral("marks %1 %2").arg(side, marks.join(QLatin1Char(' '))).trimmed());
+        reply(QStringLiteral("control %1 %2").arg(side, control.join(QLatin1Char(' '))).trimmed());
+    }
+    reply(QStringLiteral("end"));
+}
+
+void EngineProtocol::handleGo(const QStringList &args)
+{
+    if (args.size() % 2 != 0) {
+        reply(QStringLiteral("error usage: go [depth <n>] [movetime <ms>]"));
+        return;
+    }
+
+    SearchOptions searchOptions = options_;
+    for (int i = 0; i + 1 < args.size(); i += 2) {
+        bool ok = false;
+        const qint64 value = args[i + 1].toLongLong(&ok);
+        if (!ok || value <= 0) {
+            reply(QStringLiteral("error invalid go value: %1").arg(args[i + 1]));
+            return;
+        }
+        if (args[i] == QLatin1String("depth")) {
+            searchOptions.maxDepth = static_cast<int>(value);
+        } else if (args[i] == QLatin1String("movetime")) {
+            searchOptions.timeMs = value;
+        } else {
+            reply(QStringLiteral("error unknown go option: %1").arg(args[i]));
+            return;
+        }
+    }
+
+    PackedState snapshot;
+    QString errorMessage;
+    if (!board_ || !packGameState(state_, *board_, snapshot, errorMessage) ||
+        snapshot.status != GameStatus::InProgress) {
+        reply(QStringLiteral("bestmove none"));
+        return;
+    }
+
+    joinSearch();
+    cancel_ = std::make_shared<std::atomic_bool>(false);
+    searching_->store(true);
+
+    // The worker owns copies of everything it touches, so the protocol object
+    // only has to outlive it through joinSearch().
+    const EngineOutputFn output = output_;
+    const std::shared_ptr<const PackedBoard> board = board_;
+    const std::shared_ptr<const Tablebase> tablebase = tablebase_;
+    const std::shared_ptr<std::atomic_bool> cancel = cancel_;
+    const std::shared_ptr<std::atomic_bool> searching = searching_;
+    worker_ = QThread::create([output, board, tablebase, cancel, searching, searchOptions, snapshot]() {
+        SearchOptions withTablebase = searchOptions;
+        withTablebase.tablebase = tablebase.get();
+
+        // A stopped search returns nothing, so keep the last finished depth.
+        SearchInfo best;
+        const auto onProgress = [&](const SearchInfo &info) {
+            best = info;
+            const qint64 nps = info.nodes * 1000 / std::max<qint64>(info.elapsedMs, 1);
+            output(QStringLiteral("info depth %1 score %2 nodes %3 time %4 nps %5 pv %6")
+                       .arg(info.depth)
+                       .arg(info.score)
+                       .arg(info.nodes)
+                       .arg(info.elapsedMs)
+                       .arg(nps)
+                       .arg(actionText(toGameAction(*board, info.action))));
+        };
+
+        const SearchInfo result = searchBestAction(*board, snapshot, withTablebase, cancel.get(), onProgress);
+        if (result.hasAction) {
+            best = result;
+        }
+        output(best.hasAction
+                   ? QStringLiteral("bestmove %1").arg(actionText(toGameAction(*board, best.action)))
+                   : QStringLiteral("bestmove none"));
+        searching->store(false);
+    });
+    worker_->start();
+}
+
+void EngineProtocol::joinSearch()
+{
+    if (worker_ != nullptr) {
+        worker_->wait();
+        delete worker_;
+        worker_ = nullptr;
+    }
+}
+
+} // namespace model
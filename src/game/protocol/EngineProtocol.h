@@ -0,0 +1,65 @@
+#pragma once
+
+#include "../ai/Search.h"
+#include "../ai/Tablebase.h"
+#include "../session/GameSession.h"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+
+class QThread;
+
+namespace model {
+
+// Receives every reply line (without the newline). Called from the thread
+// that calls handleLine() and, while a search runs, from the search thread.
+using EngineOutputFn = std::function<void(const QString &line)>;
+
+// One engine instance speaking the line protocol described in README.md:
+// a GameSession plus an optional background search. Commands that change
+// the position are rejected while a search runs; "stop" ends it early.
+class EngineProtocol
+{
+public:
+    explicit EngineProtocol(EngineOutputFn output);
+    ~EngineProtocol();
+
+    EngineProtocol(const EngineProtocol &) = delete;
+    EngineProtocol &operator=(const EngineProtocol &) = delete;
+
+    // Returns false once "quit" has been handled.
+    bool handleLine(const QString &line);
+
+    bool isSearching() const;
+    // Cancels a running search and waits for its bestmove line.
+    void stopSearch();
+    // Lets a running search finish and waits for its bestmove line.
+    void waitForSearch();
+
+private:
+    void reply(const QString &line) const;
+    void handleLoad(const QStringList &args);
+    void handleSeed(const QStringList &args);
+    void handleWeights(const QStringList &args);
+    void handleNetwork(const QStringList &args);
+    void handleTablebase(const QStringList &args);
+    void handleLegal();
+    void handlePush(const QString &actionText);
+    void handleShow();
+    void handleGo(const QStringList &args);
+    void joinSearch();
+
+    EngineOutputFn output_;
+    GameState state_;
+    GameSession session_;
+    std::shared_ptr<const PackedBoard> board_;
+    std::shared_ptr<const Tablebase> tablebase_;
+    SearchOptions options_;
+
+    QThread *worker_ = nullptr;
+    std::shared_ptr<std::atomic_bool> cancel_;
+    std::shared_ptr<std::atomic_bool> searching_;
+};
+
+} // namespace model
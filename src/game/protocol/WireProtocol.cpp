@@ -0,0 +1,336 @@
+#include "WireProtocol.h"
+
+#include "../turn/TurnSystem.h"
+
+#include <QtEndian>
+
+namespace model {
+
+namespace {
+
+constexpr quint8 kNoActiveCard = 0xff;
+
+enum WireActionKind : quint8 {
+    kWireMove = 0,
+    kWireAttack = 1,
+    kWireMark = 2,
+    kWireControl = 3,
+    kWireRelease = 4
+};
+
+quint8 cellFlags(const CellNode &cell)
+{
+    quint8 flags = (cell.markedByA ? 1 : 0) | (cell.markedByB ? 2 : 0);
+    if (cell.controlledBy == PlayerId::A) {
+        flags |= 1 << 2;
+    } else if (cell.controlledBy == PlayerId::B) {
+        flags |= 2 << 2;
+    }
+    return flags;
+}
+
+} // namespace
+
+WireWriter::WireWriter(WireMessage type)
+{
+    payload.reserve(64);
+    payload.append(static_cast<char>(type));
+}
+
+void WireWriter::u8(quint8 value)
+{
+    payload.append(static_cast<char>(value));
+}
+
+void WireWriter::u16(quint16 value)
+{
+    char bytes[2];
+    qToLittleEndian(value, bytes);
+    payload.append(bytes, sizeof(bytes));
+}
+
+void WireWriter::u32(quint32 value)
+{
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    payload.append(bytes, sizeof(bytes));
+}
+
+void WireWriter::string(const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8().left(0xffff);
+    u16(static_cast<quint16>(utf8.size()));
+    payload.append(utf8);
+}
+
+QByteArray WireWriter::frame() const
+{
+    QByteArray out(4, Qt::Uninitialized);
+    qToLittleEndian(static_cast<quint32>(payload.size()), out.data());
+    out.append(payload);
+    return out;
+}
+
+WireReader::WireReader(const QByteArray &payload)
+    : payload(payload),
+      valid(!payload.isEmpty())
+{
+}
+
+WireMessage WireReader::type() const
+{
+    return payload.isEmpty() ? WireMessage::Error : static_cast<WireMessage>(payload.at(0));
+}
+
+bool WireReader::take(int bytes)
+{
+    if (!valid || payload.size() - position < bytes) {
+        valid = false;
+        return false;
+    }
+    position += bytes;
+    return true;
+}
+
+quint8 WireReader::u8()
+{
+    return take(1) ? static_cast<quint8>(payload.at(position - 1)) : 0;
+}
+
+quint16 WireReader::u16()
+{
+    return take(2) ? qFromLittleEndian<quint16>(payload.constData() + position - 2) : 0;
+}
+
+quint32 WireReader::u32()
+{
+    return take(4) ? qFromLittleEndian<quint32>(payload.constData() + position - 4) : 0;
+}
+
+QString WireReader::string()
+{
+    const int size = u16();
+    return take(size) ? QString::fromUtf8(payload.constData() + position - size, size) : QString();
+}
+
+bool WireReader::ok() const
+{
+    return valid;
+}
+
+bool WireReader::atEnd() const
+{
+    return position == payload.size();
+}
+
+WireFrameStatus takeWireFrame(const QByteArray &buffer, int &offset, QByteArray &payload)
+{
+    if (buffer.size() - offset < 4) {
+        return WireFrameStatus::Incomplete;
+    }
+    const quint32 size = qFromLittleEndian<quint32>(buffer.constData() + offset);
+    if (size == 0 || size > quint32(kWireMaxFrameBytes)) {
+        return WireFrameStatus::Oversized;
+    }
+    if (quint32(buffer.size() - offset - 4) < size) {
+        return WireFrameStatus::Incomplete;
+    }
+    payload = buffer.mid(offset + 4, static_cast<int>(size));
+    offset += 4 + static_cast<int>(size);
+    return WireFrameStatus::Ready;
+}
+
+void writeWireAction(WireWriter &writer, const GameAction &action, const QHash<QString, int> &cellIndex)
+{
+    quint8 kind = kWireMove;
+    if (action.kind == ActionKind::Attack) {
+        kind = kWireAttack;
+    } else if (action.kind == ActionKind::Special) {
+        switch (action.special) {
+        case AgentSpecialAction::ScoutMark:
+            kind = kWireMark;
+            break;
+        case AgentSpecialAction::SergeantControl:
+            kind = kWireControl;
+            break;
+        case AgentSpecialAction::SergeantRelease:
+            kind = kWireRelease;
+            break;
+        }
+    }
+    writer.u8(kind);
+    writer.u16(action.kind == ActionKind::Special ? kWireNoCell
+                                                   : static_cast<quint16>(cellIndex.value(action.cellId, kWireNoCell)));
+}
+
+bool readWireAction(WireReader &reader, const BoardState &board, GameAction &out, QString &errorMessage)
+{
+    const quint8 kind = reader.u8();
+    const quint16 cell = reader.u16();
+    if (!reader.ok()) {
+        errorMessage = QStringLiteral("Truncated action.");
+        return false;
+    }
+
+    switch (kind) {
+    case kWireMove:
+    case kWireAttack:
+        if (cell >= board.cells.size()) {
+            errorMessage = QStringLiteral("Invalid cell index: %1").arg(cell);
+            return false;
+        }
+        out = GameAction{kind == kWireMove ? ActionKind::Move : ActionKind::Attack,
+                         board.cells[cell]->id,
+                         AgentSpecialAction::ScoutMark};
+        return true;
+    case kWireMark:
+        out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::ScoutMark};
+        return true;
+    case kWireControl:
+        out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantControl};
+        return true;
+    case kWireRelease:
+        out = GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantRelease};
+        return true;
+    }
+
+    errorMessage = QStringLiteral("Invalid action kind: %1").arg(kind);
+    return false;
+}
+
+bool WireAgent::operator==(const WireAgent &other) const
+{
+    return cell == other.cell && hp == other.hp && cards == other.cards;
+}
+
+bool WireAgent::operator!=(const WireAgent &other) const
+{
+    return !(*this == other);
+}
+
+QHash<QString, int> wireCellIndex(const BoardState &board)
+{
+    QHash<QString, int> index;
+    index.reserve(static_cast<int>(board.cells.size()));
+    for (int i = 0; i < static_cast<int>(board.cells.size()); ++i) {
+        index.insert(board.cells[i]->id, i);
+    }
+    return index;
+}
+
+void captureWireSnapshot(const GameState &state, const QHash<QString, int> &cellIndex, WireSnapshot &out)
+{
+    out.status = state.status;
+    out.side = state.turn.currentPlayer;
+    out.hasActiveCard = state.turn.hasActiveCard;
+    out.activeCard = state.turn.activeCard.agent;
+    out.turnIndex = static_cast<quint32>(state.turn.turnIndex);
+
+    out.cells.resize(static_cast<int>(state.board.cells.size()));
+    for (int i = 0; i < out.cells.size(); ++i) {
+        out.cells[i] = cellFlags(*state.board.cells[i]);
+    }
+
+    out.agents.fill(WireAgent{});
+    for (const PlayerState *player : {&state.playerA, &state.playerB}) {
+        const int base = player->id == PlayerId::B ? 3 : 0;
+        for (const AgentState &agent : player->agents) {
+            WireAgent &wire = out.agents[base + static_cast<int>(agent.type)];
+            wire.cell = agent.alive ? static_cast<quint16>(cellIndex.value(agent.cellId, kWireNoCell)) : kWireNoCell;
+            wire.hp = static_cast<quint8>(qMax(agent.hp, 0));
+            wire.cards = static_cast<quint8>(countCards(*player, agent.type));
+        }
+    }
+}
+
+void writeWireDelta(WireWriter &writer, const WireSnapshot &previous, const WireSnapshot &current)
+{
+    writer.u8(static_cast<quint8>(current.status));
+    writer.u8(current.side == PlayerId::B ? 1 : 0);
+    writer.u8(current.hasActiveCard ? static_cast<quint8>(current.activeCard) : kNoActiveCard);
+    writer.u32(current.turnIndex);
+
+    const bool full = previous.cells.size() != current.cells.size();
+    int changedCells = 0;
+    for (int i = 0; i < current.cells.size(); ++i) {
+        changedCells += full || previous.cells[i] != current.cells[i] ? 1 : 0;
+    }
+    writer.u16(static_cast<quint16>(changedCells));
+    for (int i = 0; i < current.cells.size(); ++i) {
+        if (full || previous.cells[i] != current.cells[i]) {
+            writer.u16(static_cast<quint16>(i));
+            writer.u8(current.cells[i]);
+        }
+    }
+
+    int changedAgents = 0;
+    for (size_t i = 0; i < current.agents.size(); ++i) {
+        changedAgents += full || previous.agents[i] != current.agents[i] ? 1 : 0;
+    }
+    writer.u8(static_cast<quint8>(changedAgents));
+    for (size_t i = 0; i < current.agents.size(); ++i) {
+        if (full || previous.agents[i] != current.agents[i]) {
+            writer.u8(static_cast<quint8>(i));
+            writer.u16(current.agents[i].cell);
+            writer.u8(current.agents[i].hp);
+            writer.u8(current.agents[i].cards);
+        }
+    }
+}
+
+bool readWireDelta(WireReader &reader, WireSnapshot &state, QString &errorMessage)
+{
+    const quint8 status = reader.u8();
+    const quint8 side = reader.u8();
+    const quint8 activeCard = reader.u8();
+    const quint32 turnIndex = reader.u32();
+    if (status > static_cast<quint8>(GameStatus::WonByB) || side > 1 ||
+        (activeCard != kNoActiveCard && activeCard > static_cast<quint8>(AgentType::Sergeant))) {
+        errorMessage = QStringLiteral("Invalid state header.");
+        return false;
+    }
+    state.status = static_cast<GameStatus>(status);
+    state.side = side == 1 ? PlayerId::B : PlayerId::A;
+    state.hasActiveCard = activeCard != kNoActiveCard;
+    state.activeCard = state.hasActiveCard ? static_cast<AgentType>(activeCard) : AgentType::Scout;
+    state.turnIndex = turnIndex;
+
+    const int cells = reader.u16();
+    for (int i = 0; i < cells && reader.ok(); ++i) {
+        const quint16 cell = reader.u16();
+        const quint8 flags = reader.u8();
+        if (!reader.ok()) {
+            break;
+        }
+        if (cell >= state.cells.size()) {
+            errorMessage = QStringLiteral("Invalid cell index in delta: %1").arg(cell);
+            return false;
+        }
+        state.cells[cell] = flags;
+    }
+
+    const int agents = reader.u8();
+    for (int i = 0; i < agents && reader.ok(); ++i) {
+        const quint8 agent = reader.u8();
+        WireAgent value;
+        value.cell = reader.u16();
+        value.hp = reader.u8();
+        value.cards = reader.u8();
+        if (!reader.ok()) {
+            break;
+        }
+        if (agent >= state.agents.size()) {
+            errorMessage = QStringLiteral("Invalid agent index in delta: %1").arg(agent);
+            return false;
+        }
+        state.agents[agent] = value;
+    }
+
+    if (!reader.ok()) {
+        errorMessage = QStringLiteral("Truncated state delta.");
+        return false;
+    }
+    return true;
+}
+
+} // namespace model
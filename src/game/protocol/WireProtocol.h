@@ -0,0 +1,129 @@
+#pragma once
+
+#include "../actions/LegalActions.h"
+#include "../model/Types.h"
+
+#include <QByteArray>
+
+#include <array>
+
+namespace model {
+
+// Binary protocol spoken by undaunted-server. Every frame is a u32
+// little-endian payload length followed by the payload; the payload starts
+// with a WireMessage byte. Integers are little-endian, strings are a u16
+// byte count plus UTF-8, cells are u16 indexes into the board's cell list
+// (sent once in SessionCreated), kWireNoCell meaning "none".
+constexpr quint16 kWireVersion = 1;
+constexpr int kWireMaxFrameBytes = 64 * 1024;
+constexpr quint16 kWireNoCell = 0xffff;
+
+enum class WireMessage : quint8 {
+    // Client to server.
+    Hello = 0x01,          // u16 version
+    CreateSession = 0x02,  // u32 request, u32 seed, str map
+    CloseSession = 0x03,   // u32 request, u32 session
+    Legal = 0x04,          // u32 request, u32 session
+    Action = 0x05,         // u32 request, u32 session, action
+
+    // Server to client.
+    Welcome = 0x81,        // u16 version, u16 worker threads
+    SessionCreated = 0x82, // u32 request, u32 session, u16 n, n x str cell id, delta
+    SessionClosed = 0x83,  // u32 request, u32 session
+    LegalActions = 0x84,   // u32 request, u32 session, u16 n, n x action
+    ActionResult = 0x85,   // u32 request, u32 session, u8 ok, then delta if ok else str message
+    Error = 0x86,          // u32 request (0 if not tied to one), str message
+};
+
+enum class WireFrameStatus {
+    Incomplete,
+    Ready,
+    Oversized
+};
+
+class WireWriter
+{
+public:
+    explicit WireWriter(WireMessage type);
+
+    void u8(quint8 value);
+    void u16(quint16 value);
+    void u32(quint32 value);
+    void string(const QString &value);
+
+    // Length prefix plus payload, ready to write to a socket.
+    QByteArray frame() const;
+
+private:
+    QByteArray payload;
+};
+
+// Reads one payload. Reading past the end yields zeros and clears ok(), so
+// handlers can decode every field first and check once.
+class WireReader
+{
+public:
+    explicit WireReader(const QByteArray &payload);
+
+    WireMessage type() const;
+    quint8 u8();
+    quint16 u16();
+    quint32 u32();
+    QString string();
+
+    bool ok() const;
+    bool atEnd() const;
+
+private:
+    bool take(int bytes);
+
+    QByteArray payload;
+    int position{1};
+    bool valid{true};
+};
+
+// Extracts the frame starting at `offset` in a stream buffer and advances
+// `offset` past it. Callers drop the consumed prefix once per read instead
+// of once per frame.
+WireFrameStatus takeWireFrame(const QByteArray &buffer, int &offset, QByteArray &payload);
+
+// Actions are u8 kind (0 move, 1 attack, 2 mark, 3 control, 4 release)
+// plus a u16 cell.
+void writeWireAction(WireWriter &writer, const GameAction &action, const QHash<QString, int> &cellIndex);
+bool readWireAction(WireReader &reader, const BoardState &board, GameAction &out, QString &errorMessage);
+
+struct WireAgent {
+    quint16 cell{kWireNoCell};
+    quint8 hp{0};
+    quint8 cards{0};
+
+    bool operator==(const WireAgent &other) const;
+    bool operator!=(const WireAgent &other) const;
+};
+
+// What a client can see of one game. Agents are indexed side * 3 + AgentType;
+// dead or missing agents have cell kWireNoCell.
+struct WireSnapshot {
+    GameStatus status{GameStatus::InProgress};
+    PlayerId side{PlayerId::A};
+    bool hasActiveCard{false};
+    AgentType activeCard{AgentType::Scout};
+    quint32 turnIndex{1};
+    // Per cell: bit 0 marked by A, bit 1 marked by B, bits 2-3 controller
+    // (0 none, 1 A, 2 B).
+    QVector<quint8> cells;
+    std::array<WireAgent, 6> agents{};
+};
+
+QHash<QString, int> wireCellIndex(const BoardState &board);
+void captureWireSnapshot(const GameState &state, const QHash<QString, int> &cellIndex, WireSnapshot &out);
+
+// Delta body: u8 status, u8 side, u8 active card (0xff none), u32 turn,
+// u16 n, n x (u16 cell, u8 flags), u8 m, m x (u8 agent, u16 cell, u8 hp,
+// u8 cards). Everything differing from `previous` is sent; pass an empty
+// snapshot to send the full state.
+void writeWireDelta(WireWriter &writer, const WireSnapshot &previous, const WireSnapshot &current);
+// Applies a delta to `state`, whose cells must already be sized for the board.
+bool readWireDelta(WireReader &reader, WireSnapshot &state, QString &errorMessage);
+
+} // namespace model
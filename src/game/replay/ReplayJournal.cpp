@@ -0,0 +1,437 @@
+#include "ReplayJournal.h"
+
+#include "../actions/LegalActions.h"
+
+#include <QByteArrayView>
+#include <QtEndian>
+
+namespace model {
+
+namespace {
+
+constexpr char kMagic[4] = {'U', 'D', 'R', 'J'};
+constexpr quint8 kGameBegin = 0x01;
+constexpr quint8 kCheckpoint = 0x02;
+constexpr quint8 kGameEnd = 0x03;
+constexpr quint8 kFirstAction = 0x10;
+constexpr quint8 kLastAction = kFirstAction + 5 * 4 - 1;
+constexpr quint8 kNoCard = 3;
+constexpr quint8 kNoActiveCard = 0xff;
+
+void putVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.append(static_cast<char>(value));
+}
+
+void putString(QByteArray &out, const QString &value)
+{
+    const QByteArray utf8 = value.toUtf8();
+    putVarint(out, static_cast<quint64>(utf8.size()));
+    out.append(utf8);
+}
+
+void putU16(QByteArray &out, quint16 value)
+{
+    char bytes[2];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(bytes));
+}
+
+void putU32(QByteArray &out, quint32 value)
+{
+    char bytes[4];
+    qToLittleEndian(value, bytes);
+    out.append(bytes, sizeof(bytes));
+}
+
+quint8 actionKindCode(const GameAction &action)
+{
+    switch (action.kind) {
+    case ActionKind::Move:
+        return static_cast<quint8>(PackedActionKind::Move);
+    case ActionKind::Attack:
+        return static_cast<quint8>(PackedActionKind::Attack);
+    case ActionKind::Special:
+        break;
+    }
+    switch (action.special) {
+    case AgentSpecialAction::ScoutMark:
+        return static_cast<quint8>(PackedActionKind::Mark);
+    case AgentSpecialAction::SergeantControl:
+        return static_cast<quint8>(PackedActionKind::Control);
+    case AgentSpecialAction::SergeantRelease:
+        return static_cast<quint8>(PackedActionKind::Release);
+    }
+    return static_cast<quint8>(PackedActionKind::Move);
+}
+
+// Bounds-checked cursor over the mapped file. A read past the end sets
+// `truncated` and returns zeros.
+struct Cursor {
+    const uchar *data;
+    qint64 size;
+    qint64 position;
+    bool truncated{false};
+
+    bool take(qint64 bytes)
+    {
+        if (truncated || size - position < bytes) {
+            truncated = true;
+            return false;
+        }
+        position += bytes;
+        return true;
+    }
+
+    quint8 u8()
+    {
+        return take(1) ? data[position - 1] : 0;
+    }
+
+    quint16 u16()
+    {
+        return take(2) ? qFromLittleEndian<quint16>(data + position - 2) : 0;
+    }
+
+    quint32 u32()
+    {
+        return take(4) ? qFromLittleEndian<quint32>(data + position - 4) : 0;
+    }
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            const quint8 byte = u8();
+            value |= quint64(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) {
+                return value;
+            }
+        }
+        truncated = true;
+        return 0;
+    }
+
+    QString string()
+    {
+        const quint64 length = varint();
+        if (length > quint64(size - position)) {
+            truncated = true;
+            return QString();
+        }
+        take(static_cast<qint64>(length));
+        return QString::fromUtf8(reinterpret_cast<const char *>(data + position - length), static_cast<int>(length));
+    }
+};
+
+} // namespace
+
+bool ReplayRecorder::beginGame(quint64 id,
+                               const GameSession &session,
+                               const QString &boardPath,
+                               const QString &scenarioPath,
+                               QString &errorMessage)
+{
+    recording = false;
+    records.clear();
+    actions = 0;
+    checkpointStart = 0;
+
+    const GameState &state = session.state();
+    if (!buildPackedBoard(state.board, board, errorMessage)) {
+        return false;
+    }
+
+    records.append(static_cast<char>(kGameBegin));
+    putVarint(records, id);
+    putVarint(records, session.seed());
+    putString(records, boardPath);
+    putString(records, scenarioPath);
+    records.append(static_cast<char>(state.turn.hasActiveCard ? static_cast<quint8>(state.turn.activeCard.agent)
+                                                               : kNoActiveCard));
+    for (const PlayerState *player : {&state.playerA, &state.playerB}) {
+        putVarint(records, static_cast<quint64>(player->deck.drawPile.size()));
+        for (const Card &card : player->deck.drawPile) {
+            records.append(static_cast<char>(card.agent));
+        }
+    }
+
+    recording = true;
+    return true;
+}
+
+void ReplayRecorder::actionExecuted(const GameState &state, const GameAction &action, const QVector<int> &rolls)
+{
+    if (!recording) {
+        return;
+    }
+
+    const quint8 kind = actionKindCode(action);
+    const quint8 drawn = state.status == GameStatus::InProgress && state.turn.hasActiveCard
+                             ? static_cast<quint8>(state.turn.activeCard.agent)
+                             : kNoCard;
+    records.append(static_cast<char>(kFirstAction + kind * 4 + drawn));
+    if (action.kind != ActionKind::Special) {
+        putVarint(records, static_cast<quint64>(board.indexById.value(action.cellId)));
+    }
+    if (action.kind == ActionKind::Attack) {
+        records.append(static_cast<char>(rolls.size()));
+        for (int roll : rolls) {
+            records.append(static_cast<char>(roll));
+        }
+    }
+
+    ++actions;
+    if (actions % kReplayCheckpointInterval == 0) {
+        writeCheckpoint(kCheckpoint, state);
+    }
+}
+
+QByteArray ReplayRecorder::finishGame(const GameState &state)
+{
+    if (!recording) {
+        return QByteArray();
+    }
+    writeCheckpoint(kGameEnd, state);
+    recording = false;
+
+    QByteArray out;
+    out.swap(records);
+    return out;
+}
+
+bool ReplayRecorder::isRecording() const
+{
+    return recording;
+}
+
+int ReplayRecorder::actionCount() const
+{
+    return actions;
+}
+
+void ReplayRecorder::writeCheckpoint(quint8 opcode, const GameState &state)
+{
+    const quint16 crc = qChecksum(QByteArrayView(records.constData() + checkpointStart, records.size() - checkpointStart));
+
+    PackedState packed;
+    QString error;
+    const quint32 hash = packGameState(state, board, packed, error) ? static_cast<quint32>(hashPackedState(packed)) : 0;
+
+    records.append(static_cast<char>(opcode));
+    if (opcode == kGameEnd) {
+        records.append(static_cast<char>(state.status));
+    }
+    putVarint(records, static_cast<quint64>(actions));
+    putU32(records, hash);
+    putU16(records, crc);
+    checkpointStart = records.size();
+}
+
+bool ReplayJournal::open(const QString &path, QString &errorMessage)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite | QIODevice::Append)) {
+        errorMessage = QStringLiteral("Cannot open journal: %1").arg(path);
+        return false;
+    }
+
+    if (file.size() == 0) {
+        QByteArray header(kMagic, sizeof(kMagic));
+        putVarint(header, kReplayFormatVersion);
+        if (file.write(header) != header.size() || !file.flush()) {
+            errorMessage = QStringLiteral("Cannot write journal header: %1").arg(path);
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    file.seek(0);
+    const QByteArray header = file.read(sizeof(kMagic) + 1);
+    if (header.size() != sizeof(kMagic) + 1 || !header.startsWith(QByteArray(kMagic, sizeof(kMagic))) ||
+        header.at(sizeof(kMagic)) != kReplayFormatVersion) {
+        errorMessage = QStringLiteral("Not a version %1 journal: %2").arg(kReplayFormatVersion).arg(path);
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool ReplayJournal::append(const QByteArray &game, QString &errorMessage)
+{
+    if (!file.isOpen()) {
+        errorMessage = QStringLiteral("Journal is not open.");
+        return false;
+    }
+    // One write per game; flushing hands it to the OS so a crash of this
+    // process loses at most the games still being played.
+    if (file.write(game) != game.size() || !file.flush()) {
+        errorMessage = QStringLiteral("Cannot append to journal: %1").arg(file.fileName());
+        return false;
+    }
+    return true;
+}
+
+void ReplayJournal::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+bool ReplayJournal::isOpen() const
+{
+    return file.isOpen();
+}
+
+bool ReplayJournalReader::open(const QString &path, QString &errorMessage)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        errorMessage = QStringLiteral("Cannot open journal: %1").arg(path);
+        return false;
+    }
+
+    size = file.size();
+    data = size > 0 ? file.map(0, size) : nullptr;
+    if (data == nullptr || size < qint64(sizeof(kMagic)) + 1 || memcmp(data, kMagic, sizeof(kMagic)) != 0 ||
+        data[sizeof(kMagic)] != kReplayFormatVersion) {
+        errorMessage = QStringLiteral("Not a version %1 journal: %2").arg(kReplayFormatVersion).arg(path);
+        close();
+        return false;
+    }
+    position = sizeof(kMagic) + 1;
+    return true;
+}
+
+void ReplayJournalReader::close()
+{
+    if (data != nullptr) {
+        file.unmap(const_cast<uchar *>(data));
+        data = nullptr;
+    }
+    file.close();
+    size = 0;
+    position = 0;
+}
+
+bool ReplayJournalReader::atEnd() const
+{
+    return position >= size;
+}
+
+bool ReplayJournalReader::next(ReplayGame &out, QString &errorMessage)
+{
+    errorMessage.clear();
+    if (atEnd()) {
+        return false;
+    }
+
+    Cursor in{data, size, position};
+    const qint64 gameStart = in.position;
+    const auto fail = [&](const QString &what) {
+        errorMessage = QStringLiteral("%1 at offset %2").arg(in.truncated ? QStringLiteral("Truncated journal") : what)
+                           .arg(in.position);
+        return false;
+    };
+
+    if (in.u8() != kGameBegin) {
+        return fail(QStringLiteral("Expected game record"));
+    }
+
+    ReplayGame game;
+    game.id = in.varint();
+    game.seed = static_cast<quint32>(in.varint());
+    game.boardPath = in.string();
+    game.scenarioPath = in.string();
+    const quint8 activeCard = in.u8();
+    game.hasActiveCard = activeCard != kNoActiveCard;
+    game.activeCard = game.hasActiveCard ? static_cast<AgentType>(activeCard) : AgentType::Scout;
+    if (game.hasActiveCard && activeCard >= kAgentTypeCount) {
+        return fail(QStringLiteral("Invalid card"));
+    }
+    for (QVector<AgentType> &deck : game.decks) {
+        const quint64 count = in.varint();
+        if (count > kMaxDeckCards) {
+            return fail(QStringLiteral("Invalid deck size"));
+        }
+        for (quint64 i = 0; i < count; ++i) {
+            const quint8 card = in.u8();
+            if (card >= kAgentTypeCount) {
+                return fail(QStringLiteral("Invalid card"));
+            }
+            deck.append(static_cast<AgentType>(card));
+        }
+    }
+
+    qint64 intervalStart = gameStart;
+    while (!in.truncated) {
+        const qint64 recordStart = in.position;
+        const quint8 opcode = in.u8();
+
+        if (opcode >= kFirstAction && opcode <= kLastAction) {
+            ReplayAction action;
+            action.kind = static_cast<PackedActionKind>((opcode - kFirstAction) / 4);
+            const int drawn = (opcode - kFirstAction) % 4;
+            action.drawn = drawn == kNoCard ? -1 : static_cast<qint8>(drawn);
+            if (action.kind == PackedActionKind::Move || action.kind == PackedActionKind::Attack) {
+                const quint64 cell = in.varint();
+                if (cell >= quint64(kMaxPackedCells)) {
+                    return fail(QStringLiteral("Invalid cell"));
+                }
+                action.cell = static_cast<quint8>(cell);
+            }
+            if (action.kind == PackedActionKind::Attack) {
+                action.rollCount = in.u8();
+                if (action.rollCount > action.rolls.size()) {
+                    return fail(QStringLiteral("Invalid dice count"));
+                }
+                for (int i = 0; i < action.rollCount; ++i) {
+                    action.rolls[i] = in.u8();
+                }
+            }
+            game.actions.append(action);
+            continue;
+        }
+
+        if (opcode != kCheckpoint && opcode != kGameEnd) {
+            return fail(QStringLiteral("Unknown record 0x%1").arg(opcode, 2, 16, QLatin1Char('0')));
+        }
+
+        const quint8 status = opcode == kGameEnd ? in.u8() : 0;
+        ReplayCheckpoint checkpoint;
+        checkpoint.actions = static_cast<int>(in.varint());
+        checkpoint.stateHash = in.u32();
+        const quint16 crc = in.u16();
+        if (in.truncated) {
+            break;
+        }
+        const quint16 expected = qChecksum(QByteArrayView(reinterpret_cast<const char *>(data + intervalStart),
+                                                          recordStart - intervalStart));
+        if (crc != expected) {
+            return fail(QStringLiteral("Checksum mismatch"));
+        }
+        if (checkpoint.actions != game.actions.size() || status > static_cast<quint8>(GameStatus::WonByB)) {
+            return fail(QStringLiteral("Inconsistent checkpoint"));
+        }
+        game.checkpoints.append(checkpoint);
+        intervalStart = in.position;
+
+        if (opcode == kGameEnd) {
+            game.finalStatus = static_cast<GameStatus>(status);
+            position = in.position;
+            out = std::move(game);
+            return true;
+        }
+    }
+    return fail(QString());
+}
+
+} // namespace model
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../model/PackedState.h"
+#include "../rules/PackedRules.h"
+#include "../session/GameSession.h"
+
+#include <QFile>
+
+#include <array>
+
+namespace model {
+
+// Append-only game journal. A file starts with "UDRJ" and a varint format
+// version, followed by complete games, each written in one append:
+//
+//   GameBegin   0x01  varint id, varint seed, str board, str scenario,
+//                     u8 active card (0xff none), 2 x (varint n, n x u8 card)
+//   action      0x10 + kind * 4 + drawn, kind 0 move .. 4 release, drawn the
+//                     card type drawn afterwards (3 = none, game over);
+//                     move/attack add varint cell, attack adds u8 n, n x u8 roll
+//   Checkpoint  0x02  varint actions so far, u32 state hash, u16 CRC
+//   GameEnd     0x03  u8 status, then the Checkpoint fields
+//
+// Strings are varint length plus UTF-8, cells are indexes into the board's
+// cell list. The state hash is the low half of hashPackedState() after the
+// last action; the CRC (qChecksum) covers the bytes since the previous
+// checkpoint, so damage is caught within one interval.
+constexpr int kReplayFormatVersion = 1;
+constexpr int kReplayCheckpointInterval = 64;
+
+struct ReplayAction {
+    PackedActionKind kind{PackedActionKind::Move};
+    quint8 cell{0};
+    quint8 rollCount{0};
+    std::array<quint8, 3> rolls{};
+    // Card type drawn for the next turn, or -1 once the game is over.
+    qint8 drawn{-1};
+};
+
+struct ReplayCheckpoint {
+    int actions{0};
+    quint32 stateHash{0};
+};
+
+struct ReplayGame {
+    quint64 id{0};
+    quint32 seed{0};
+    QString boardPath;
+    QString scenarioPath;
+    bool hasActiveCard{false};
+    AgentType activeCard{AgentType::Scout};
+    std::array<QVector<AgentType>, 2> decks;
+    QVector<ReplayAction> actions;
+    QVector<ReplayCheckpoint> checkpoints;
+    GameStatus finalStatus{GameStatus::InProgress};
+};
+
+// Collects one game's records in memory while it is played; attach it to the
+// session with GameSession::setRecorder(). The journal only ever sees whole
+// games, so games played concurrently never interleave.
+class ReplayRecorder : public ActionRecorder
+{
+public:
+    // Call right after initializeNewBattle().
+    bool beginGame(quint64 id, const GameSession &session, const QString &boardPath, const QString &scenarioPath,
+                   QString &errorMessage);
+    void actionExecuted(const GameState &state, const GameAction &action, const QVector<int> &rolls) override;
+    // Closes the game (finished or not) and returns its encoded records.
+    QByteArray finishGame(const GameState &state);
+
+    bool isRecording() const;
+    int actionCount() const;
+
+private:
+    void writeCheckpoint(quint8 opcode, const GameState &state);
+
+    QByteArray records;
+    PackedBoard board;
+    int checkpointStart{0};
+    int actions{0};
+    bool recording{false};
+};
+
+class ReplayJournal
+{
+public:
+    // Creates the file or checks the header of an existing one.
+    bool open(const QString &path, QString &errorMessage);
+    bool append(const QByteArray &game, QString &errorMessage);
+    void close();
+    bool isOpen() const;
+
+private:
+    QFile file;
+};
+
+// Reads a journal through a memory map.
+class ReplayJournalReader
+{
+public:
+    bool open(const QString &path, QString &errorMessage);
+    void close();
+
+    // False at the end of the file (errorMessage empty) or on a damaged
+    // record (errorMessage set).
+    bool next(ReplayGame &out, QString &errorMessage);
+    bool atEnd() const;
+
+private:
+    QFile file;
+    const uchar *data = nullptr;
+    qint64 size{0};
+    qint64 position{0};
+};
+
+} // namespace model
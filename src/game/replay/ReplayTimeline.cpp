@@ -0,0 +1,95 @@
+#include "ReplayTimeline.h"
+
+#include "Replayer.h"
+
+#include <algorithm>
+#include <cstring>
+#include <type_traits>
+
+namespace model {
+
+namespace {
+
+static_assert(std::is_trivially_copyable<PackedState>::value, "timeline deltas copy PackedState bytes");
+static_assert(sizeof(PackedState) <= 256, "delta offsets are one byte");
+
+void appendDelta(const PackedState &from, const PackedState &to, QVector<quint8> &out)
+{
+    const auto *a = reinterpret_cast<const quint8 *>(&from);
+    const auto *b = reinterpret_cast<const quint8 *>(&to);
+    for (int i = 0; i < int(sizeof(PackedState)); ++i) {
+        if (a[i] != b[i]) {
+            out.append(static_cast<quint8>(i));
+            out.append(b[i]);
+        }
+    }
+}
+
+} // namespace
+
+bool ReplayTimeline::build(const PackedBoard &board,
+                           const PackedState &start,
+                           const ReplayGame &game,
+                           QString &errorMessage,
+                           int keyframeInterval)
+{
+    clear();
+    interval = std::max(keyframeInterval, 1);
+    keyframes.reserve(game.actions.size() / interval + 1);
+    deltaStart.reserve(game.actions.size() + 1);
+    deltaStart.append(0);
+
+    PackedState state = start;
+    keyframes.append(state);
+    for (int i = 0; i < game.actions.size(); ++i) {
+        const PackedState previous = state;
+        if (!applyReplayAction(board, state, game.actions[i], errorMessage)) {
+            errorMessage = QStringLiteral("Action %1: %2").arg(i + 1).arg(errorMessage);
+            clear();
+            return false;
+        }
+        appendDelta(previous, state, deltaBytes);
+        deltaStart.append(deltaBytes.size());
+        if ((i + 1) % interval == 0) {
+            keyframes.append(state);
+        }
+    }
+    return true;
+}
+
+void ReplayTimeline::clear()
+{
+    keyframes.clear();
+    deltaStart.clear();
+    deltaBytes.clear();
+}
+
+int ReplayTimeline::length() const
+{
+    return deltaStart.isEmpty() ? 0 : int(deltaStart.size()) - 1;
+}
+
+PackedState ReplayTimeline::seek(int position) const
+{
+    if (keyframes.isEmpty()) {
+        return PackedState{};
+    }
+    position = std::clamp(position, 0, length());
+
+    const int keyframe = position / interval;
+    PackedState state = keyframes[keyframe];
+    auto *bytes = reinterpret_cast<quint8 *>(&state);
+    const int end = deltaStart[position];
+    for (int i = deltaStart[keyframe * interval]; i < end; i += 2) {
+        bytes[deltaBytes[i]] = deltaBytes[i + 1];
+    }
+    return state;
+}
+
+qint64 ReplayTimeline::memoryBytes() const
+{
+    return qint64(keyframes.size()) * qint64(sizeof(PackedState)) + qint64(deltaStart.size()) * qint64(sizeof(int)) +
+           deltaBytes.size();
+}
+
+} // namespace model
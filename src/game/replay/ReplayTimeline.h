@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ReplayJournal.h"
+
+#include <QVector>
+
+namespace model {
+
+constexpr int kReplayKeyframeInterval = 32;
+
+// Random access to every position of a recorded game. A full PackedState is
+// kept every `interval` actions and a byte delta (offset, value pairs) for
+// each action in between, so seek() restores one keyframe and applies at
+// most interval - 1 deltas instead of replaying the game from the start.
+class ReplayTimeline
+{
+public:
+    // Replays the whole game once from `start` (see packReplayStart()).
+    bool build(const PackedBoard &board,
+               const PackedState &start,
+               const ReplayGame &game,
+               QString &errorMessage,
+               int keyframeInterval = kReplayKeyframeInterval);
+    void clear();
+
+    // Number of recorded actions; positions run from 0 (start) to length().
+    int length() const;
+    // State after `position` actions, clamped to [0, length()].
+    PackedState seek(int position) const;
+    qint64 memoryBytes() const;
+
+private:
+    int interval{kReplayKeyframeInterval};
+    QVector<PackedState> keyframes;
+    // Delta i (position i from i - 1) is deltaBytes[deltaStart[i - 1], deltaStart[i]).
+    QVector<int> deltaStart;
+    QVector<quint8> deltaBytes;
+};
+
+} // namespace model
@@ -0,0 +1,241 @@
+#include "Replayer.h"
+
+#include "../model/Init.h"
+#include "../session/ActionCommand.h"
+
+namespace model {
+
+namespace {
+
+AgentSpecialAction specialFor(PackedActionKind kind)
+{
+    switch (kind) {
+    case PackedActionKind::Control:
+        return AgentSpecialAction::SergeantControl;
+    case PackedActionKind::Release:
+        return AgentSpecialAction::SergeantRelease;
+    default:
+        return AgentSpecialAction::ScoutMark;
+    }
+}
+
+int replayLength(const ReplayGame &game, int actionCount)
+{
+    return actionCount < 0 || actionCount > game.actions.size() ? game.actions.size() : actionCount;
+}
+
+} // namespace
+
+void applyReplayDecks(GameState &state, const ReplayGame &game)
+{
+    PlayerState *players[2] = {&state.playerA, &state.playerB};
+    for (int side = 0; side < 2; ++side) {
+        QVector<Card> &pile = players[side]->deck.drawPile;
+        pile.clear();
+        for (AgentType type : game.decks[side]) {
+            pile.append(Card{type});
+        }
+    }
+    state.turn.hasActiveCard = game.hasActiveCard;
+    state.turn.activeCard = Card{game.activeCard};
+}
+
+bool loadReplayStart(GameSession &session, const ReplayGame &game, QString &errorMessage)
+{
+    session.setSeed(game.seed);
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), game.boardPath, game.scenarioPath, true,
+                                     errorMessage)) {
+        return false;
+    }
+    applyReplayDecks(session.state(), game);
+    return true;
+}
+
+bool replayIntoSession(GameSession &session, const ReplayGame &game, int actionCount, QString &errorMessage)
+{
+    const GameState &state = session.state();
+    const int count = replayLength(game, actionCount);
+    for (int i = 0; i < count; ++i) {
+        const ReplayAction &action = game.actions[i];
+        if ((action.kind == PackedActionKind::Move || action.kind == PackedActionKind::Attack) &&
+            action.cell >= state.board.cells.size()) {
+            errorMessage = QStringLiteral("Action %1: cell %2 is not on the board.").arg(i + 1).arg(action.cell);
+            return false;
+        }
+
+        CommandResult result;
+        switch (action.kind) {
+        case PackedActionKind::Move:
+            result = session.execute(MoveCommand(state.board.cells[action.cell]->id));
+            break;
+        case PackedActionKind::Attack: {
+            QVector<int> rolls;
+            for (int r = 0; r < action.rollCount; ++r) {
+                rolls.append(action.rolls[r]);
+            }
+            result = session.execute(AttackCommand(state.board.cells[action.cell]->id, rolls));
+            break;
+        }
+        default:
+            result = session.execute(UseAgentSpecialCommand(specialFor(action.kind)));
+            break;
+        }
+        if (!result.ok) {
+            errorMessage = QStringLiteral("Action %1: %2").arg(i + 1).arg(result.message);
+            return false;
+        }
+
+        const int drawn = state.status == GameStatus::InProgress && state.turn.hasActiveCard
+                              ? static_cast<int>(state.turn.activeCard.agent)
+                              : -1;
+        if (drawn != action.drawn) {
+            errorMessage = QStringLiteral("Action %1: drew card %2, the journal says %3.").arg(i + 1).arg(drawn).arg(action.drawn);
+            return false;
+        }
+    }
+    return true;
+}
+
+bool packReplayStart(const ReplayGame &game, PackedBoard &board, PackedState &state, QString &errorMessage)
+{
+    GameState start;
+    GameSession session(start);
+    if (!loadReplayStart(session, game, errorMessage)) {
+        return false;
+    }
+    return buildPackedBoard(start.board, board, errorMessage) && packGameState(start, board, state, errorMessage);
+}
+
+QString replayActionText(const PackedBoard &board, const ReplayAction &action)
+{
+    switch (action.kind) {
+    case PackedActionKind::Move:
+        return QStringLiteral("move %1").arg(board.cellIds.value(action.cell));
+    case PackedActionKind::Attack: {
+        QString text = QStringLiteral("attack %1  rolls").arg(board.cellIds.value(action.cell));
+        for (int r = 0; r < action.rollCount; ++r) {
+            text += QLatin1Char(' ') + QString::number(action.rolls[r]);
+        }
+        return text;
+    }
+    case PackedActionKind::Mark:
+        return QStringLiteral("mark");
+    case PackedActionKind::Control:
+        return QStringLiteral("control");
+    case PackedActionKind::Release:
+        return QStringLiteral("release");
+    }
+    return QString();
+}
+
+bool packReplayAction(const PackedBoard &board,
+                      const PackedState &state,
+                      const ReplayAction &recorded,
+                      PackedReplayStep &out,
+                      QString &errorMessage)
+{
+    out = PackedReplayStep{};
+    out.action.kind = recorded.kind;
+    switch (recorded.kind) {
+    case PackedActionKind::Move:
+        out.action.cell = static_cast<qint8>(recorded.cell);
+        return true;
+    case PackedActionKind::Attack: {
+        const PackedSide &enemy = state.sides[state.currentSide ^ 1];
+        out.action.cell = static_cast<qint8>(recorded.cell);
+        int target = 0;
+        while (target < kAgentTypeCount && enemy.agentCell[target] != out.action.cell) {
+            ++target;
+        }
+        if (target == kAgentTypeCount) {
+            errorMessage = QStringLiteral("No enemy agent at cell %1.").arg(recorded.cell);
+            return false;
+        }
+        out.action.target = static_cast<quint8>(target);
+        out.threshold = packedAttackThreshold(board, state, out.action);
+        for (int r = 0; r < recorded.rollCount; ++r) {
+            out.hit = out.hit || recorded.rolls[r] >= out.threshold;
+        }
+        return true;
+    }
+    default:
+        out.action.cell = state.sides[state.currentSide].agentCell[state.activeCard];
+        return true;
+    }
+}
+
+bool applyReplayAction(const PackedBoard &board, PackedState &state, const ReplayAction &recorded, QString &errorMessage)
+{
+    if (state.status != GameStatus::InProgress || !state.hasActiveCard) {
+        errorMessage = QStringLiteral("The game is already over.");
+        return false;
+    }
+
+    PackedReplayStep step;
+    if (!packReplayAction(board, state, recorded, step, errorMessage)) {
+        return false;
+    }
+    applyPackedAction(board, state, step.action, step.hit);
+    if (state.status == GameStatus::InProgress) {
+        endPackedTurn(state);
+        drawPackedCard(state);
+    }
+
+    const int drawn = state.status == GameStatus::InProgress && state.hasActiveCard ? state.activeCard : -1;
+    if (drawn != recorded.drawn) {
+        errorMessage = QStringLiteral("Drew card %1, the journal says %2.").arg(drawn).arg(recorded.drawn);
+        return false;
+    }
+    return true;
+}
+
+bool replayPacked(const PackedBoard &board,
+                  const ReplayGame &game,
+                  PackedState &state,
+                  int actionCount,
+                  QString &errorMessage)
+{
+    const int count = replayLength(game, actionCount);
+    int nextCheckpoint = 0;
+    for (int i = 0; i < count; ++i) {
+        if (!applyReplayAction(board, state, game.actions[i], errorMessage)) {
+            errorMessage = QStringLiteral("Action %1: %2").arg(i + 1).arg(errorMessage);
+            return false;
+        }
+
+        while (nextCheckpoint < game.checkpoints.size() && game.checkpoints[nextCheckpoint].actions < i + 1) {
+            ++nextCheckpoint;
+        }
+        if (nextCheckpoint < game.checkpoints.size() && game.checkpoints[nextCheckpoint].actions == i + 1 &&
+            static_cast<quint32>(hashPackedState(state)) != game.checkpoints[nextCheckpoint].stateHash) {
+            errorMessage = QStringLiteral("Action %1: state differs from the journal checkpoint.").arg(i + 1);
+            return false;
+        }
+    }
+    return true;
+}
+
+const PackedBoard *ReplayStartCache::start(const ReplayGame &game, PackedState &state, QString &errorMessage)
+{
+    const QString key = game.boardPath + QLatin1Char('\n') + game.scenarioPath;
+    auto found = maps.find(key);
+    if (found == maps.end()) {
+        Map loaded;
+        GameSession session(loaded.state);
+        if (!loadReplayStart(session, game, errorMessage) ||
+            !buildPackedBoard(loaded.state.board, loaded.board, errorMessage)) {
+            return nullptr;
+        }
+        found = maps.emplace(key, std::make_unique<Map>(std::move(loaded))).first;
+    }
+
+    // Only the deck order and first card differ between games on one map.
+    GameState initial = cloneGameState(found->second->state);
+    applyReplayDecks(initial, game);
+    if (!packGameState(initial, found->second->board, state, errorMessage)) {
+        return nullptr;
+    }
+    return &found->second->board;
+}
+
+} // namespace model
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ReplayJournal.h"
+
+#include <map>
+#include <memory>
+
+namespace model {
+
+// Puts the recorded draw piles and first card into a freshly loaded state.
+void applyReplayDecks(GameState &state, const ReplayGame &game);
+
+// Starts the recorded battle in `session`: loads the board and scenario and
+// puts the recorded draw piles and first card in place of the shuffle.
+bool loadReplayStart(GameSession &session, const ReplayGame &game, QString &errorMessage);
+
+// Runs the first actionCount recorded actions (all with -1) through the
+// session's commands, after loadReplayStart(). Every drawn card is compared
+// against the record.
+bool replayIntoSession(GameSession &session, const ReplayGame &game, int actionCount, QString &errorMessage);
+
+// Packed counterparts for headless replays. The board only depends on the
+// board file, so callers replaying many games can reuse it.
+bool packReplayStart(const ReplayGame &game, PackedBoard &board, PackedState &state, QString &errorMessage);
+
+// Engine protocol action text ("attack B08"), plus the dice for attacks.
+QString replayActionText(const PackedBoard &board, const ReplayAction &action);
+
+struct PackedReplayStep {
+    PackedAction action;
+    // Attack threshold (0 for other actions) and whether any die reached it.
+    int threshold{0};
+    bool hit{false};
+};
+
+// The packed action a recorded action stands for in `state`.
+bool packReplayAction(const PackedBoard &board,
+                      const PackedState &state,
+                      const ReplayAction &recorded,
+                      PackedReplayStep &out,
+                      QString &errorMessage);
+
+// Plays one recorded action on a packed state and checks the drawn card.
+bool applyReplayAction(const PackedBoard &board, PackedState &state, const ReplayAction &action, QString &errorMessage);
+
+// Applies the recorded actions to `state` (from packReplayStart()), checking
+// each drawn card and every checkpoint hash on the way.
+bool replayPacked(const PackedBoard &board,
+                  const ReplayGame &game,
+                  PackedState &state,
+                  int actionCount,
+                  QString &errorMessage);
+
+// Start positions for many games: each board/scenario pair is loaded once and
+// only the recorded decks are applied per game.
+class ReplayStartCache
+{
+public:
+    // The packed board of the game's map (owned by the cache), or nullptr.
+    const PackedBoard *start(const ReplayGame &game, PackedState &state, QString &errorMessage);
+
+private:
+    struct Map {
+        GameState state;
+        PackedBoard board;
+    };
+    std::map<QString, std::unique_ptr<Map>> maps;
+};
+
+} // namespace model
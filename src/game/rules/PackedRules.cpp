@@ -0,0 +1,235 @@
+#include "PackedRules.h"
+
+#include "Victory.h"
+
+#include <algorithm>
+
+namespace model {
+
+namespace {
+
+bool hasAgentAt(const PackedSide &side, int cell)
+{
+    return std::find(side.agentCell.begin(), side.agentCell.end(), cell) != side.agentCell.end();
+}
+
+void removeDeckCard(PackedSide &side, int index)
+{
+    const quint8 type = side.deck[index];
+    for (int i = index + 1; i < side.deckSize; ++i) {
+        side.deck[i - 1] = side.deck[i];
+    }
+    --side.deckSize;
+    --side.cardCount[type];
+}
+
+} // namespace
+
+int packedLegalActions(const PackedBoard &board, const PackedState &state, PackedAction *out)
+{
+    if (state.status != GameStatus::InProgress || !state.hasActiveCard) {
+        return 0;
+    }
+
+    const int side = state.currentSide;
+    const PackedSide &own = state.sides[side];
+    const PackedSide &enemy = state.sides[side ^ 1];
+    const int type = state.activeCard;
+    const qint8 cell = own.agentCell[type];
+    if (cell == kNoCell) {
+        return 0;
+    }
+
+    int count = 0;
+
+    CellMask destinations = board.neighbors[cell] & ~packedOccupiedCells(state);
+    if (type != static_cast<int>(AgentType::Scout)) {
+        destinations = destinations & own.marks;
+    }
+    for (int word = 0; word < 2; ++word) {
+        quint64 bits = destinations.words[word];
+        while (bits != 0) {
+            const int bit = qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            out[count++] = PackedAction{PackedActionKind::Move, static_cast<qint8>(word * 64 + bit), 0};
+        }
+    }
+
+    for (int target = 0; target < kAgentTypeCount; ++target) {
+        const qint8 targetCell = enemy.agentCell[target];
+        if (targetCell == kNoCell || !board.reachable[cell].test(targetCell) || enemy.cardCount[target] == 0) {
+            continue;
+        }
+        out[count++] = PackedAction{PackedActionKind::Attack, targetCell, static_cast<quint8>(target)};
+    }
+
+    if (type == static_cast<int>(AgentType::Scout)) {
+        if (!own.marks.test(cell)) {
+            out[count++] = PackedAction{PackedActionKind::Mark, cell, 0};
+        }
+    } else if (type == static_cast<int>(AgentType::Sergeant) && !hasAgentAt(enemy, cell)) {
+        if (enemy.control.test(cell)) {
+            out[count++] = PackedAction{PackedActionKind::Release, cell, 0};
+        } else {
+            out[count++] = PackedAction{PackedActionKind::Control, cell, 0};
+        }
+    }
+
+    return count;
+}
+
+CellMask packedOccupiedCells(const PackedState &state)
+{
+    CellMask occupied;
+    for (const PackedSide &side : state.sides) {
+        for (qint8 cell : side.agentCell) {
+            if (cell != kNoCell) {
+                occupied.set(cell);
+            }
+        }
+    }
+    return occupied;
+}
+
+int packedAttackDice(int attackerType)
+{
+    // Mirrors AgentBehavior::attackDiceCount().
+    constexpr int kDiceCount[kAgentTypeCount] = {1, 3, 1};
+    return kDiceCount[std::clamp(attackerType, 0, kAgentTypeCount - 1)];
+}
+
+int packedAttackThreshold(const PackedBoard &board, const PackedState &state, const PackedAction &action)
+{
+    const PackedSide &own = state.sides[state.currentSide];
+    const PackedSide &enemy = state.sides[state.currentSide ^ 1];
+    const qint8 from = own.agentCell[state.activeCard];
+    return std::clamp(board.pathShield[from][action.cell] + enemy.hp[action.target], 1, 10);
+}
+
+void applyPackedAction(const PackedBoard &board, PackedState &state, const PackedAction &action, bool hit)
+{
+    Q_UNUSED(board);
+
+    const int side = state.currentSide;
+    PackedSide &own = state.sides[side];
+    PackedSide &enemy = state.sides[side ^ 1];
+
+    switch (action.kind) {
+    case PackedActionKind::Move:
+        own.agentCell[state.activeCard] = action.cell;
+        break;
+    case PackedActionKind::Mark:
+        own.marks.set(action.cell);
+        break;
+    case PackedActionKind::Control:
+        own.control.set(action.cell);
+        break;
+    case PackedActionKind::Release:
+        enemy.control.reset(action.cell);
+        break;
+    case PackedActionKind::Attack:
+        if (!hit) {
+            break;
+        }
+        for (int i = 0; i < enemy.deckSize; ++i) {
+            if (enemy.deck[i] == action.target) {
+                removeDeckCard(enemy, i);
+                break;
+            }
+        }
+        if (enemy.cardCount[action.target] == 0) {
+            enemy.agentCell[action.target] = kNoCell;
+            enemy.hp[action.target] = 0;
+            enemy.aliveMask &= quint8(~(1u << action.target));
+        }
+        break;
+    }
+
+    state.status = packedGameStatus(state);
+}
+
+void endPackedTurn(PackedState &state)
+{
+    if (state.hasActiveCard) {
+        PackedSide &own = state.sides[state.currentSide];
+        own.deck[own.deckSize++] = state.activeCard;
+        ++own.cardCount[state.activeCard];
+        state.hasActiveCard = false;
+    }
+    state.currentSide ^= 1;
+    ++state.turnIndex;
+}
+
+bool drawPackedCard(PackedState &state, int type)
+{
+    PackedSide &side = state.sides[state.currentSide];
+    int index = 0;
+    if (type >= 0) {
+        while (index < side.deckSize && side.deck[index] != type) {
+            ++index;
+        }
+    }
+    if (index >= side.deckSize) {
+        return false;
+    }
+
+    state.activeCard = side.deck[index];
+    state.hasActiveCard = true;
+    removeDeckCard(side, index);
+    return true;
+}
+
+GameStatus packedGameStatus(const PackedState &state)
+{
+    if (state.sides[0].control.count() >= kControlCellsToWin) {
+        return GameStatus::WonByA;
+    }
+    if (state.sides[1].control.count() >= kControlCellsToWin) {
+        return GameStatus::WonByB;
+    }
+
+    const bool aliveA = state.sides[0].aliveMask != 0;
+    const bool aliveB = state.sides[1].aliveMask != 0;
+    if (aliveA && !aliveB) {
+        return GameStatus::WonByA;
+    }
+    if (aliveB && !aliveA) {
+        return GameStatus::WonByB;
+    }
+    return GameStatus::InProgress;
+}
+
+GameAction toGameAction(const PackedBoard &board, const PackedAction &action)
+{
+    switch (action.kind) {
+    case PackedActionKind::Move:
+        return GameAction{ActionKind::Move, board.cellIds.value(action.cell), AgentSpecialAction::ScoutMark};
+    case PackedActionKind::Attack:
+        return GameAction{ActionKind::Attack, board.cellIds.value(action.cell), AgentSpecialAction::ScoutMark};
+    case PackedActionKind::Mark:
+        return GameAction{ActionKind::Special, QString(), AgentSpecialAction::ScoutMark};
+    case PackedActionKind::Control:
+        return GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantControl};
+    case PackedActionKind::Release:
+        return GameAction{ActionKind::Special, QString(), AgentSpecialAction::SergeantRelease};
+    }
+    return GameAction{};
+}
+
+bool fromGameAction(const PackedBoard &board,
+                    const PackedState &state,
+                    const GameAction &action,
+                    PackedAction &out)
+{
+    PackedAction actions[kMaxPackedActions];
+    const int count = packedLegalActions(board, state, actions);
+    for (int i = 0; i < count; ++i) {
+        if (toGameAction(board, actions[i]) == action) {
+            out = actions[i];
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace model
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../actions/LegalActions.h"
+#include "../model/PackedState.h"
+
+namespace model {
+
+enum class PackedActionKind : quint8 {
+    Move,
+    Attack,
+    Mark,
+    Control,
+    Release
+};
+
+// cell is the move destination, attack target or the acting agent's cell for
+// specials; target is the enemy AgentType for attacks.
+struct PackedAction {
+    PackedActionKind kind{PackedActionKind::Move};
+    qint8 cell{kNoCell};
+    quint8 target{0};
+
+    bool operator==(const PackedAction &other) const
+    {
+        return kind == other.kind && cell == other.cell && target == other.target;
+    }
+};
+
+// Six neighbours, three attack targets and one special.
+constexpr int kMaxPackedActions = 10;
+
+// Packed counterpart of legalActions(): same action set, moves in cell-index
+// order rather than neighbour order.
+int packedLegalActions(const PackedBoard &board, const PackedState &state, PackedAction *out);
+
+// Cells holding an agent of either side.
+CellMask packedOccupiedCells(const PackedState &state);
+// Attack dice of an AgentType (clamped to a valid type).
+int packedAttackDice(int attackerType);
+int packedAttackThreshold(const PackedBoard &board, const PackedState &state, const PackedAction &action);
+
+// Applies the action for the side to move and refreshes status. hit is only
+// read for attacks. The turn is not passed; call endPackedTurn() after.
+void applyPackedAction(const PackedBoard &board, PackedState &state, const PackedAction &action, bool hit);
+
+// endTurn(): active card to the bottom of the deck, opponent to move.
+void endPackedTurn(PackedState &state);
+
+// drawTurnCard(). With type < 0 the top card is drawn; otherwise the first
+// card of that type is moved to the top first (for chance branching).
+bool drawPackedCard(PackedState &state, int type = -1);
+
+GameStatus packedGameStatus(const PackedState &state);
+
+GameAction toGameAction(const PackedBoard &board, const PackedAction &action);
+bool fromGameAction(const PackedBoard &board,
+                    const PackedState &state,
+                    const GameAction &action,
+                    PackedAction &out);
+
+} // namespace model
@@ -39,10 +39,10 @@ GameStatus evaluateGameStatus(const GameState &state)
 {
     const int controlA = controlledCellCount(state, PlayerId::A);
     const int controlB = controlledCellCount(state, PlayerId::B);
-    if (controlA >= 7) {
+    if (controlA >= kControlCellsToWin) {
         return GameStatus::WonByA;
     }
-    if (controlB >= 7) {
+    if (controlB >= kControlCellsToWin) {
         return GameStatus::WonByB;
     }
 
@@ -4,6 +4,8 @@
 
 namespace model {
 
+constexpr int kControlCellsToWin = 7;
+
 int controlledCellCount(const GameState &state, PlayerId owner);
 int aliveAgentCount(const GameState &state, PlayerId owner);
 
@@ -18,9 +18,9 @@ CommandResult failure(const QString &message)
     return CommandResult{false, message};
 }
 
-CommandResult success(const QString &message)
+CommandResult success(const QString &message, const QStringList &changedCells)
 {
-    return CommandResult{true, message};
+    return CommandResult{true, message, changedCells};
 }
 
 bool resolveCurrentAgent(const GameSession &session, AgentType &typeOut, QString &errorMessage)
@@ -28,6 +28,13 @@ bool resolveCurrentAgent(const GameSession &session, AgentType &typeOut, QString
     return session.activeCardAgent(typeOut, errorMessage);
 }
 
+QString agentCellId(const GameSession &session, AgentType type)
+{
+    const PlayerState *player = playerById(session.state(), session.state().turn.currentPlayer);
+    const AgentState *agent = player != nullptr ? findAgent(*player, type) : nullptr;
+    return agent != nullptr ? agent->cellId : QString();
+}
+
 QString winnerText(const GameState &state)
 {
     if (state.status == GameStatus::WonByA) {
@@ -53,7 +60,18 @@ QString specialActionSuccessMessage(AgentSpecialAction action)
     return QStringLiteral("Special action executed.");
 }
 
-CommandResult completeTurnAfterAction(GameSession &session, const QString &actionMessage)
+void recordAction(GameSession &session, const GameAction &action, const QVector<int> &rolls)
+{
+    if (ActionRecorder *recorder = session.recorder()) {
+        recorder->actionExecuted(session.state(), action, rolls);
+    }
+}
+
+CommandResult completeTurnAfterAction(GameSession &session,
+                                      const GameAction &action,
+                                      const QVector<int> &rolls,
+                                      const QString &actionMessage,
+                                      const QStringList &changedCells)
 {
     QString message = actionMessage;
 
@@ -62,7 +80,8 @@ CommandResult completeTurnAfterAction(GameSession &session, const QString &actio
         if (!winner.isEmpty()) {
             message += QStringLiteral(" | %1").arg(winner);
         }
-        return success(message);
+        recordAction(session, action, rolls);
+        return success(message, changedCells);
     }
 
     QString error;
@@ -77,7 +96,8 @@ CommandResult completeTurnAfterAction(GameSession &session, const QString &actio
 
     message += QStringLiteral(" | Turn passed to %1.")
                    .arg(playerIdName(session.state().turn.currentPlayer));
-    return success(message);
+    recordAction(session, action, rolls);
+    return success(message, changedCells);
 }
 
 } // namespace
@@ -99,6 +119,7 @@ CommandResult MoveCommand::execute(GameSession &session) const
         return failure(error);
     }
 
+    const QString fromCellId = agentCellId(session, type);
     if (!moveAgent(session.state(),
                    session.state().turn.currentPlayer,
                    type,
@@ -109,11 +130,15 @@ CommandResult MoveCommand::execute(GameSession &session) const
 
     return completeTurnAfterAction(
         session,
-        QStringLiteral("%1 moved to %2.").arg(agentTypeName(type), targetCellId_));
+        GameAction{ActionKind::Move, targetCellId_, AgentSpecialAction::ScoutMark},
+        QVector<int>(),
+        QStringLiteral("%1 moved to %2.").arg(agentTypeName(type), targetCellId_),
+        QStringList{fromCellId, targetCellId_});
 }
 
-AttackCommand::AttackCommand(QString targetCellId)
-    : targetCellId_(std::move(targetCellId))
+AttackCommand::AttackCommand(QString targetCellId, QVector<int> rolls)
+    : targetCellId_(std::move(targetCellId)),
+      rolls_(std::move(rolls))
 {
 }
 
@@ -129,10 +154,17 @@ CommandResult AttackCommand::execute(GameSession &session) const
         return failure(error);
     }
 
-    const AttackResult result = attack(session.state(),
-                                       session.state().turn.currentPlayer,
-                                       type,
-                                       targetCellId_);
+    const AttackResult result = rolls_.isEmpty()
+                                    ? attack(session.state(),
+                                             session.state().turn.currentPlayer,
+                                             type,
+                                             targetCellId_,
+                                             session.rng())
+                                    : attackWithRolls(session.state(),
+                                                      session.state().turn.currentPlayer,
+                                                      type,
+                                                      targetCellId_,
+                                                      rolls_);
     if (!result.executed) {
         return failure(result.errorMessage);
     }
@@ -158,7 +190,11 @@ CommandResult AttackCommand::execute(GameSession &session) const
         message += QStringLiteral(" | Miss");
     }
 
-    return completeTurnAfterAction(session, message);
+    return completeTurnAfterAction(session,
+                                   GameAction{ActionKind::Attack, targetCellId_, AgentSpecialAction::ScoutMark},
+                                   result.rolls,
+                                   message,
+                                   QStringList{targetCellId_});
 }
 
 UseAgentSpecialCommand::UseAgentSpecialCommand(AgentSpecialAction action)
@@ -188,6 +224,8 @@ CommandResult UseAgentSpecialCommand::execute(GameSession &session) const
                            .arg(agentTypeName(type), specialActionName(action_)));
     }
 
+    // Specials act on the agent's own cell.
+    const QString cellId = agentCellId(session, type);
     if (!behavior->executeSpecial(session.state(),
                                   session.state().turn.currentPlayer,
                                   action_,
@@ -195,7 +233,24 @@ CommandResult UseAgentSpecialCommand::execute(GameSession &session) const
         return failure(error);
     }
 
-    return completeTurnAfterAction(session, specialActionSuccessMessage(action_));
+    return completeTurnAfterAction(session,
+                                   GameAction{ActionKind::Special, QString(), action_},
+                                   QVector<int>(),
+                                   specialActionSuccessMessage(action_),
+                                   QStringList{cellId});
+}
+
+CommandResult executeAction(GameSession &session, const GameAction &action)
+{
+    switch (action.kind) {
+    case ActionKind::Move:
+        return session.execute(MoveCommand(action.cellId));
+    case ActionKind::Attack:
+        return session.execute(AttackCommand(action.cellId));
+    case ActionKind::Special:
+        return session.execute(UseAgentSpecialCommand(action.special));
+    }
+    return failure(QStringLiteral("Unknown action."));
 }
 
 } // namespace model
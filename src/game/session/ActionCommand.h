@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SessionTypes.h"
+#include "../actions/LegalActions.h"
 #include "../agents/AgentBehavior.h"
 
 #include <QString>
@@ -29,11 +30,14 @@ private:
 class AttackCommand final : public ActionCommand
 {
 public:
-    explicit AttackCommand(QString targetCellId);
+    // With rolls (one per attack die) the dice are not rolled; replays use
+    // this to reproduce a recorded attack.
+    explicit AttackCommand(QString targetCellId, QVector<int> rolls = QVector<int>());
     CommandResult execute(GameSession &session) const override;
 
 private:
     QString targetCellId_;
+    QVector<int> rolls_;
 };
 
 class UseAgentSpecialCommand final : public ActionCommand
@@ -46,4 +50,7 @@ private:
     AgentSpecialAction action_;
 };
 
+// Runs the command matching `action` through the session.
+CommandResult executeAction(GameSession &session, const GameAction &action);
+
 } // namespace model
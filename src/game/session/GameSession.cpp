@@ -11,7 +11,9 @@
 namespace model {
 
 GameSession::GameSession(GameState &state)
-    : state_(state)
+    : state_(state),
+      seed_(QRandomGenerator::global()->generate()),
+      rng_(seed_)
 {
 }
 
@@ -22,7 +24,7 @@ bool GameSession::initializeNewBattle(const QString &playerAName,
                                       bool useScenario,
                                       QString &errorMessage)
 {
-    state_ = buildInitialGameState(playerAName, playerBName);
+    state_ = buildInitialGameState(playerAName, playerBName, rng_);
     turnEngine_.resetForBattle();
     loaded_ = false;
 
@@ -60,6 +62,26 @@ CommandResult GameSession::execute(const ActionCommand &command)
     return command.execute(*this);
 }
 
+bool GameSession::resign(PlayerId player, QString &errorMessage)
+{
+    if (!loaded_) {
+        errorMessage = QStringLiteral("Battle is not loaded.");
+        return false;
+    }
+    if (state_.status != GameStatus::InProgress) {
+        errorMessage = QStringLiteral("The battle is already over.");
+        return false;
+    }
+    if (player != PlayerId::A && player != PlayerId::B) {
+        errorMessage = QStringLiteral("Invalid player for resignation.");
+        return false;
+    }
+
+    state_.status = player == PlayerId::A ? GameStatus::WonByB : GameStatus::WonByA;
+    state_.turn.hasActiveCard = false;
+    return true;
+}
+
 bool GameSession::isLoaded() const
 {
     return loaded_;
@@ -81,6 +103,22 @@ bool GameSession::activeCardAgent(AgentType &typeOut, QString &errorMessage) con
     return true;
 }
 
+void GameSession::setSeed(quint32 seed)
+{
+    seed_ = seed;
+    rng_.seed(seed);
+}
+
+quint32 GameSession::seed() const
+{
+    return seed_;
+}
+
+QRandomGenerator &GameSession::rng()
+{
+    return rng_;
+}
+
 GameState &GameSession::state()
 {
     return state_;
@@ -91,4 +129,14 @@ const GameState &GameSession::state() const
     return state_;
 }
 
+void GameSession::setRecorder(ActionRecorder *recorder)
+{
+    recorder_ = recorder;
+}
+
+ActionRecorder *GameSession::recorder() const
+{
+    return recorder_;
+}
+
 } // namespace model
@@ -3,9 +3,23 @@
 #include "SessionTypes.h"
 #include "TurnEngine.h"
 
+#include <QRandomGenerator>
+
 namespace model {
 
 class ActionCommand;
+struct GameAction;
+
+// Sees every action a session executes successfully. It is called after the
+// turn has passed, so state.turn.activeCard is the card drawn for the next
+// turn (none once the game is over). rolls holds the attack dice, empty for
+// other actions.
+class ActionRecorder
+{
+public:
+    virtual ~ActionRecorder() = default;
+    virtual void actionExecuted(const GameState &state, const GameAction &action, const QVector<int> &rolls) = 0;
+};
 
 class GameSession
 {
@@ -20,6 +34,9 @@ public:
                              QString &errorMessage);
 
     CommandResult execute(const ActionCommand &command);
+    // Ends an in-progress battle as a win for the opponent of `player`. Not an
+    // action: recorders are not told and the turn card is dropped.
+    bool resign(PlayerId player, QString &errorMessage);
 
     bool isLoaded() const;
 
@@ -27,13 +44,26 @@ public:
 
     bool activeCardAgent(AgentType &typeOut, QString &errorMessage) const;
 
+    // Deck shuffles and attack dice draw from this generator; seed it before
+    // initializeNewBattle() for a reproducible battle.
+    void setSeed(quint32 seed);
+    quint32 seed() const;
+    QRandomGenerator &rng();
+
     GameState &state();
     const GameState &state() const;
 
+    // Not owned; pass nullptr to stop recording.
+    void setRecorder(ActionRecorder *recorder);
+    ActionRecorder *recorder() const;
+
 private:
     GameState &state_;
     TurnEngine turnEngine_;
+    quint32 seed_;
+    QRandomGenerator rng_;
     bool loaded_{false};
+    ActionRecorder *recorder_{nullptr};
 };
 
 } // namespace model
@@ -1,12 +1,15 @@
 #pragma once
 
-#include <QString>
+#include <QStringList>
 
 namespace model {
 
 struct CommandResult {
     bool ok{false};
     QString message;
+    // Cells whose occupants, marks or control the command changed, so views
+    // can repaint just those. Empty when the command failed.
+    QStringList changedCells;
 };
 
 } // namespace model
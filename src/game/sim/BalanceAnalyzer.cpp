@@ -0,0 +1,218 @@
+#include "BalanceAnalyzer.h"
+
+#include "BatchPlayout.h"
+#include "../rules/Victory.h"
+#include "../session/GameSession.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+
+namespace model {
+
+namespace {
+
+// Long enough that every depth up to BalanceOptions::searchDepth completes.
+constexpr qint64 kUntimedMs = 3600 * 1000;
+constexpr double kZ95 = 1.959964;
+
+quint64 chunkSeed(quint64 seed, qint64 batch, int chunk)
+{
+    quint64 x = seed ^ (quint64(batch) << 20) ^ quint64(chunk);
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+void addResult(PlayoutStats &stats, const SelfPlayResult &result)
+{
+    ++stats.games;
+    stats.totalTurns += result.turns;
+    if (result.status == GameStatus::WonByA) {
+        ++stats.winsA;
+    } else if (result.status == GameStatus::WonByB) {
+        ++stats.winsB;
+    } else {
+        ++stats.unfinished;
+    }
+}
+
+PlayoutStats playSearchChunk(const SelfPlayOpening &opening,
+                             const BalanceOptions &options,
+                             qint64 games,
+                             quint64 seed)
+{
+    SearchOptions player;
+    player.maxDepth = options.searchDepth;
+    player.timeMs = kUntimedMs;
+
+    QRandomGenerator rng(static_cast<quint32>(seed ^ (seed >> 32)));
+    PlayoutStats stats;
+    for (qint64 game = 0; game < games; ++game) {
+        SelfPlayOpening shuffled = opening;
+        reshufflePackedDecks(shuffled.start, rng);
+        addResult(stats, playSelfPlayGame(shuffled, player, player, rng.generate(), options.maxTurns));
+    }
+    return stats;
+}
+
+} // namespace
+
+QString balanceVerdictName(BalanceVerdict verdict)
+{
+    switch (verdict) {
+    case BalanceVerdict::Undecided:
+        return QStringLiteral("undecided");
+    case BalanceVerdict::Fair:
+        return QStringLiteral("fair");
+    case BalanceVerdict::FavorsA:
+        return QStringLiteral("favors A");
+    case BalanceVerdict::FavorsB:
+        return QStringLiteral("favors B");
+    }
+    return QString();
+}
+
+bool updateBalanceReport(BalanceReport &report, const BalanceOptions &options)
+{
+    report.verdict = BalanceVerdict::Undecided;
+    report.stopReason.clear();
+    if (report.games <= 0) {
+        return false;
+    }
+
+    const double n = double(report.games);
+    const double mean = (report.winsA + 0.5 * report.unfinished) / n;
+    const double meanSquare = (report.winsA + 0.25 * report.unfinished) / n;
+    const double variance = std::max(meanSquare - mean * mean, 1e-9);
+    const double halfWidth = kZ95 * std::sqrt(variance / n);
+
+    report.scoreA = mean;
+    report.low = std::max(0.0, mean - halfWidth);
+    report.high = std::min(1.0, mean + halfWidth);
+
+    // Normal approximation of the SPRT log-likelihood ratio between score
+    // s1 and s0 = 1/2; it handles draws through the sample variance.
+    const auto llr = [&](double s1) {
+        const double s0 = 0.5;
+        return n * (s1 - s0) * (2.0 * mean - s0 - s1) / (2.0 * variance);
+    };
+    report.llrFavorsA = llr(0.5 + options.margin);
+    report.llrFavorsB = llr(0.5 - options.margin);
+    report.lowerBound = std::log(options.beta / (1.0 - options.alpha));
+    report.upperBound = std::log((1.0 - options.beta) / options.alpha);
+
+    if (report.llrFavorsA >= report.upperBound) {
+        report.verdict = BalanceVerdict::FavorsA;
+        report.stopReason = QStringLiteral("sprt");
+    } else if (report.llrFavorsB >= report.upperBound) {
+        report.verdict = BalanceVerdict::FavorsB;
+        report.stopReason = QStringLiteral("sprt");
+    } else if (report.llrFavorsA <= report.lowerBound && report.llrFavorsB <= report.lowerBound) {
+        report.verdict = BalanceVerdict::Fair;
+        report.stopReason = QStringLiteral("sprt");
+    } else if (halfWidth < options.precision) {
+        if (mean > 0.5 + options.margin) {
+            report.verdict = BalanceVerdict::FavorsA;
+        } else if (mean < 0.5 - options.margin) {
+            report.verdict = BalanceVerdict::FavorsB;
+        } else {
+            report.verdict = BalanceVerdict::Fair;
+        }
+        report.stopReason = QStringLiteral("precision");
+    } else if (report.games >= options.maxGames) {
+        report.stopReason = QStringLiteral("max games");
+    }
+
+    return !report.stopReason.isEmpty();
+}
+
+bool analyzeScenarioBalance(const QString &boardPath,
+                            const QString &scenarioPath,
+                            const BalanceOptions &options,
+                            BalanceReport &report,
+                            QString &errorMessage,
+                            const BalanceProgressFn &onBatch)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    GameState state;
+    GameSession session(state);
+    session.setSeed(static_cast<quint32>(options.seed));
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), boardPath, scenarioPath, true, errorMessage)) {
+        return false;
+    }
+    if (evaluateGameStatus(state) != GameStatus::InProgress) {
+        errorMessage = QStringLiteral("Scenario %1 is already decided at load.").arg(scenarioPath);
+        return false;
+    }
+
+    auto board = std::make_shared<PackedBoard>();
+    SelfPlayOpening opening;
+    if (!buildPackedBoard(state.board, *board, errorMessage) ||
+        !packGameState(state, *board, opening.start, errorMessage)) {
+        return false;
+    }
+    opening.name = QFileInfo(scenarioPath).completeBaseName();
+    opening.setupSeed = static_cast<quint32>(options.seed);
+    opening.board = board;
+
+    report = BalanceReport{};
+    report.scenario = opening.name;
+
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+
+    for (qint64 batch = 0; report.games < options.maxGames; ++batch) {
+        const qint64 batchGames = std::min(std::max<qint64>(options.batchGames, 1), options.maxGames - report.games);
+        const int chunks = int(std::min<qint64>(threads, batchGames));
+        QVector<PlayoutStats> results(chunks);
+
+        for (int chunk = 0; chunk < chunks; ++chunk) {
+            const qint64 games = batchGames / chunks + (chunk < batchGames % chunks ? 1 : 0);
+            const quint64 seed = chunkSeed(options.seed, batch, chunk);
+            pool.start([&, chunk, games, seed]() {
+                if (options.policy == BalancePolicy::Random) {
+                    PlayoutOptions playout;
+                    playout.games = games;
+                    playout.seed = seed;
+                    playout.maxTurns = options.maxTurns;
+                    playout.reshuffleDecks = true;
+                    results[chunk] = runBatchPlayouts(*board, opening.start, playout);
+                } else {
+                    results[chunk] = playSearchChunk(opening, options, games, seed);
+                }
+            });
+        }
+        pool.waitForDone();
+
+        for (const PlayoutStats &stats : results) {
+            report.games += stats.games;
+            report.winsA += stats.winsA;
+            report.winsB += stats.winsB;
+            report.unfinished += stats.unfinished;
+            report.totalTurns += stats.totalTurns;
+        }
+
+        const bool stop = updateBalanceReport(report, options);
+        report.elapsedMs = timer.elapsed();
+        if (onBatch) {
+            onBatch(report);
+        }
+        if (stop) {
+            break;
+        }
+    }
+
+    report.elapsedMs = timer.elapsed();
+    return true;
+}
+
+} // namespace model
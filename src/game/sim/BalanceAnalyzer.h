@@ -0,0 +1,87 @@
+#pragma once
+
+#include "SelfPlay.h"
+
+#include <functional>
+
+namespace model {
+
+enum class BalancePolicy {
+    // Uniform-random actions through the batch playout kernel.
+    Random,
+    // Both sides play searchBestAction() at a fixed depth.
+    Search
+};
+
+struct BalanceOptions {
+    BalancePolicy policy{BalancePolicy::Random};
+    int searchDepth{1};
+    int maxTurns{400};
+
+    // The scenario counts as fair if A's expected score (win 1, unfinished
+    // 1/2, loss 0) is within margin of 1/2. alpha and beta are the error
+    // rates of the two sequential tests against 1/2 +- margin.
+    double margin{0.05};
+    double alpha{0.05};
+    double beta{0.05};
+    // Also stop once the 95% interval half-width drops below this.
+    double precision{0.005};
+
+    // Games per batch; the stopping rules are checked between batches.
+    qint64 batchGames{1024};
+    qint64 maxGames{1000000};
+    // Worker threads per batch; 0 uses all cores.
+    int threads{0};
+    quint64 seed{1};
+};
+
+enum class BalanceVerdict {
+    Undecided,
+    Fair,
+    FavorsA,
+    FavorsB
+};
+
+struct BalanceReport {
+    QString scenario;
+    qint64 games{0};
+    qint64 winsA{0};
+    qint64 winsB{0};
+    qint64 unfinished{0};
+    qint64 totalTurns{0};
+
+    double scoreA{0.5};
+    double low{0.0};
+    double high{1.0};
+    // Log-likelihood ratios of "A is favoured" and "B is favoured" against
+    // "fair"; either crossing upperBound decides, both under lowerBound
+    // means fair.
+    double llrFavorsA{0.0};
+    double llrFavorsB{0.0};
+    double lowerBound{0.0};
+    double upperBound{0.0};
+
+    BalanceVerdict verdict{BalanceVerdict::Undecided};
+    QString stopReason;
+    qint64 elapsedMs{0};
+};
+
+using BalanceProgressFn = std::function<void(const BalanceReport &)>;
+
+QString balanceVerdictName(BalanceVerdict verdict);
+
+// Recomputes the estimates, the SPRT statistics and the verdict from the
+// game counts in `report`. Returns true if a stopping rule has fired.
+bool updateBalanceReport(BalanceReport &report, const BalanceOptions &options);
+
+// Plays batches of games from the scenario start (decks reshuffled for every
+// game) until one of the sequential tests decides, the interval is narrow
+// enough or maxGames is reached. onBatch is called after every batch.
+bool analyzeScenarioBalance(const QString &boardPath,
+                            const QString &scenarioPath,
+                            const BalanceOptions &options,
+                            BalanceReport &report,
+                            QString &errorMessage,
+                            const BalanceProgressFn &onBatch = BalanceProgressFn());
+
+} // namespace model
@@ -0,0 +1,653 @@
+#include "BatchPlayout.h"
+
+#include "../actions/Combat.h"
+#include "../actions/LegalActions.h"
+#include "../actions/Movement.h"
+#include "../agents/AgentBehavior.h"
+#include "../model/Init.h"
+#include "../rules/PackedRules.h"
+#include "../rules/Victory.h"
+#include "../turn/TurnSystem.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace model {
+
+namespace {
+
+constexpr int kLanes = kPlayoutLanes;
+constexpr int kScout = static_cast<int>(AgentType::Scout);
+constexpr int kSniper = static_cast<int>(AgentType::Sniper);
+constexpr int kSergeant = static_cast<int>(AgentType::Sergeant);
+
+constexpr qint32 kNoAttack = 11;
+
+enum LaneStatus : qint32 {
+    LaneRunning = 0,
+    LaneWonByA = 1,
+    LaneWonByB = 2,
+    LaneStalled = 3
+};
+
+enum class PendingKind : quint8 {
+    Move,
+    Attack,
+    Mark,
+    Control,
+    Release
+};
+
+struct PendingAction {
+    PendingKind kind{PendingKind::Move};
+    qint8 cell{kNoCell};
+    quint8 targetType{0};
+};
+
+// Structure-of-arrays state for kLanes independent games. Fields touched by
+// the vector kernels are 32-bit so one AVX2 register covers all lanes.
+struct LaneBlock {
+    alignas(32) qint8 agentCell[2][kAgentTypeCount][kLanes];
+    alignas(32) quint8 hp[2][kAgentTypeCount][kLanes];
+    alignas(32) quint8 cardCount[2][kAgentTypeCount][kLanes];
+    alignas(32) quint8 deck[2][kMaxDeckCards][kLanes];
+    alignas(32) quint8 deckSize[2][kLanes];
+    alignas(32) quint64 marks[2][2][kLanes];
+    alignas(32) quint64 control[2][2][kLanes];
+    alignas(32) quint8 currentSide[kLanes];
+    alignas(32) quint8 activeCard[kLanes];
+
+    alignas(32) qint32 aliveMask[2][kLanes];
+    alignas(32) qint32 controlCount[2][kLanes];
+    alignas(32) qint32 status[kLanes];
+    alignas(32) qint32 threshold[kLanes];
+    alignas(32) qint32 diceCount[kLanes];
+    alignas(32) qint32 hit[kLanes];
+    alignas(32) quint32 rng[4][kLanes];
+
+    qint32 turns[kLanes];
+    bool live[kLanes];
+    PendingAction pending[kLanes];
+};
+
+quint64 splitMix64(quint64 &state)
+{
+    quint64 z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// xorshift128 per lane; the vector kernels below run the same recurrence.
+quint32 nextRandom(LaneBlock &block, int lane)
+{
+    const quint32 x = block.rng[0][lane];
+    const quint32 t = x ^ (x << 11);
+    const quint32 w = block.rng[3][lane];
+    block.rng[0][lane] = block.rng[1][lane];
+    block.rng[1][lane] = block.rng[2][lane];
+    block.rng[2][lane] = w;
+    block.rng[3][lane] = w ^ (w >> 19) ^ (t ^ (t >> 8));
+    return block.rng[3][lane];
+}
+
+// Uniform integer in [0, bound) from the top 24 bits; bound must be <= 255.
+int randomBelow(LaneBlock &block, int lane, int bound)
+{
+    return static_cast<int>(((nextRandom(block, lane) >> 8) * quint32(bound)) >> 24);
+}
+
+bool testMask(const quint64 (&mask)[2][kLanes], int lane, int cell)
+{
+    return (mask[cell >> 6][lane] >> (cell & 63)) & 1u;
+}
+
+void setMask(quint64 (&mask)[2][kLanes], int lane, int cell)
+{
+    mask[cell >> 6][lane] |= quint64(1) << (cell & 63);
+}
+
+void resetMask(quint64 (&mask)[2][kLanes], int lane, int cell)
+{
+    mask[cell >> 6][lane] &= ~(quint64(1) << (cell & 63));
+}
+
+quint8 takeFrontCard(LaneBlock &block, int side, int lane)
+{
+    const quint8 card = block.deck[side][0][lane];
+    const int size = block.deckSize[side][lane];
+    for (int i = 1; i < size; ++i) {
+        block.deck[side][i - 1][lane] = block.deck[side][i][lane];
+    }
+    block.deckSize[side][lane] = static_cast<quint8>(size - 1);
+    --block.cardCount[side][card][lane];
+    return card;
+}
+
+void pushBackCard(LaneBlock &block, int side, int lane, quint8 card)
+{
+    block.deck[side][block.deckSize[side][lane]++][lane] = card;
+    ++block.cardCount[side][card][lane];
+}
+
+// burnOneCard(): removes the first card of that type from the draw pile.
+void burnCard(LaneBlock &block, int side, int lane, quint8 type)
+{
+    const int size = block.deckSize[side][lane];
+    for (int i = 0; i < size; ++i) {
+        if (block.deck[side][i][lane] != type) {
+            continue;
+        }
+        for (int j = i + 1; j < size; ++j) {
+            block.deck[side][j - 1][lane] = block.deck[side][j][lane];
+        }
+        block.deckSize[side][lane] = static_cast<quint8>(size - 1);
+        --block.cardCount[side][type][lane];
+        return;
+    }
+}
+
+void loadLane(LaneBlock &block, int lane, const PackedState &start, quint64 &seedState, bool reshuffle)
+{
+    for (int side = 0; side < 2; ++side) {
+        const PackedSide &packed = start.sides[side];
+        for (int type = 0; type < kAgentTypeCount; ++type) {
+            block.agentCell[side][type][lane] = packed.agentCell[type];
+            block.hp[side][type][lane] = packed.hp[type];
+            block.cardCount[side][type][lane] = packed.cardCount[type];
+        }
+        for (int i = 0; i < kMaxDeckCards; ++i) {
+            block.deck[side][i][lane] = packed.deck[i];
+        }
+        block.deckSize[side][lane] = packed.deckSize;
+        for (int word = 0; word < 2; ++word) {
+            block.marks[side][word][lane] = packed.marks.words[word];
+            block.control[side][word][lane] = packed.control.words[word];
+        }
+        block.aliveMask[side][lane] = packed.aliveMask;
+        block.controlCount[side][lane] = packed.control.count();
+    }
+
+    block.currentSide[lane] = start.currentSide;
+    block.activeCard[lane] = start.activeCard;
+    block.status[lane] = LaneRunning;
+    block.threshold[lane] = kNoAttack;
+    block.diceCount[lane] = 0;
+    block.hit[lane] = 0;
+    block.turns[lane] = 0;
+    block.live[lane] = true;
+
+    const quint64 a = splitMix64(seedState);
+    const quint64 b = splitMix64(seedState);
+    block.rng[0][lane] = static_cast<quint32>(a) | 1u;
+    block.rng[1][lane] = static_cast<quint32>(a >> 32);
+    block.rng[2][lane] = static_cast<quint32>(b);
+    block.rng[3][lane] = static_cast<quint32>(b >> 32);
+
+    if (!reshuffle) {
+        return;
+    }
+
+    const int current = block.currentSide[lane];
+    const int size = block.deckSize[current][lane];
+    for (int i = size; i > 0; --i) {
+        block.deck[current][i][lane] = block.deck[current][i - 1][lane];
+    }
+    block.deck[current][0][lane] = block.activeCard[lane];
+    block.deckSize[current][lane] = static_cast<quint8>(size + 1);
+    ++block.cardCount[current][block.activeCard[lane]][lane];
+
+    for (int side = 0; side < 2; ++side) {
+        for (int i = block.deckSize[side][lane] - 1; i > 0; --i) {
+            const int j = randomBelow(block, lane, i + 1);
+            std::swap(block.deck[side][i][lane], block.deck[side][j][lane]);
+        }
+    }
+    block.activeCard[lane] = takeFrontCard(block, current, lane);
+}
+
+// Picks a uniformly random legal action for one lane (same action set as
+// legalActions()) and prepares the threshold for the dice kernel.
+void chooseAction(const PackedBoard &board, LaneBlock &block, int lane)
+{
+    block.threshold[lane] = kNoAttack;
+    block.diceCount[lane] = 0;
+
+    const int side = block.currentSide[lane];
+    const int enemy = side ^ 1;
+    const int type = block.activeCard[lane];
+    const qint8 cell = block.agentCell[side][type][lane];
+    if (cell == kNoCell) {
+        block.status[lane] = LaneStalled;
+        return;
+    }
+
+    CellMask occupied;
+    for (int s = 0; s < 2; ++s) {
+        for (int t = 0; t < kAgentTypeCount; ++t) {
+            const qint8 c = block.agentCell[s][t][lane];
+            if (c != kNoCell) {
+                occupied.set(c);
+            }
+        }
+    }
+
+    PendingAction options[16];
+    int count = 0;
+
+    CellMask destinations = board.neighbors[cell] & ~occupied;
+    if (type != kScout) {
+        destinations = destinations & CellMask{{block.marks[side][0][lane], block.marks[side][1][lane]}};
+    }
+    for (int word = 0; word < 2; ++word) {
+        quint64 bits = destinations.words[word];
+        while (bits != 0) {
+            const int bit = qCountTrailingZeroBits(bits);
+            bits &= bits - 1;
+            options[count++] = PendingAction{PendingKind::Move, static_cast<qint8>(word * 64 + bit), 0};
+        }
+    }
+
+    for (int target = 0; target < kAgentTypeCount; ++target) {
+        const qint8 targetCell = block.agentCell[enemy][target][lane];
+        if (targetCell == kNoCell || !board.reachable[cell].test(targetCell) ||
+            block.cardCount[enemy][target][lane] == 0) {
+            continue;
+        }
+        options[count++] = PendingAction{PendingKind::Attack, targetCell, static_cast<quint8>(target)};
+    }
+
+    if (type == kScout && !testMask(block.marks[side], lane, cell)) {
+        options[count++] = PendingAction{PendingKind::Mark, cell, 0};
+    }
+    if (type == kSergeant) {
+        if (!testMask(block.control[enemy], lane, cell)) {
+            options[count++] = PendingAction{PendingKind::Control, cell, 0};
+        } else {
+            options[count++] = PendingAction{PendingKind::Release, cell, 0};
+        }
+    }
+
+    if (count == 0) {
+        block.status[lane] = LaneStalled;
+        return;
+    }
+
+    const PendingAction chosen = options[randomBelow(block, lane, count)];
+    block.pending[lane] = chosen;
+    if (chosen.kind == PendingKind::Attack) {
+        const int threshold = board.pathShield[cell][chosen.cell] + block.hp[enemy][chosen.targetType][lane];
+        block.threshold[lane] = std::clamp(threshold, 1, 10);
+        block.diceCount[lane] = packedAttackDice(type);
+    }
+}
+
+// Rolls three d10 per lane and sets hit[lane] when any of the first
+// diceCount dice reaches the threshold. Lanes that are not attacking carry
+// threshold 11 and never hit.
+void rollDice(LaneBlock &block)
+{
+#if defined(__AVX2__)
+    __m256i x = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.rng[0]));
+    __m256i y = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.rng[1]));
+    __m256i z = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.rng[2]));
+    __m256i w = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.rng[3]));
+    const __m256i thresholdMinusOne =
+        _mm256_sub_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.threshold)),
+                         _mm256_set1_epi32(1));
+    const __m256i dice = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.diceCount));
+    __m256i hit = _mm256_setzero_si256();
+
+    for (int die = 0; die < 3; ++die) {
+        const __m256i t = _mm256_xor_si256(x, _mm256_slli_epi32(x, 11));
+        x = y;
+        y = z;
+        z = w;
+        w = _mm256_xor_si256(_mm256_xor_si256(w, _mm256_srli_epi32(w, 19)),
+                             _mm256_xor_si256(t, _mm256_srli_epi32(t, 8)));
+
+        const __m256i top = _mm256_srli_epi32(w, 8);
+        const __m256i scaled = _mm256_add_epi32(_mm256_slli_epi32(top, 3), _mm256_slli_epi32(top, 1));
+        const __m256i roll = _mm256_add_epi32(_mm256_srli_epi32(scaled, 24), _mm256_set1_epi32(1));
+        const __m256i counts = _mm256_cmpgt_epi32(dice, _mm256_set1_epi32(die));
+        hit = _mm256_or_si256(hit, _mm256_and_si256(counts, _mm256_cmpgt_epi32(roll, thresholdMinusOne)));
+    }
+
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.rng[0]), x);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.rng[1]), y);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.rng[2]), z);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.rng[3]), w);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.hit), hit);
+#elif defined(__SSE2__)
+    for (int half = 0; half < kLanes; half += 4) {
+        __m128i x = _mm_load_si128(reinterpret_cast<const __m128i *>(block.rng[0] + half));
+        __m128i y = _mm_load_si128(reinterpret_cast<const __m128i *>(block.rng[1] + half));
+        __m128i z = _mm_load_si128(reinterpret_cast<const __m128i *>(block.rng[2] + half));
+        __m128i w = _mm_load_si128(reinterpret_cast<const __m128i *>(block.rng[3] + half));
+        const __m128i thresholdMinusOne =
+            _mm_sub_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.threshold + half)),
+                          _mm_set1_epi32(1));
+        const __m128i dice = _mm_load_si128(reinterpret_cast<const __m128i *>(block.diceCount + half));
+        __m128i hit = _mm_setzero_si128();
+
+        for (int die = 0; die < 3; ++die) {
+            const __m128i t = _mm_xor_si128(x, _mm_slli_epi32(x, 11));
+            x = y;
+            y = z;
+            z = w;
+            w = _mm_xor_si128(_mm_xor_si128(w, _mm_srli_epi32(w, 19)),
+                              _mm_xor_si128(t, _mm_srli_epi32(t, 8)));
+
+            const __m128i top = _mm_srli_epi32(w, 8);
+            const __m128i scaled = _mm_add_epi32(_mm_slli_epi32(top, 3), _mm_slli_epi32(top, 1));
+            const __m128i roll = _mm_add_epi32(_mm_srli_epi32(scaled, 24), _mm_set1_epi32(1));
+            const __m128i counts = _mm_cmpgt_epi32(dice, _mm_set1_epi32(die));
+            hit = _mm_or_si128(hit, _mm_and_si128(counts, _mm_cmpgt_epi32(roll, thresholdMinusOne)));
+        }
+
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.rng[0] + half), x);
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.rng[1] + half), y);
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.rng[2] + half), z);
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.rng[3] + half), w);
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.hit + half), hit);
+    }
+#else
+    for (int lane = 0; lane < kLanes; ++lane) {
+        qint32 hit = 0;
+        for (int die = 0; die < 3; ++die) {
+            const int roll = static_cast<int>((((nextRandom(block, lane) >> 8) * 10u) >> 24) + 1);
+            if (die < block.diceCount[lane] && roll >= block.threshold[lane]) {
+                hit = -1;
+            }
+        }
+        block.hit[lane] = hit;
+    }
+#endif
+}
+
+void applyAction(LaneBlock &block, int lane)
+{
+    const int side = block.currentSide[lane];
+    const int enemy = side ^ 1;
+    const int type = block.activeCard[lane];
+    const PendingAction &action = block.pending[lane];
+
+    switch (action.kind) {
+    case PendingKind::Move:
+        block.agentCell[side][type][lane] = action.cell;
+        break;
+    case PendingKind::Mark:
+        setMask(block.marks[side], lane, action.cell);
+        break;
+    case PendingKind::Control:
+        if (!testMask(block.control[side], lane, action.cell)) {
+            setMask(block.control[side], lane, action.cell);
+            ++block.controlCount[side][lane];
+        }
+        break;
+    case PendingKind::Release:
+        resetMask(block.control[enemy], lane, action.cell);
+        --block.controlCount[enemy][lane];
+        break;
+    case PendingKind::Attack:
+        if (block.hit[lane] == 0) {
+            break;
+        }
+        burnCard(block, enemy, lane, action.targetType);
+        if (block.cardCount[enemy][action.targetType][lane] == 0) {
+            block.agentCell[enemy][action.targetType][lane] = kNoCell;
+            block.hp[enemy][action.targetType][lane] = 0;
+            block.aliveMask[enemy][lane] &= ~(1 << action.targetType);
+        }
+        break;
+    }
+}
+
+// evaluateGameStatus() across lanes: control threshold first, then
+// elimination, with "both sides eliminated" staying in progress.
+void checkVictory(LaneBlock &block)
+{
+#if defined(__AVX2__)
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i limit = _mm256_set1_epi32(kControlCellsToWin - 1);
+    const __m256i allOnes = _mm256_set1_epi32(-1);
+    const __m256i ctrlA = _mm256_cmpgt_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.controlCount[0])), limit);
+    const __m256i ctrlB = _mm256_cmpgt_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.controlCount[1])), limit);
+    const __m256i deadA = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.aliveMask[0])), zero);
+    const __m256i deadB = _mm256_cmpeq_epi32(_mm256_load_si256(reinterpret_cast<const __m256i *>(block.aliveMask[1])), zero);
+    const __m256i notCtrlB = _mm256_xor_si256(ctrlB, allOnes);
+    const __m256i winA = _mm256_or_si256(ctrlA, _mm256_and_si256(notCtrlB, _mm256_andnot_si256(deadA, deadB)));
+    const __m256i winB = _mm256_andnot_si256(ctrlA, _mm256_or_si256(ctrlB, _mm256_andnot_si256(deadB, deadA)));
+    const __m256i outcome = _mm256_or_si256(_mm256_and_si256(winA, _mm256_set1_epi32(LaneWonByA)),
+                                            _mm256_and_si256(winB, _mm256_set1_epi32(LaneWonByB)));
+    const __m256i status = _mm256_load_si256(reinterpret_cast<const __m256i *>(block.status));
+    const __m256i running = _mm256_cmpeq_epi32(status, zero);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(block.status),
+                       _mm256_or_si256(status, _mm256_and_si256(running, outcome)));
+#elif defined(__SSE2__)
+    for (int half = 0; half < kLanes; half += 4) {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i limit = _mm_set1_epi32(kControlCellsToWin - 1);
+        const __m128i allOnes = _mm_set1_epi32(-1);
+        const __m128i ctrlA = _mm_cmpgt_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.controlCount[0] + half)), limit);
+        const __m128i ctrlB = _mm_cmpgt_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.controlCount[1] + half)), limit);
+        const __m128i deadA = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.aliveMask[0] + half)), zero);
+        const __m128i deadB = _mm_cmpeq_epi32(_mm_load_si128(reinterpret_cast<const __m128i *>(block.aliveMask[1] + half)), zero);
+        const __m128i notCtrlB = _mm_xor_si128(ctrlB, allOnes);
+        const __m128i winA = _mm_or_si128(ctrlA, _mm_and_si128(notCtrlB, _mm_andnot_si128(deadA, deadB)));
+        const __m128i winB = _mm_andnot_si128(ctrlA, _mm_or_si128(ctrlB, _mm_andnot_si128(deadB, deadA)));
+        const __m128i outcome = _mm_or_si128(_mm_and_si128(winA, _mm_set1_epi32(LaneWonByA)),
+                                             _mm_and_si128(winB, _mm_set1_epi32(LaneWonByB)));
+        const __m128i status = _mm_load_si128(reinterpret_cast<const __m128i *>(block.status + half));
+        const __m128i running = _mm_cmpeq_epi32(status, zero);
+        _mm_store_si128(reinterpret_cast<__m128i *>(block.status + half),
+                        _mm_or_si128(status, _mm_and_si128(running, outcome)));
+    }
+#else
+    for (int lane = 0; lane < kLanes; ++lane) {
+        if (block.status[lane] != LaneRunning) {
+            continue;
+        }
+        const bool ctrlA = block.controlCount[0][lane] >= kControlCellsToWin;
+        const bool ctrlB = block.controlCount[1][lane] >= kControlCellsToWin;
+        const bool deadA = block.aliveMask[0][lane] == 0;
+        const bool deadB = block.aliveMask[1][lane] == 0;
+        if (ctrlA || (!ctrlB && deadB && !deadA)) {
+            block.status[lane] = LaneWonByA;
+        } else if (ctrlB || (deadA && !deadB)) {
+            block.status[lane] = LaneWonByB;
+        }
+    }
+#endif
+}
+
+// endTurn() + drawTurnCard() for one lane.
+void advanceTurn(LaneBlock &block, int lane)
+{
+    const int side = block.currentSide[lane];
+    pushBackCard(block, side, lane, block.activeCard[lane]);
+
+    const int next = side ^ 1;
+    block.currentSide[lane] = static_cast<quint8>(next);
+    if (block.deckSize[next][lane] == 0) {
+        block.status[lane] = LaneStalled;
+        return;
+    }
+    block.activeCard[lane] = takeFrontCard(block, next, lane);
+}
+
+void recordOutcome(PlayoutStats &stats, qint32 status, int turns)
+{
+    ++stats.games;
+    stats.totalTurns += turns;
+    if (status == LaneWonByA) {
+        ++stats.winsA;
+    } else if (status == LaneWonByB) {
+        ++stats.winsB;
+    } else {
+        ++stats.unfinished;
+    }
+}
+
+} // namespace
+
+PlayoutStats runBatchPlayouts(const PackedBoard &board,
+                              const PackedState &start,
+                              const PlayoutOptions &options)
+{
+    PlayoutStats stats;
+    if (start.status != GameStatus::InProgress || !start.hasActiveCard || options.games <= 0) {
+        return stats;
+    }
+
+    LaneBlock block{};
+    quint64 seedState = options.seed;
+    qint64 started = 0;
+
+    for (int lane = 0; lane < kLanes; ++lane) {
+        if (started < options.games) {
+            loadLane(block, lane, start, seedState, options.reshuffleDecks);
+            ++started;
+        } else {
+            block.live[lane] = false;
+            block.status[lane] = LaneStalled;
+            block.threshold[lane] = kNoAttack;
+        }
+    }
+
+    while (stats.games < options.games) {
+        for (int lane = 0; lane < kLanes; ++lane) {
+            if (block.live[lane] && block.status[lane] == LaneRunning) {
+                chooseAction(board, block, lane);
+            } else {
+                block.threshold[lane] = kNoAttack;
+                block.diceCount[lane] = 0;
+            }
+        }
+
+        rollDice(block);
+
+        for (int lane = 0; lane < kLanes; ++lane) {
+            if (block.live[lane] && block.status[lane] == LaneRunning) {
+                applyAction(block, lane);
+                ++block.turns[lane];
+            }
+        }
+
+        checkVictory(block);
+
+        for (int lane = 0; lane < kLanes; ++lane) {
+            if (!block.live[lane]) {
+                continue;
+            }
+            if (block.status[lane] == LaneRunning) {
+                if (block.turns[lane] < options.maxTurns) {
+                    advanceTurn(block, lane);
+                    if (block.status[lane] == LaneRunning) {
+                        continue;
+                    }
+                }
+            }
+
+            recordOutcome(stats, block.status[lane], block.turns[lane]);
+            if (started < options.games) {
+                loadLane(block, lane, start, seedState, options.reshuffleDecks);
+                ++started;
+            } else {
+                block.live[lane] = false;
+            }
+        }
+    }
+
+    return stats;
+}
+
+PlayoutStats runEnginePlayouts(const GameState &start, const PlayoutOptions &options)
+{
+    PlayoutStats stats;
+    if (start.status != GameStatus::InProgress || !start.turn.hasActiveCard) {
+        return stats;
+    }
+
+    QRandomGenerator rng(static_cast<quint32>(options.seed ^ (options.seed >> 32)));
+    QString error;
+
+    for (qint64 game = 0; game < options.games; ++game) {
+        GameState state = cloneGameState(start);
+
+        if (options.reshuffleDecks) {
+            PlayerState *current = playerById(state, state.turn.currentPlayer);
+            current->deck.drawPile.prepend(state.turn.activeCard);
+            state.turn.hasActiveCard = false;
+            shuffleAllDecks(state, rng);
+            Card drawn{};
+            drawTurnCard(state, drawn, error);
+        }
+
+        int turns = 0;
+        bool stalled = false;
+        while (state.status == GameStatus::InProgress && turns < options.maxTurns) {
+            const QVector<GameAction> actions = legalActions(state);
+            if (actions.isEmpty()) {
+                stalled = true;
+                break;
+            }
+
+            const GameAction &action = actions[rng.bounded(static_cast<int>(actions.size()))];
+            const PlayerId owner = state.turn.currentPlayer;
+            const AgentType type = state.turn.activeCard.agent;
+            switch (action.kind) {
+            case ActionKind::Move:
+                moveAgent(state, owner, type, action.cellId, error);
+                break;
+            case ActionKind::Attack:
+                attack(state, owner, type, action.cellId, rng);
+                break;
+            case ActionKind::Special:
+                behaviorFor(type)->executeSpecial(state, owner, action.special, error);
+                break;
+            }
+            ++turns;
+
+            if (state.status != GameStatus::InProgress || turns >= options.maxTurns) {
+                break;
+            }
+
+            Card drawn{};
+            if (!endTurn(state, error) || !drawTurnCard(state, drawn, error)) {
+                stalled = true;
+                break;
+            }
+        }
+
+        qint32 outcome = LaneStalled;
+        if (!stalled && state.status == GameStatus::WonByA) {
+            outcome = LaneWonByA;
+        } else if (!stalled && state.status == GameStatus::WonByB) {
+            outcome = LaneWonByB;
+        }
+        recordOutcome(stats, outcome, turns);
+    }
+
+    return stats;
+}
+
+const char *playoutSimdBackend()
+{
+#if defined(__AVX2__)
+    return "avx2";
+#elif defined(__SSE2__)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
+
+} // namespace model
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "../model/PackedState.h"
+
+namespace model {
+
+constexpr int kPlayoutLanes = 8;
+
+struct PlayoutOptions {
+    qint64 games{1000};
+    quint64 seed{1};
+    int maxTurns{400};
+    // Put the active card back on top and reshuffle both decks before every
+    // game, as a fresh battle would.
+    bool reshuffleDecks{false};
+};
+
+struct PlayoutStats {
+    qint64 games{0};
+    qint64 winsA{0};
+    qint64 winsB{0};
+    qint64 unfinished{0};
+    qint64 totalTurns{0};
+};
+
+// Uniform-random playouts advanced kPlayoutLanes games at a time over a
+// structure-of-arrays copy of PackedState. Action choice and application are
+// per lane; dice rolls, hit checks and victory checks run across all lanes
+// with AVX2 or SSE2 when the build enables them, scalar code otherwise.
+PlayoutStats runBatchPlayouts(const PackedBoard &board,
+                              const PackedState &start,
+                              const PlayoutOptions &options);
+
+// The same random policy played through the real engine (legalActions,
+// moveAgent, attack, executeSpecial, endTurn, drawTurnCard). Used to check
+// that the batch kernel is statistically identical.
+PlayoutStats runEnginePlayouts(const GameState &start, const PlayoutOptions &options);
+
+const char *playoutSimdBackend();
+
+} // namespace model
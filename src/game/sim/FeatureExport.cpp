@@ -0,0 +1,461 @@
+#include "FeatureExport.h"
+
+#include "../ai/Evaluation.h"
+#include "../replay/Replayer.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSaveFile>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
+#include <QtEndian>
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <limits>
+#include <memory>
+
+namespace model {
+
+namespace {
+
+constexpr char kMagic[4] = {'U', 'D', 'F', 'T'};
+constexpr qint64 kHeaderSize = 32;
+constexpr qint64 kChunkHeaderSize = 8;
+// Long enough that every depth up to FeatureExportOptions::searchDepth completes.
+constexpr qint64 kUntimedMs = 3600 * 1000;
+
+quint64 gameSeed(quint64 seed, qint64 game)
+{
+    quint64 x = seed ^ (quint64(game) * 0x9e3779b97f4a7c15ull);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+qint64 sampleBytes(FeatureFormat format)
+{
+    return (kFeatureCount + 1) * (format == FeatureFormat::Float32 ? 4 : 1);
+}
+
+QByteArray fileHeader(FeatureFormat format)
+{
+    QByteArray header(kHeaderSize, '\0');
+    uchar *bytes = reinterpret_cast<uchar *>(header.data());
+    std::copy(std::begin(kMagic), std::end(kMagic), bytes);
+    qToLittleEndian(static_cast<quint16>(kFeatureFileVersion), bytes + 4);
+    bytes[6] = static_cast<uchar>(format);
+    qToLittleEndian(static_cast<quint16>(kFeaturePlanes), bytes + 8);
+    qToLittleEndian(static_cast<quint16>(kFeatureRows), bytes + 10);
+    qToLittleEndian(static_cast<quint16>(kFeatureCols), bytes + 12);
+    qToLittleEndian(static_cast<quint16>(kFeatureScalars), bytes + 14);
+    return header;
+}
+
+struct Chunk {
+    QByteArray data;
+    int samples{0};
+};
+
+// A fixed set of chunk buffers, two per encoder: an encoder fills one while
+// the writer drains the other, and blocks only if the writer falls behind.
+class ChunkQueue
+{
+public:
+    ChunkQueue(int encoders, qint64 chunkBytes)
+        : producers(encoders)
+    {
+        for (int i = 0; i < 2 * encoders; ++i) {
+            storage.push_back(std::make_unique<Chunk>());
+            storage.back()->data = QByteArray(kChunkHeaderSize + chunkBytes, '\0');
+            freeChunks.append(storage.back().get());
+        }
+    }
+
+    Chunk *acquire()
+    {
+        QMutexLocker locker(&mutex);
+        while (freeChunks.isEmpty()) {
+            changed.wait(&mutex);
+        }
+        Chunk *chunk = freeChunks.takeLast();
+        chunk->samples = 0;
+        return chunk;
+    }
+
+    void submit(Chunk *chunk)
+    {
+        QMutexLocker locker(&mutex);
+        fullChunks.append(chunk);
+        changed.wakeAll();
+    }
+
+    void release(Chunk *chunk)
+    {
+        QMutexLocker locker(&mutex);
+        freeChunks.append(chunk);
+        changed.wakeAll();
+    }
+
+    void producerDone()
+    {
+        QMutexLocker locker(&mutex);
+        --producers;
+        changed.wakeAll();
+    }
+
+    // The next full chunk, or nullptr once every encoder is done.
+    Chunk *takeFull()
+    {
+        QMutexLocker locker(&mutex);
+        while (fullChunks.isEmpty() && producers > 0) {
+            changed.wait(&mutex);
+        }
+        return fullChunks.isEmpty() ? nullptr : fullChunks.takeFirst();
+    }
+
+private:
+    QMutex mutex;
+    QWaitCondition changed;
+    std::vector<std::unique_ptr<Chunk>> storage;
+    QVector<Chunk *> freeChunks;
+    QVector<Chunk *> fullChunks;
+    int producers;
+};
+
+// One encoder's view of the output: positions of the current game are kept
+// until its result is known, then labelled and copied into the chunk.
+class SampleWriter
+{
+public:
+    SampleWriter(ChunkQueue &queue, const FeatureExportOptions &options)
+        : queue(queue)
+        , format(options.format)
+        , chunkSamples(std::max(options.chunkSamples, 1))
+        , bytesPerSample(sampleBytes(options.format))
+    {
+    }
+
+    void addPosition(const PackedBoard &board, const PackedState &state)
+    {
+        const qsizetype at = positions.size();
+        positions.resize(at + kFeatureCount);
+        encodeFeatures(board, state, positions.data() + at);
+        movers.append(static_cast<qint8>(state.currentSide));
+    }
+
+    void finishGame(GameStatus status)
+    {
+        for (int i = 0; i < movers.size(); ++i) {
+            if (chunk == nullptr) {
+                chunk = queue.acquire();
+            }
+
+            qint8 label = 0;
+            if (status == GameStatus::WonByA || status == GameStatus::WonByB) {
+                const int winner = status == GameStatus::WonByA ? 0 : 1;
+                label = movers[i] == winner ? 1 : -1;
+            }
+
+            const qint8 *features = positions.constData() + qsizetype(i) * kFeatureCount;
+            char *out = chunk->data.data() + kChunkHeaderSize + qint64(chunk->samples) * bytesPerSample;
+            if (format == FeatureFormat::Int8) {
+                std::copy(features, features + kFeatureCount, out);
+                out[kFeatureCount] = label;
+            } else {
+                for (int f = 0; f < kFeatureCount; ++f) {
+                    qToLittleEndian(static_cast<float>(features[f]), out + 4 * f);
+                }
+                qToLittleEndian(static_cast<float>(label), out + 4 * kFeatureCount);
+            }
+
+            if (++chunk->samples == chunkSamples) {
+                queue.submit(chunk);
+                chunk = nullptr;
+            }
+        }
+        samples += movers.size();
+        positions.clear();
+        movers.clear();
+    }
+
+    void discardGame()
+    {
+        positions.clear();
+        movers.clear();
+    }
+
+    void flush()
+    {
+        if (chunk != nullptr && chunk->samples > 0) {
+            queue.submit(chunk);
+        } else if (chunk != nullptr) {
+            queue.release(chunk);
+        }
+        chunk = nullptr;
+    }
+
+    qint64 samples{0};
+
+private:
+    ChunkQueue &queue;
+    FeatureFormat format;
+    int chunkSamples;
+    qint64 bytesPerSample;
+    Chunk *chunk = nullptr;
+    QVector<qint8> positions;
+    QVector<qint8> movers;
+};
+
+void addOutcome(FeatureExportStats &stats, GameStatus status)
+{
+    ++stats.games;
+    if (status == GameStatus::WonByA) {
+        ++stats.winsA;
+    } else if (status == GameStatus::WonByB) {
+        ++stats.winsB;
+    } else {
+        ++stats.unfinished;
+    }
+}
+
+int encoderCount(const FeatureExportOptions &options, qint64 games)
+{
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    return int(std::clamp<qint64>(games, 1, threads));
+}
+
+// Encodes the next game into the writer; false once there are no games left.
+// encoder identifies the calling thread (0 .. threads - 1) for per-thread
+// state.
+using EncodeNextFn = std::function<bool(int encoder, SampleWriter &writer, FeatureExportStats &stats)>;
+
+// Runs `threads` encoders on a thread pool and writes their chunks from the
+// calling thread as they fill.
+bool runExport(int threads,
+               const FeatureExportOptions &options,
+               const QString &path,
+               const EncodeNextFn &encodeNext,
+               FeatureExportStats &stats,
+               QString &errorMessage)
+{
+    QElapsedTimer timer;
+    timer.start();
+    stats = FeatureExportStats{};
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        errorMessage = QStringLiteral("Cannot write feature file: %1").arg(path);
+        return false;
+    }
+    const QByteArray header = fileHeader(options.format);
+    bool ok = file.write(header) == header.size();
+    stats.bytes = header.size();
+
+    const qint64 bytesPerSample = sampleBytes(options.format);
+    ChunkQueue queue(threads, std::max(options.chunkSamples, 1) * bytesPerSample);
+    QMutex statsMutex;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(threads);
+    for (int thread = 0; thread < threads; ++thread) {
+        pool.start([&, thread]() {
+            SampleWriter writer(queue, options);
+            FeatureExportStats local;
+            while (encodeNext(thread, writer, local)) {
+            }
+            writer.flush();
+            local.samples = writer.samples;
+
+            QMutexLocker locker(&statsMutex);
+            stats.games += local.games;
+            stats.samples += local.samples;
+            stats.winsA += local.winsA;
+            stats.winsB += local.winsB;
+            stats.unfinished += local.unfinished;
+            locker.unlock();
+            queue.producerDone();
+        });
+    }
+
+    // Keep draining after a write error so no encoder blocks on a full queue.
+    while (Chunk *chunk = queue.takeFull()) {
+        const qint64 payload = qint64(chunk->samples) * bytesPerSample;
+        uchar *bytes = reinterpret_cast<uchar *>(chunk->data.data());
+        qToLittleEndian(static_cast<quint32>(chunk->samples), bytes);
+        qToLittleEndian(static_cast<quint32>(payload), bytes + 4);
+        ok = ok && file.write(chunk->data.constData(), kChunkHeaderSize + payload) == kChunkHeaderSize + payload;
+        stats.bytes += kChunkHeaderSize + payload;
+        queue.release(chunk);
+    }
+    pool.waitForDone();
+
+    if (!ok || !file.commit()) {
+        errorMessage = QStringLiteral("Failed to write feature file: %1").arg(path);
+        return false;
+    }
+    stats.elapsedMs = timer.elapsed();
+    return true;
+}
+
+} // namespace
+
+bool exportSelfPlayFeatures(const QVector<SelfPlayOpening> &openings,
+                            const FeatureExportOptions &options,
+                            const QString &path,
+                            FeatureExportStats &stats,
+                            QString &errorMessage)
+{
+    if (openings.isEmpty()) {
+        errorMessage = QStringLiteral("No openings to play.");
+        return false;
+    }
+    for (const SelfPlayOpening &opening : openings) {
+        if (!boardFitsFeatures(*opening.board, errorMessage)) {
+            errorMessage = opening.name + QStringLiteral(": ") + errorMessage;
+            return false;
+        }
+    }
+
+    SearchOptions player;
+    player.maxDepth = options.searchDepth;
+    player.timeMs = kUntimedMs;
+
+    std::atomic<qint64> nextGame{0};
+    const auto encodeNext = [&](int, SampleWriter &writer, FeatureExportStats &local) {
+        const qint64 game = nextGame++;
+        if (game >= options.games) {
+            return false;
+        }
+        const SelfPlayOpening &opening = openings[int(game % openings.size())];
+        const PackedBoard &board = *opening.board;
+        const quint64 seed = gameSeed(options.seed, game);
+        QRandomGenerator rng(static_cast<quint32>(seed ^ (seed >> 32)));
+        PackedState state = opening.start;
+        reshufflePackedDecks(state, rng);
+
+        PackedAction actions[kMaxPackedActions];
+        for (int turn = 0; state.status == GameStatus::InProgress && turn < options.maxTurns; ++turn) {
+            PackedAction action;
+            if (options.policy == FeaturePolicy::Random) {
+                const int count = packedLegalActions(board, state, actions);
+                if (count == 0) {
+                    break;
+                }
+                action = actions[rng.bounded(count)];
+            } else {
+                const SearchInfo info = searchBestAction(board, state, player);
+                if (!info.hasAction) {
+                    break;
+                }
+                action = info.action;
+            }
+            writer.addPosition(board, state);
+
+            bool hit = false;
+            if (action.kind == PackedActionKind::Attack) {
+                const int threshold = packedAttackThreshold(board, state, action);
+                hit = int(rng.bounded(1000)) < attackHitChance(packedAttackDice(state.activeCard), threshold);
+            }
+            applyPackedAction(board, state, action, hit);
+            if (state.status != GameStatus::InProgress) {
+                break;
+            }
+            endPackedTurn(state);
+            if (!drawPackedCard(state)) {
+                break;
+            }
+        }
+
+        writer.finishGame(state.status);
+        addOutcome(local, state.status);
+        return true;
+    };
+    return runExport(encoderCount(options, options.games), options, path, encodeNext, stats, errorMessage);
+}
+
+bool exportJournalFeatures(const QStringList &journals,
+                           const FeatureExportOptions &options,
+                           const QString &path,
+                           FeatureExportStats &stats,
+                           QStringList &warnings,
+                           QString &errorMessage)
+{
+    // Fail on unreadable inputs before the output is started.
+    for (const QString &journal : journals) {
+        ReplayJournalReader probe;
+        if (!probe.open(journal, errorMessage)) {
+            return false;
+        }
+    }
+
+    // Encoders take games from one reader at a time under the lock, so at
+    // most one game per encoder is in memory whatever the journal size.
+    QMutex readerMutex;
+    ReplayJournalReader reader;
+    int journal = -1;
+    bool readerOpen = false;
+    const auto takeGame = [&](ReplayGame &game) {
+        QMutexLocker locker(&readerMutex);
+        while (true) {
+            if (readerOpen) {
+                game = ReplayGame();
+                QString message;
+                if (reader.next(game, message)) {
+                    return true;
+                }
+                if (!message.isEmpty()) {
+                    warnings.append(QStringLiteral("%1: %2").arg(journals[journal], message));
+                }
+                reader.close();
+                readerOpen = false;
+            }
+            if (++journal >= journals.size()) {
+                return false;
+            }
+            QString message;
+            readerOpen = reader.open(journals[journal], message);
+            if (!readerOpen) {
+                warnings.append(message);
+            }
+        }
+    };
+    const auto warn = [&](const ReplayGame &game, const QString &message) {
+        QMutexLocker locker(&readerMutex);
+        warnings.append(QStringLiteral("game %1: %2").arg(game.id).arg(message));
+    };
+
+    // The start cache is not thread-safe, so every encoder gets its own.
+    const int threads = encoderCount(options, std::numeric_limits<int>::max());
+    std::vector<ReplayStartCache> caches(threads);
+
+    const auto encodeNext = [&](int encoder, SampleWriter &writer, FeatureExportStats &local) {
+        ReplayGame game;
+        if (!takeGame(game)) {
+            return false;
+        }
+        QString message;
+        PackedState state;
+        const PackedBoard *board = caches[encoder].start(game, state, message);
+        if (board == nullptr || !boardFitsFeatures(*board, message)) {
+            warn(game, message);
+            return true;
+        }
+        for (const ReplayAction &action : game.actions) {
+            writer.addPosition(*board, state);
+            if (!applyReplayAction(*board, state, action, message)) {
+                warn(game, message);
+                writer.discardGame();
+                return true;
+            }
+        }
+        writer.finishGame(state.status);
+        addOutcome(local, state.status);
+        return true;
+    };
+    return runExport(threads, options, path, encodeNext, stats, errorMessage);
+}
+
+} // namespace model
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "SelfPlay.h"
+#include "../ai/Features.h"
+#include "../replay/ReplayJournal.h"
+
+namespace model {
+
+enum class FeaturePolicy {
+    // Uniform-random legal actions.
+    Random,
+    // Both sides play searchBestAction() at a fixed depth.
+    Search
+};
+
+enum class FeatureFormat : quint8 {
+    Int8,
+    Float32
+};
+
+struct FeatureExportOptions {
+    // Self-play only; journal games are replayed as recorded.
+    FeaturePolicy policy{FeaturePolicy::Random};
+    int searchDepth{1};
+    qint64 games{1000};
+    int maxTurns{400};
+    quint64 seed{1};
+
+    FeatureFormat format{FeatureFormat::Int8};
+    // Samples per chunk in the output file.
+    int chunkSamples{4096};
+    // Encoding threads; 0 uses all cores. The calling thread writes.
+    int threads{0};
+};
+
+struct FeatureExportStats {
+    qint64 games{0};
+    qint64 samples{0};
+    qint64 winsA{0};
+    qint64 winsB{0};
+    qint64 unfinished{0};
+    qint64 bytes{0};
+    qint64 elapsedMs{0};
+};
+
+// Dataset file (".udft"): a 32-byte header
+//   "UDFT", u16 version, u8 format, u8 reserved,
+//   u16 planes, u16 rows, u16 cols, u16 scalars, 16 reserved bytes
+// followed by chunks of u32 sample count, u32 payload bytes and the samples.
+// A sample is kFeatureCount feature values and one label, all int8 or all
+// little-endian float32: the final result for the side to move in that
+// position, +1 win, -1 loss, 0 unfinished. Samples are the positions before
+// every action. Games are encoded in parallel, so their order in the file is
+// not fixed. A game's positions are in order and contiguous within a chunk,
+// but a game that fills one chunk continues in that encoder's next chunk,
+// and chunks from other encoders may be written in between.
+constexpr int kFeatureFileVersion = 1;
+
+// Plays options.games games, cycling through the openings with decks
+// reshuffled for every game.
+bool exportSelfPlayFeatures(const QVector<SelfPlayOpening> &openings,
+                            const FeatureExportOptions &options,
+                            const QString &path,
+                            FeatureExportStats &stats,
+                            QString &errorMessage);
+
+// Replays the games of `journals`, streamed one game at a time so memory does
+// not grow with the journals. Games that fail to replay, and damaged journal
+// records, are skipped with a message in `warnings`; a journal that cannot
+// be opened fails the export before anything is written.
+bool exportJournalFeatures(const QStringList &journals,
+                           const FeatureExportOptions &options,
+                           const QString &path,
+                           FeatureExportStats &stats,
+                           QStringList &warnings,
+                           QString &errorMessage);
+
+} // namespace model
@@ -0,0 +1,256 @@
+#include "Perft.h"
+
+#include "../actions/Combat.h"
+#include "../actions/LegalActions.h"
+#include "../actions/Movement.h"
+#include "../agents/AgentBehavior.h"
+#include "../model/Init.h"
+#include "../turn/TurnSystem.h"
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <utility>
+#include <vector>
+
+namespace model {
+
+namespace {
+
+struct PerftChild {
+    QString label;
+    GameState state;
+};
+
+void resizeCounts(PerftCounts &counts, int depth)
+{
+    counts.nodes.fill(0, depth);
+    counts.terminal.fill(0, depth);
+}
+
+void addCounts(PerftCounts &into, const PerftCounts &from)
+{
+    for (int i = 0; i < into.nodes.size(); ++i) {
+        into.nodes[i] += from.nodes[i];
+        into.terminal[i] += from.terminal[i];
+    }
+}
+
+// endTurn() + drawTurnCard(), optionally branching on the drawn card type.
+bool finishTurn(GameState state,
+                const QString &label,
+                bool branchDraws,
+                std::vector<PerftChild> &children,
+                QString &errorMessage)
+{
+    if (state.status != GameStatus::InProgress) {
+        children.push_back(PerftChild{label, std::move(state)});
+        return true;
+    }
+
+    if (!endTurn(state, errorMessage)) {
+        errorMessage = QStringLiteral("%1: %2").arg(label, errorMessage);
+        return false;
+    }
+
+    const PlayerState *next = playerById(state, state.turn.currentPlayer);
+    if (!branchDraws || next->deck.drawPile.isEmpty()) {
+        // An empty deck leaves the turn without a card; such a node has no children.
+        Card drawn{};
+        QString drawError;
+        drawTurnCard(state, drawn, drawError);
+        children.push_back(PerftChild{label, std::move(state)});
+        return true;
+    }
+
+    QVector<AgentType> seen;
+    for (int i = 0; i < next->deck.drawPile.size(); ++i) {
+        const AgentType type = next->deck.drawPile[i].agent;
+        if (seen.contains(type)) {
+            continue;
+        }
+        seen.push_back(type);
+
+        GameState branch = cloneGameState(state);
+        PlayerState *player = playerById(branch, branch.turn.currentPlayer);
+        player->deck.drawPile.move(i, 0);
+
+        Card drawn{};
+        if (!drawTurnCard(branch, drawn, errorMessage)) {
+            errorMessage = QStringLiteral("%1: %2").arg(label, errorMessage);
+            return false;
+        }
+        children.push_back(PerftChild{QStringLiteral("%1 | draw %2").arg(label, agentTypeName(type)),
+                                      std::move(branch)});
+    }
+    return true;
+}
+
+bool applyAttackOutcome(const GameState &state,
+                        const GameAction &action,
+                        bool hit,
+                        bool branchDraws,
+                        std::vector<PerftChild> &children,
+                        QString &errorMessage)
+{
+    const PlayerId owner = state.turn.currentPlayer;
+    const AgentType type = state.turn.activeCard.agent;
+    const int diceCount = behaviorFor(type)->attackDiceCount();
+    const QString label = QStringLiteral("%1 %2").arg(actionText(action),
+                                                      hit ? QStringLiteral("hit") : QStringLiteral("miss"));
+
+    GameState child = cloneGameState(state);
+    const AttackResult result = attackWithRolls(child, owner, type, action.cellId,
+                                                QVector<int>(diceCount, hit ? 10 : 1));
+    if (!result.executed || result.success != hit) {
+        errorMessage = QStringLiteral("%1: %2").arg(label, result.errorMessage.isEmpty()
+                                                               ? QStringLiteral("unexpected attack outcome")
+                                                               : result.errorMessage);
+        return false;
+    }
+    return finishTurn(std::move(child), label, branchDraws, children, errorMessage);
+}
+
+bool expand(const GameState &state, bool branchDraws, std::vector<PerftChild> &children, QString &errorMessage)
+{
+    const PlayerId owner = state.turn.currentPlayer;
+    const AgentType type = state.turn.activeCard.agent;
+
+    for (const GameAction &action : legalActions(state)) {
+        if (action.kind == ActionKind::Attack) {
+            const int threshold = attackThreshold(state, owner, type, action.cellId, errorMessage);
+            if (threshold <= 0) {
+                errorMessage = QStringLiteral("%1: %2").arg(actionText(action), errorMessage);
+                return false;
+            }
+            if (!applyAttackOutcome(state, action, true, branchDraws, children, errorMessage)) {
+                return false;
+            }
+            if (threshold > 1 && !applyAttackOutcome(state, action, false, branchDraws, children, errorMessage)) {
+                return false;
+            }
+            continue;
+        }
+
+        GameState child = cloneGameState(state);
+        bool ok = false;
+        if (action.kind == ActionKind::Move) {
+            ok = moveAgent(child, owner, type, action.cellId, errorMessage);
+        } else {
+            ok = behaviorFor(type)->executeSpecial(child, owner, action.special, errorMessage);
+        }
+        if (!ok) {
+            errorMessage = QStringLiteral("%1: %2").arg(actionText(action), errorMessage);
+            return false;
+        }
+        if (!finishTurn(std::move(child), actionText(action), branchDraws, children, errorMessage)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool countNodes(const GameState &state,
+                int ply,
+                int depth,
+                bool branchDraws,
+                PerftCounts &counts,
+                QString &errorMessage)
+{
+    std::vector<PerftChild> children;
+    if (!expand(state, branchDraws, children, errorMessage)) {
+        return false;
+    }
+
+    counts.nodes[ply] += static_cast<qint64>(children.size());
+    for (const PerftChild &child : children) {
+        if (child.state.status != GameStatus::InProgress) {
+            ++counts.terminal[ply];
+            continue;
+        }
+        if (ply + 1 < depth && !countNodes(child.state, ply + 1, depth, branchDraws, counts, errorMessage)) {
+            errorMessage = QStringLiteral("%1 > %2").arg(child.label, errorMessage);
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+bool runPerft(const GameState &state,
+              const PerftOptions &options,
+              PerftResult &result,
+              QString &errorMessage)
+{
+    if (options.depth < 1) {
+        errorMessage = QStringLiteral("Perft depth must be at least 1.");
+        return false;
+    }
+    if (state.status != GameStatus::InProgress || !state.turn.hasActiveCard) {
+        errorMessage = QStringLiteral("Perft needs an in-progress game with an active card.");
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    result = PerftResult{};
+    resizeCounts(result.total, options.depth);
+
+    std::vector<PerftChild> roots;
+    if (!expand(state, options.branchDraws, roots, errorMessage)) {
+        return false;
+    }
+
+    result.branches.resize(static_cast<int>(roots.size()));
+    for (int i = 0; i < result.branches.size(); ++i) {
+        PerftBranch &branch = result.branches[i];
+        branch.label = roots[i].label;
+        resizeCounts(branch.counts, options.depth);
+        branch.counts.nodes[0] = 1;
+        if (roots[i].state.status != GameStatus::InProgress) {
+            branch.counts.terminal[0] = 1;
+        }
+    }
+
+    QMutex errorMutex;
+    QString firstError;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    if (options.depth > 1) {
+        for (int i = 0; i < result.branches.size(); ++i) {
+            if (roots[i].state.status != GameStatus::InProgress) {
+                continue;
+            }
+            pool.start([&, i]() {
+                QString error;
+                if (!countNodes(roots[i].state, 1, options.depth, options.branchDraws,
+                                result.branches[i].counts, error)) {
+                    QMutexLocker locker(&errorMutex);
+                    if (firstError.isEmpty()) {
+                        firstError = QStringLiteral("%1 > %2").arg(roots[i].label, error);
+                    }
+                }
+            });
+        }
+        pool.waitForDone();
+    }
+
+    if (!firstError.isEmpty()) {
+        errorMessage = firstError;
+        return false;
+    }
+
+    for (const PerftBranch &branch : result.branches) {
+        addCounts(result.total, branch.counts);
+    }
+    result.elapsedNs = timer.nsecsElapsed();
+    return true;
+}
+
+} // namespace model
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "../model/Types.h"
+
+namespace model {
+
+struct PerftOptions {
+    int depth{3};
+    // Worker threads for the root split; 0 uses QThread::idealThreadCount().
+    int threads{0};
+    // Branch on every distinct card type left in the next player's deck
+    // instead of drawing the known top card.
+    bool branchDraws{false};
+};
+
+struct PerftCounts {
+    // Index d holds action sequences of length d + 1.
+    QVector<qint64> nodes;
+    // Of those, the sequences whose last action ended the game.
+    QVector<qint64> terminal;
+};
+
+struct PerftBranch {
+    QString label;
+    PerftCounts counts;
+};
+
+struct PerftResult {
+    PerftCounts total;
+    // One entry per root child, in generation order ("divide" output).
+    QVector<PerftBranch> branches;
+    qint64 elapsedNs{0};
+};
+
+// Enumerates every legal action sequence up to options.depth plies through
+// the real rules engine. Attacks branch into labelled "hit" and "miss"
+// outcomes (miss only when the threshold allows it); with branchDraws the
+// turn card draw after each action branches as well. Returns false if the
+// engine rejects an action that legalActions() produced.
+bool runPerft(const GameState &state,
+              const PerftOptions &options,
+              PerftResult &result,
+              QString &errorMessage);
+
+} // namespace model
@@ -0,0 +1,99 @@
+#include "SelfPlay.h"
+
+#include "../ai/Evaluation.h"
+#include "../session/GameSession.h"
+
+#include <QFileInfo>
+
+#include <algorithm>
+
+namespace model {
+
+bool loadSelfPlayOpening(const QString &boardPath,
+                         const QString &scenarioPath,
+                         quint32 setupSeed,
+                         SelfPlayOpening &out,
+                         QString &errorMessage)
+{
+    GameState state;
+    GameSession session(state);
+    session.setSeed(setupSeed);
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), boardPath, scenarioPath, true, errorMessage)) {
+        return false;
+    }
+
+    auto board = std::make_shared<PackedBoard>();
+    PackedState start;
+    if (!buildPackedBoard(state.board, *board, errorMessage) ||
+        !packGameState(state, *board, start, errorMessage)) {
+        return false;
+    }
+
+    out.name = QFileInfo(scenarioPath).completeBaseName();
+    out.setupSeed = setupSeed;
+    out.board = std::move(board);
+    out.start = start;
+    return true;
+}
+
+void reshufflePackedDecks(PackedState &state, QRandomGenerator &rng)
+{
+    PackedSide &current = state.sides[state.currentSide];
+    if (state.hasActiveCard) {
+        std::copy_backward(current.deck.begin(), current.deck.begin() + current.deckSize,
+                           current.deck.begin() + current.deckSize + 1);
+        current.deck[0] = state.activeCard;
+        ++current.deckSize;
+        ++current.cardCount[state.activeCard];
+        state.hasActiveCard = false;
+    }
+
+    for (PackedSide &side : state.sides) {
+        for (int i = side.deckSize - 1; i > 0; --i) {
+            std::swap(side.deck[i], side.deck[rng.bounded(i + 1)]);
+        }
+    }
+    drawPackedCard(state);
+}
+
+SelfPlayResult playSelfPlayGame(const SelfPlayOpening &opening,
+                                const SearchOptions &playerA,
+                                const SearchOptions &playerB,
+                                quint32 seed,
+                                int maxTurns)
+{
+    const PackedBoard &board = *opening.board;
+    PackedState state = opening.start;
+    QRandomGenerator dice(seed);
+
+    SelfPlayResult result;
+    while (state.status == GameStatus::InProgress && result.turns < maxTurns) {
+        const SearchOptions &player = state.currentSide == 0 ? playerA : playerB;
+        const SearchInfo info = searchBestAction(board, state, player);
+        if (!info.hasAction) {
+            break;
+        }
+
+        bool hit = false;
+        if (info.action.kind == PackedActionKind::Attack) {
+            const int threshold = packedAttackThreshold(board, state, info.action);
+            const int chance = attackHitChance(packedAttackDice(state.activeCard), threshold);
+            hit = int(dice.bounded(1000)) < chance;
+        }
+        applyPackedAction(board, state, info.action, hit);
+        ++result.turns;
+
+        if (state.status != GameStatus::InProgress) {
+            break;
+        }
+        endPackedTurn(state);
+        if (!drawPackedCard(state)) {
+            break;
+        }
+    }
+
+    result.status = state.status;
+    return result;
+}
+
+} // namespace model
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "../ai/Search.h"
+
+#include <QRandomGenerator>
+
+#include <memory>
+
+namespace model {
+
+// A scenario start position, packed once and shared by every game played
+// from it. The deck order comes from setupSeed, so a (scenario, setupSeed)
+// pair always gives the same opening.
+struct SelfPlayOpening {
+    QString name;
+    quint32 setupSeed{1};
+    std::shared_ptr<const PackedBoard> board;
+    PackedState start;
+};
+
+bool loadSelfPlayOpening(const QString &boardPath,
+                         const QString &scenarioPath,
+                         quint32 setupSeed,
+                         SelfPlayOpening &out,
+                         QString &errorMessage);
+
+// Puts the active card back on top of the mover's deck, shuffles both decks
+// and draws again, as a fresh battle with a different setup seed would.
+void reshufflePackedDecks(PackedState &state, QRandomGenerator &rng);
+
+struct SelfPlayResult {
+    // InProgress if the game hit maxTurns or the side to move had no action.
+    GameStatus status{GameStatus::InProgress};
+    int turns{0};
+};
+
+// Plays one game between two search configurations, playerA moving for A.
+// Attack dice come from `seed` and nothing else is random, so with timeMs
+// large enough for maxDepth to complete the game is fully reproducible.
+SelfPlayResult playSelfPlayGame(const SelfPlayOpening &opening,
+                                const SearchOptions &playerA,
+                                const SearchOptions &playerB,
+                                quint32 seed,
+                                int maxTurns);
+
+} // namespace model
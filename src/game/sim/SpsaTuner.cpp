@@ -0,0 +1,323 @@
+#include "SpsaTuner.h"
+
+#include "../ai/Evaluation.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QRandomGenerator>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+namespace model {
+
+namespace {
+
+// Long enough that every depth up to SpsaOptions::depth completes, which
+// keeps games reproducible from their seeds.
+constexpr qint64 kUntimedMs = 3600 * 1000;
+
+quint32 iterationSeed(quint32 seed, int iteration)
+{
+    quint64 x = (quint64(seed) << 32) ^ quint64(iteration);
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return static_cast<quint32>(x ^ (x >> 31));
+}
+
+EvalWeights roundedWeights(const QVector<double> &values)
+{
+    QVector<int> rounded;
+    for (double value : values) {
+        rounded.append(std::max(0, static_cast<int>(std::lround(value))));
+    }
+    return evalWeightsFromValues(rounded);
+}
+
+// Stored options by checkpoint name; each run continues only with the same
+// values.
+const struct {
+    const char *name;
+    int SpsaOptions::*value;
+} kIntOptions[] = {
+    {"pairs", &SpsaOptions::gamePairs},
+    {"depth", &SpsaOptions::depth},
+    {"max_turns", &SpsaOptions::maxTurns},
+    {"setups", &SpsaOptions::setups},
+};
+
+const struct {
+    const char *name;
+    double SpsaOptions::*value;
+} kDoubleOptions[] = {
+    {"rate", &SpsaOptions::learningRate},
+    {"stability", &SpsaOptions::stability},
+    {"alpha", &SpsaOptions::alpha},
+    {"gamma", &SpsaOptions::gamma},
+    {"perturbation", &SpsaOptions::perturbation},
+};
+
+} // namespace
+
+SpsaState startSpsa(const EvalWeights &initial, quint32 seed, const SpsaOptions &options)
+{
+    SpsaState state;
+    state.seed = seed;
+    state.options = options;
+    state.keys = evalWeightKeys();
+    for (int value : evalWeightValues(initial)) {
+        state.theta.append(value);
+        state.scale.append(std::max(1.0, options.perturbation * std::abs(value)));
+    }
+    return state;
+}
+
+EvalWeights spsaWeights(const SpsaState &state)
+{
+    return roundedWeights(state.theta);
+}
+
+SpsaIteration runSpsaIteration(const QVector<SelfPlayOpening> &openings,
+                               const SpsaOptions &options,
+                               SpsaState &state)
+{
+    SpsaIteration record;
+    record.iteration = state.history.size() + 1;
+    record.seed = iterationSeed(state.seed, record.iteration);
+
+    const int k = record.iteration - 1;
+    const double stepSize = options.learningRate / std::pow(k + 1 + options.stability, options.alpha);
+    const double perturbation = 1.0 / std::pow(k + 1, options.gamma);
+
+    QRandomGenerator rng(record.seed);
+    const int count = state.theta.size();
+    QVector<int> delta(count);
+    QVector<double> plus(count);
+    QVector<double> minus(count);
+    for (int i = 0; i < count; ++i) {
+        delta[i] = rng.bounded(2) == 0 ? -1 : 1;
+        plus[i] = state.theta[i] + perturbation * state.scale[i] * delta[i];
+        minus[i] = state.theta[i] - perturbation * state.scale[i] * delta[i];
+    }
+
+    SearchOptions plusPlayer;
+    plusPlayer.weights = roundedWeights(plus);
+    plusPlayer.maxDepth = options.depth;
+    plusPlayer.timeMs = kUntimedMs;
+    SearchOptions minusPlayer = plusPlayer;
+    minusPlayer.weights = roundedWeights(minus);
+
+    // Game 2p has the plus candidate as A, game 2p + 1 as B.
+    const int pairs = std::max(1, options.gamePairs);
+    QVector<SelfPlayResult> results(pairs * 2);
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    for (int game = 0; game < results.size(); ++game) {
+        pool.start([&, game]() {
+            const int pair = game / 2;
+            const SelfPlayOpening &opening = openings[(k * pairs + pair) % openings.size()];
+            const quint32 diceSeed = record.seed + quint32(pair);
+            results[game] = game % 2 == 0
+                ? playSelfPlayGame(opening, plusPlayer, minusPlayer, diceSeed, options.maxTurns)
+                : playSelfPlayGame(opening, minusPlayer, plusPlayer, diceSeed, options.maxTurns);
+        });
+    }
+    pool.waitForDone();
+
+    for (int game = 0; game < results.size(); ++game) {
+        const GameStatus status = results[game].status;
+        if (status == GameStatus::InProgress) {
+            ++record.draws;
+            continue;
+        }
+        const bool plusWasA = game % 2 == 0;
+        const bool aWon = status == GameStatus::WonByA;
+        if (aWon == plusWasA) {
+            ++record.plusWins;
+        } else {
+            ++record.minusWins;
+        }
+    }
+
+    // Score difference in [-1, 1]; the gradient estimate along delta is
+    // difference / (2 * perturbation), preconditioned by scale^2.
+    const double difference = double(record.plusWins - record.minusWins) / results.size();
+    for (int i = 0; i < count; ++i) {
+        state.theta[i] += stepSize * difference * state.scale[i] * delta[i] / (2.0 * perturbation);
+        state.theta[i] = std::max(0.0, state.theta[i]);
+    }
+
+    state.history.append(record);
+    return record;
+}
+
+QStringList spsaOptionDifferences(const SpsaOptions &a, const SpsaOptions &b)
+{
+    QStringList names;
+    for (const auto &option : kIntOptions) {
+        if (a.*option.value != b.*option.value) {
+            names.append(QString::fromLatin1(option.name));
+        }
+    }
+    for (const auto &option : kDoubleOptions) {
+        if (a.*option.value != b.*option.value) {
+            names.append(QString::fromLatin1(option.name));
+        }
+    }
+    return names;
+}
+
+bool spsaOpeningsDigest(const QStringList &files, QString &digest, QString &errorMessage)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &path : files) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            errorMessage = QStringLiteral("Cannot open %1").arg(path);
+            return false;
+        }
+        // Length-prefixed, so moving bytes between files changes the digest.
+        const QByteArray bytes = file.readAll();
+        hash.addData(QByteArray::number(bytes.size()) + ':');
+        hash.addData(bytes);
+    }
+    digest = QString::fromLatin1(hash.result().toHex());
+    return true;
+}
+
+// Text format, one record per line:
+//   seed: <run seed>
+//   openings: <spsaOpeningsDigest()>
+//   option: <name> <value>
+//   param: <key> <theta> <scale>
+//   iteration: <n> <seed> <plus wins> <minus wins> <draws>
+bool saveSpsaCheckpoint(const QString &path, const SpsaState &state, QString &errorMessage)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorMessage = QStringLiteral("Cannot write checkpoint: %1").arg(path);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "# undaunted-tune checkpoint\n";
+    out << "seed: " << state.seed << '\n';
+    out << "openings: " << state.openings << '\n';
+    for (const auto &option : kIntOptions) {
+        out << "option: " << option.name << ' ' << state.options.*option.value << '\n';
+    }
+    for (const auto &option : kDoubleOptions) {
+        out << "option: " << option.name << ' ' << QString::number(state.options.*option.value, 'g', 17) << '\n';
+    }
+    for (int i = 0; i < state.keys.size(); ++i) {
+        out << "param: " << state.keys[i] << ' ' << QString::number(state.theta[i], 'g', 17)
+            << ' ' << QString::number(state.scale[i], 'g', 17) << '\n';
+    }
+    for (const SpsaIteration &record : state.history) {
+        out << "iteration: " << record.iteration << ' ' << record.seed << ' ' << record.plusWins
+            << ' ' << record.minusWins << ' ' << record.draws << '\n';
+    }
+    out.flush();
+
+    if (!file.commit()) {
+        errorMessage = QStringLiteral("Failed to write checkpoint: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+bool loadSpsaCheckpoint(const QString &path, SpsaState &state, QString &errorMessage)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errorMessage = QStringLiteral("Cannot open checkpoint: %1").arg(path);
+        return false;
+    }
+
+    SpsaState loaded;
+    QTextStream in(&file);
+    int lineNo = 0;
+    bool hasSeed = false;
+    QStringList optionsSeen;
+
+    while (!in.atEnd()) {
+        ++lineNo;
+        const QString rawLine = in.readLine().section(QLatin1Char('#'), 0, 0).trimmed();
+        if (rawLine.isEmpty()) {
+            continue;
+        }
+
+        const int sep = rawLine.indexOf(QLatin1Char(':'));
+        const QString key = sep > 0 ? rawLine.left(sep).trimmed() : QString();
+        const QStringList fields = rawLine.mid(sep + 1).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        bool ok = sep > 0;
+
+        if (key == QLatin1String("seed") && fields.size() == 1) {
+            loaded.seed = fields[0].toUInt(&ok);
+            hasSeed = ok;
+        } else if (key == QLatin1String("openings") && fields.size() == 1 && loaded.openings.isEmpty()) {
+            loaded.openings = fields[0];
+        } else if (key == QLatin1String("option") && fields.size() == 2 && !optionsSeen.contains(fields[0])) {
+            ok = false;
+            for (const auto &option : kIntOptions) {
+                if (fields[0] == QLatin1String(option.name)) {
+                    loaded.options.*option.value = fields[1].toInt(&ok);
+                }
+            }
+            for (const auto &option : kDoubleOptions) {
+                if (fields[0] == QLatin1String(option.name)) {
+                    loaded.options.*option.value = fields[1].toDouble(&ok);
+                }
+            }
+            optionsSeen.append(fields[0]);
+        } else if (key == QLatin1String("param") && fields.size() == 3) {
+            bool scaleOk = false;
+            loaded.keys.append(fields[0]);
+            loaded.theta.append(fields[1].toDouble(&ok));
+            loaded.scale.append(fields[2].toDouble(&scaleOk));
+            ok = ok && scaleOk;
+        } else if (key == QLatin1String("iteration") && fields.size() == 5) {
+            SpsaIteration record;
+            int values[5] = {};
+            for (int i = 0; i < 5 && ok; ++i) {
+                values[i] = static_cast<int>(fields[i].toUInt(&ok));
+            }
+            record.iteration = values[0];
+            record.seed = static_cast<quint32>(fields[1].toUInt());
+            record.plusWins = values[2];
+            record.minusWins = values[3];
+            record.draws = values[4];
+            ok = ok && record.iteration == loaded.history.size() + 1;
+            loaded.history.append(record);
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            errorMessage = QStringLiteral("Invalid checkpoint line %1: %2").arg(lineNo).arg(rawLine);
+            return false;
+        }
+    }
+
+    if (!hasSeed || loaded.keys != evalWeightKeys()) {
+        errorMessage = QStringLiteral("Checkpoint %1 does not match the evaluation weights.").arg(path);
+        return false;
+    }
+    if (loaded.openings.isEmpty() ||
+        optionsSeen.size() != int(std::size(kIntOptions) + std::size(kDoubleOptions))) {
+        errorMessage = QStringLiteral("Checkpoint %1 does not record the run options.").arg(path);
+        return false;
+    }
+
+    state = loaded;
+    return true;
+}
+
+} // namespace model
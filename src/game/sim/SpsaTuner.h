@@ -0,0 +1,71 @@
+#pragma once
+
+#include "SelfPlay.h"
+
+namespace model {
+
+struct SpsaOptions {
+    // Each pair is two games from the same opening and dice seed with the
+    // seats swapped, so neither candidate profits from a lucky side.
+    int gamePairs{16};
+    int depth{2};
+    int maxTurns{300};
+    // Deck shuffles (setup seeds 1..setups) per scenario in the opening set.
+    int setups{4};
+    // Worker threads for the games of one iteration; 0 uses all cores.
+    int threads{0};
+    // Step size a / (k + 1 + A)^alpha and perturbation c / (k + 1)^gamma,
+    // both in units of each weight's scale.
+    double learningRate{4.0};
+    double stability{10.0};
+    double alpha{0.602};
+    double gamma{0.101};
+    // Scale of weight i: max(1, perturbation * |initial value|).
+    double perturbation{0.1};
+};
+
+struct SpsaIteration {
+    int iteration{0};
+    // All randomness of the iteration (perturbation signs and dice) derives
+    // from this seed.
+    quint32 seed{0};
+    int plusWins{0};
+    int minusWins{0};
+    int draws{0};
+};
+
+// Everything needed to continue a run; written to and read from checkpoints.
+struct SpsaState {
+    quint32 seed{1};
+    // The options the run was started with. threads is not stored; it does
+    // not change the results.
+    SpsaOptions options;
+    // spsaOpeningsDigest() of the scenario and board files played.
+    QString openings;
+    QStringList keys;
+    QVector<double> theta;
+    QVector<double> scale;
+    QVector<SpsaIteration> history;
+};
+
+SpsaState startSpsa(const EvalWeights &initial, quint32 seed, const SpsaOptions &options);
+EvalWeights spsaWeights(const SpsaState &state);
+
+// Plays one iteration (2 * gamePairs games) on a thread pool, moves theta
+// and appends the iteration to state.history.
+SpsaIteration runSpsaIteration(const QVector<SelfPlayOpening> &openings,
+                               const SpsaOptions &options,
+                               SpsaState &state);
+
+// Names of the stored options that differ between a and b (threads is
+// ignored), e.g. {"depth", "rate"}; empty when a run may continue with b.
+QStringList spsaOptionDifferences(const SpsaOptions &a, const SpsaOptions &b);
+
+// SHA-1 over the contents of `files`, in order. Checkpoints store it so a run
+// is only resumed on the openings it started with.
+bool spsaOpeningsDigest(const QStringList &files, QString &digest, QString &errorMessage);
+
+bool saveSpsaCheckpoint(const QString &path, const SpsaState &state, QString &errorMessage);
+bool loadSpsaCheckpoint(const QString &path, SpsaState &state, QString &errorMessage);
+
+} // namespace model
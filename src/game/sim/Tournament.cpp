@@ -0,0 +1,233 @@
+#include "Tournament.h"
+
+#include "../ai/Evaluation.h"
+
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <cmath>
+
+namespace model {
+
+namespace {
+
+// Elo points per natural-log logit unit (400 / ln 10).
+constexpr double kEloScale = 400.0 / 2.302585092994046;
+// Prior: ratings ~ N(0, (400 Elo)^2), which only matters for bots that
+// won or lost everything.
+constexpr double kPriorPrecision = 1.0 / ((400.0 / kEloScale) * (400.0 / kEloScale));
+constexpr int kRatingSweeps = 200;
+
+quint32 dealSeed(quint32 seed, int map, int round, int pair)
+{
+    quint64 x = (quint64(seed) << 32) ^ (quint64(map) << 24) ^ (quint64(round) << 12) ^ quint64(pair);
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return static_cast<quint32>(x ^ (x >> 31));
+}
+
+double scoreForA(const SelfPlayResult &result)
+{
+    if (result.status == GameStatus::WonByA) {
+        return 1.0;
+    }
+    if (result.status == GameStatus::WonByB) {
+        return 0.0;
+    }
+    return 0.5;
+}
+
+double logistic(double x)
+{
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+} // namespace
+
+bool parseBotConfig(const QString &spec, BotConfig &out, QString &errorMessage)
+{
+    BotConfig config;
+    for (const QString &part : spec.split(QLatin1Char(','), Qt::SkipEmptyParts)) {
+        const int sep = part.indexOf(QLatin1Char('='));
+        if (sep <= 0) {
+            errorMessage = QStringLiteral("Invalid bot option: %1").arg(part);
+            return false;
+        }
+
+        const QString key = part.left(sep).trimmed().toLower();
+        const QString value = part.mid(sep + 1).trimmed();
+        bool ok = true;
+        if (key == QLatin1String("name")) {
+            config.name = value;
+        } else if (key == QLatin1String("weights")) {
+            if (!loadEvalWeights(config.search.weights, value, errorMessage)) {
+                return false;
+            }
+        } else if (key == QLatin1String("net")) {
+            auto network = std::make_shared<EvalNetwork>();
+            if (!network->load(value, errorMessage)) {
+                return false;
+            }
+            config.search.network = std::move(network);
+        } else if (key == QLatin1String("depth")) {
+            config.search.maxDepth = value.toInt(&ok);
+            ok = ok && config.search.maxDepth > 0;
+        } else if (key == QLatin1String("time")) {
+            config.search.timeMs = value.toLongLong(&ok);
+            ok = ok && config.search.timeMs > 0;
+        } else {
+            errorMessage = QStringLiteral("Unknown bot option: %1").arg(key);
+            return false;
+        }
+
+        if (!ok) {
+            errorMessage = QStringLiteral("Invalid value for bot option %1: %2").arg(key, value);
+            return false;
+        }
+    }
+
+    if (config.name.isEmpty()) {
+        errorMessage = QStringLiteral("Bot needs a name: %1").arg(spec);
+        return false;
+    }
+    out = config;
+    return true;
+}
+
+bool checkBotMaps(const QVector<SelfPlayOpening> &maps, const QVector<BotConfig> &bots, QString &errorMessage)
+{
+    for (const BotConfig &bot : bots) {
+        if (!bot.search.network) {
+            continue;
+        }
+        for (const SelfPlayOpening &map : maps) {
+            if (!boardFitsFeatures(*map.board, errorMessage)) {
+                errorMessage = QStringLiteral("Bot %1 cannot use its network on %2: %3").arg(bot.name, map.name, errorMessage);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+QVector<TournamentGame> runTournament(const QVector<SelfPlayOpening> &maps,
+                                      const QVector<BotConfig> &bots,
+                                      const TournamentOptions &options,
+                                      const TournamentProgressFn &onProgress)
+{
+    QVector<TournamentGame> games;
+    int pair = 0;
+    for (int first = 0; first < bots.size(); ++first) {
+        for (int second = first + 1; second < bots.size(); ++second, ++pair) {
+            for (int map = 0; map < maps.size(); ++map) {
+                for (int round = 0; round < options.rounds; ++round) {
+                    const quint32 seed = dealSeed(options.seed, map, round, pair);
+                    games.append(TournamentGame{map, round, first, second, seed, SelfPlayResult{}});
+                    games.append(TournamentGame{map, round, second, first, seed, SelfPlayResult{}});
+                }
+            }
+        }
+    }
+
+    QMutex progressMutex;
+    int finished = 0;
+
+    QThreadPool pool;
+    pool.setMaxThreadCount(options.threads > 0 ? options.threads : QThread::idealThreadCount());
+    for (int index = 0; index < games.size(); ++index) {
+        pool.start([&, index]() {
+            TournamentGame &game = games[index];
+            QRandomGenerator rng(game.seed);
+            SelfPlayOpening deal = maps[game.map];
+            reshufflePackedDecks(deal.start, rng);
+            game.result = playSelfPlayGame(deal, bots[game.botA].search, bots[game.botB].search,
+                                           rng.generate(), options.maxTurns);
+
+            QMutexLocker locker(&progressMutex);
+            ++finished;
+            if (onProgress) {
+                onProgress(finished, games.size());
+            }
+        });
+    }
+    pool.waitForDone();
+    return games;
+}
+
+double tournamentScore(const TournamentGame &game, int bot)
+{
+    if (game.botA == bot) {
+        return scoreForA(game.result);
+    }
+    if (game.botB == bot) {
+        return 1.0 - scoreForA(game.result);
+    }
+    return -1.0;
+}
+
+TournamentRatings rateTournament(const QVector<TournamentGame> &games, int botCount)
+{
+    QVector<double> rating(botCount, 0.0);
+    double firstMove = 0.0;
+
+    // Coordinate-wise Newton steps on the log posterior; it is concave, so
+    // this converges without a step-size schedule.
+    QVector<double> curvature(botCount, kPriorPrecision);
+    for (int sweep = 0; sweep < kRatingSweeps; ++sweep) {
+        for (int bot = 0; bot < botCount; ++bot) {
+            double gradient = -kPriorPrecision * rating[bot];
+            double hessian = kPriorPrecision;
+            for (const TournamentGame &game : games) {
+                if (game.botA != bot && game.botB != bot) {
+                    continue;
+                }
+                const double p = logistic(rating[game.botA] - rating[game.botB] + firstMove);
+                const double residual = scoreForA(game.result) - p;
+                gradient += game.botA == bot ? residual : -residual;
+                hessian += p * (1.0 - p);
+            }
+            rating[bot] += gradient / hessian;
+            curvature[bot] = hessian;
+        }
+
+        double gradient = -kPriorPrecision * firstMove;
+        double hessian = kPriorPrecision;
+        for (const TournamentGame &game : games) {
+            const double p = logistic(rating[game.botA] - rating[game.botB] + firstMove);
+            gradient += scoreForA(game.result) - p;
+            hessian += p * (1.0 - p);
+        }
+        firstMove += gradient / hessian;
+    }
+
+    double mean = 0.0;
+    for (double value : rating) {
+        mean += value;
+    }
+    mean /= std::max(1, botCount);
+
+    TournamentRatings ratings;
+    ratings.firstMoveElo = firstMove * kEloScale;
+    ratings.bots.resize(botCount);
+    for (int bot = 0; bot < botCount; ++bot) {
+        BotRating &entry = ratings.bots[bot];
+        entry.elo = (rating[bot] - mean) * kEloScale;
+        entry.error = 1.96 / std::sqrt(curvature[bot]) * kEloScale;
+        double total = 0.0;
+        for (const TournamentGame &game : games) {
+            const double score = tournamentScore(game, bot);
+            if (score >= 0.0) {
+                total += score;
+                ++entry.games;
+            }
+        }
+        entry.score = entry.games > 0 ? total / entry.games : 0.0;
+    }
+    return ratings;
+}
+
+} // namespace model
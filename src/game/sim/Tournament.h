@@ -0,0 +1,73 @@
+#pragma once
+
+#include "SelfPlay.h"
+
+#include <functional>
+
+namespace model {
+
+struct BotConfig {
+    QString name;
+    SearchOptions search;
+};
+
+// Parses "name=tuned,weights=path.txt,depth=6,time=200"; every key except
+// name is optional and defaults to SearchOptions. time is per move in ms;
+// net=path.udnn evaluates with a network instead of the weights.
+bool parseBotConfig(const QString &spec, BotConfig &out, QString &errorMessage);
+
+// Fails if a bot's network cannot encode one of the maps.
+bool checkBotMaps(const QVector<SelfPlayOpening> &maps, const QVector<BotConfig> &bots, QString &errorMessage);
+
+struct TournamentOptions {
+    // Deals per bot pair and map; each deal is played twice with the seats
+    // swapped and the same decks and dice.
+    int rounds{2};
+    int maxTurns{300};
+    // Games played at once; 0 uses all cores.
+    int threads{0};
+    quint32 seed{1};
+};
+
+struct TournamentGame {
+    int map{0};
+    int round{0};
+    int botA{0};
+    int botB{0};
+    quint32 seed{0};
+    SelfPlayResult result;
+};
+
+struct BotRating {
+    double elo{0.0};
+    // 95% interval half-width.
+    double error{0.0};
+    int games{0};
+    double score{0.0};
+};
+
+struct TournamentRatings {
+    QVector<BotRating> bots;
+    // Rating bonus of moving first (side A), fitted with the bot ratings.
+    double firstMoveElo{0.0};
+};
+
+using TournamentProgressFn = std::function<void(int finished, int total)>;
+
+// Plays every scheduled game on a thread pool. Games are independent, so
+// results are identical for any thread count when bots are depth-limited;
+// time-limited bots depend on machine load like any timed match.
+QVector<TournamentGame> runTournament(const QVector<SelfPlayOpening> &maps,
+                                      const QVector<BotConfig> &bots,
+                                      const TournamentOptions &options,
+                                      const TournamentProgressFn &onProgress = TournamentProgressFn());
+
+// Bayesian Bradley-Terry fit (Elo scale, mean 0) with a first-move term
+// and a weak prior that keeps unbeaten bots finite. Unfinished games count
+// as draws.
+TournamentRatings rateTournament(const QVector<TournamentGame> &games, int botCount);
+
+// Score of bot `bot` in `game` (1, 1/2 or 0), or -1 if it did not play.
+double tournamentScore(const TournamentGame &game, int bot);
+
+} // namespace model
@@ -9,15 +9,14 @@ namespace model {
 namespace {
 
 template <typename T>
-void shuffleVector(QVector<T> &values)
+void shuffleVector(QVector<T> &values, QRandomGenerator &rng)
 {
     if (values.size() <= 1) {
         return;
     }
 
-    auto *rng = QRandomGenerator::global();
     for (int i = values.size() - 1; i > 0; --i) {
-        const int j = rng->bounded(i + 1);
+        const int j = rng.bounded(i + 1);
         if (i != j) {
             values.swapItemsAt(i, j);
         }
@@ -28,7 +27,12 @@ void shuffleVector(QVector<T> &values)
 
 void shuffleDeck(DeckState &deck)
 {
-    shuffleVector(deck.drawPile);
+    shuffleDeck(deck, *QRandomGenerator::global());
+}
+
+void shuffleDeck(DeckState &deck, QRandomGenerator &rng)
+{
+    shuffleVector(deck.drawPile, rng);
 }
 
 void shufflePlayerDeck(PlayerState &player)
@@ -36,10 +40,20 @@ void shufflePlayerDeck(PlayerState &player)
     shuffleDeck(player.deck);
 }
 
+void shufflePlayerDeck(PlayerState &player, QRandomGenerator &rng)
+{
+    shuffleDeck(player.deck, rng);
+}
+
 void shuffleAllDecks(GameState &state)
 {
-    shufflePlayerDeck(state.playerA);
-    shufflePlayerDeck(state.playerB);
+    shuffleAllDecks(state, *QRandomGenerator::global());
+}
+
+void shuffleAllDecks(GameState &state, QRandomGenerator &rng)
+{
+    shufflePlayerDeck(state.playerA, rng);
+    shufflePlayerDeck(state.playerB, rng);
 }
 
 bool drawTurnCard(GameState &state, Card &drawnCard, QString &errorMessage)
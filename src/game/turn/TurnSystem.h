@@ -2,11 +2,16 @@
 
 #include "../model/Types.h"
 
+class QRandomGenerator;
+
 namespace model {
 
 void shuffleDeck(DeckState &deck);
+void shuffleDeck(DeckState &deck, QRandomGenerator &rng);
 void shufflePlayerDeck(PlayerState &player);
+void shufflePlayerDeck(PlayerState &player, QRandomGenerator &rng);
 void shuffleAllDecks(GameState &state);
+void shuffleAllDecks(GameState &state, QRandomGenerator &rng);
 
 bool drawTurnCard(GameState &state, Card &drawnCard, QString &errorMessage);
 bool endTurn(GameState &state, QString &errorMessage);
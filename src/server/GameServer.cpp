@@ -0,0 +1,201 @@
+#include "GameServer.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QLocalServer>
+#include <QMetaObject>
+#include <QTcpServer>
+#include <QThread>
+
+#include <functional>
+
+namespace {
+
+// The stock servers wrap accepted sockets in objects owned by the listening
+// thread; these hand out the raw descriptor so a worker can own the socket.
+class TcpListener : public QTcpServer
+{
+public:
+    std::function<void(qintptr)> onConnection;
+
+protected:
+    void incomingConnection(qintptr descriptor) override
+    {
+        onConnection(descriptor);
+    }
+};
+
+class LocalListener : public QLocalServer
+{
+public:
+    std::function<void(quintptr)> onConnection;
+
+protected:
+    void incomingConnection(quintptr descriptor) override
+    {
+        onConnection(descriptor);
+    }
+};
+
+} // namespace
+
+GameServer::GameServer(const GameServerOptions &options, QObject *parent)
+    : QObject(parent),
+      context(std::make_unique<ServerContext>())
+{
+    context->options = options;
+}
+
+GameServer::~GameServer()
+{
+    delete tcpServer;
+    delete localServer;
+
+    // Workers (and the connections parented to them) are deleted on their
+    // own threads once the event loops exit.
+    for (QThread *thread : threads) {
+        thread->quit();
+    }
+    for (QThread *thread : threads) {
+        thread->wait();
+        delete thread;
+    }
+}
+
+bool GameServer::start(QString &errorMessage)
+{
+    if (!threads.isEmpty()) {
+        return true;
+    }
+
+    const QDir assets(context->options.assetsDir);
+    const QFileInfoList scenarios = QDir(assets.filePath(QStringLiteral("maps")))
+                                        .entryInfoList({QStringLiteral("*.txt")}, QDir::Files, QDir::Name);
+    for (const QFileInfo &scenario : scenarios) {
+        const QString board = assets.filePath(QStringLiteral("boards/") + scenario.fileName());
+        if (QFileInfo::exists(board)) {
+            context->maps.insert(scenario.completeBaseName(), qMakePair(board, scenario.filePath()));
+        }
+    }
+    if (context->maps.isEmpty()) {
+        errorMessage = QStringLiteral("No maps with a matching board in %1").arg(assets.absolutePath());
+        return false;
+    }
+
+    const int count = context->options.workers > 0 ? context->options.workers : QThread::idealThreadCount();
+    context->workers = count;
+
+    if (!context->options.journalDir.isEmpty()) {
+        const QDir journalDir(context->options.journalDir);
+        if (!journalDir.mkpath(QStringLiteral("."))) {
+            errorMessage = QStringLiteral("Cannot create journal directory: %1").arg(context->options.journalDir);
+            return false;
+        }
+        // Game ids restart with every run, so each run gets its own files.
+        const QString stamp = QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"));
+        for (int i = 0; i < count; ++i) {
+            auto journal = std::make_unique<model::ReplayJournal>();
+            if (!journal->open(journalDir.filePath(QStringLiteral("games-%1-w%2.udrj").arg(stamp).arg(i)), errorMessage)) {
+                journals.clear();
+                return false;
+            }
+            journals.push_back(std::move(journal));
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        auto *thread = new QThread;
+        thread->setObjectName(QStringLiteral("undaunted-worker-%1").arg(i));
+        auto *worker = new QObject;
+        worker->moveToThread(thread);
+        connect(thread, &QThread::finished, worker, &QObject::deleteLater);
+        thread->start();
+        threads.append(thread);
+        workers.append(worker);
+    }
+    return true;
+}
+
+bool GameServer::listenTcp(const QHostAddress &address, quint16 port, QString &errorMessage)
+{
+    auto *listener = new TcpListener;
+    listener->onConnection = [this](qintptr descriptor) {
+        dispatch(descriptor, false);
+    };
+    if (!listener->listen(address, port)) {
+        errorMessage = QStringLiteral("Cannot listen on %1:%2: %3").arg(address.toString()).arg(port).arg(listener->errorString());
+        delete listener;
+        return false;
+    }
+    delete tcpServer;
+    tcpServer = listener;
+    return true;
+}
+
+bool GameServer::listenLocal(const QString &name, QString &errorMessage)
+{
+    auto *listener = new LocalListener;
+    listener->onConnection = [this](quintptr descriptor) {
+        dispatch(static_cast<qintptr>(descriptor), true);
+    };
+    // A previous server that crashed leaves its socket file behind.
+    QLocalServer::removeServer(name);
+    if (!listener->listen(name)) {
+        errorMessage = QStringLiteral("Cannot listen on %1: %2").arg(name, listener->errorString());
+        delete listener;
+        return false;
+    }
+    delete localServer;
+    localServer = listener;
+    return true;
+}
+
+quint16 GameServer::tcpPort() const
+{
+    return tcpServer != nullptr ? tcpServer->serverPort() : 0;
+}
+
+int GameServer::workerCount() const
+{
+    return workers.size();
+}
+
+QStringList GameServer::mapNames() const
+{
+    QStringList names = context->maps.keys();
+    names.sort();
+    return names;
+}
+
+GameServerStats GameServer::stats() const
+{
+    const GameServerCounters &counters = context->counters;
+    GameServerStats stats;
+    stats.connections = counters.connections.load();
+    stats.sessions = counters.sessions.load();
+    stats.frames = counters.frames.load();
+    stats.bytesIn = counters.bytesIn.load();
+    stats.bytesOut = counters.bytesOut.load();
+    stats.pausedConnections = counters.pausedConnections.load();
+    return stats;
+}
+
+void GameServer::dispatch(qintptr descriptor, bool local)
+{
+    if (workers.isEmpty()) {
+        qWarning("undaunted-server: connection before start(); dropped");
+        return;
+    }
+
+    QObject *worker = workers[nextWorker];
+    model::ReplayJournal *journal = journals.empty() ? nullptr : journals[nextWorker].get();
+    nextWorker = (nextWorker + 1) % workers.size();
+    ServerContext *shared = context.get();
+    QMetaObject::invokeMethod(
+        worker,
+        [worker, shared, journal, descriptor, local]() {
+            new ServerConnection(descriptor, local, *shared, journal, worker);
+        },
+        Qt::QueuedConnection);
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <QHostAddress>
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+
+#include "ServerConnection.h"
+
+#include <memory>
+#include <vector>
+
+class QLocalServer;
+class QTcpServer;
+class QThread;
+
+struct GameServerStats {
+    qint64 connections{0};
+    qint64 sessions{0};
+    qint64 frames{0};
+    qint64 bytesIn{0};
+    qint64 bytesOut{0};
+    qint64 pausedConnections{0};
+};
+
+// Hosts GameSessions for many clients over TCP and/or a local socket. The
+// listeners run on the caller's thread and hand each accepted socket to the
+// next worker thread (round robin); the connection and all sessions it
+// creates stay on that worker, one event loop per core.
+class GameServer : public QObject
+{
+public:
+    explicit GameServer(const GameServerOptions &options, QObject *parent = nullptr);
+    ~GameServer() override;
+
+    // Scans the maps and starts the workers; call before listening.
+    bool start(QString &errorMessage);
+    bool listenTcp(const QHostAddress &address, quint16 port, QString &errorMessage);
+    bool listenLocal(const QString &name, QString &errorMessage);
+
+    quint16 tcpPort() const;
+    int workerCount() const;
+    QStringList mapNames() const;
+    GameServerStats stats() const;
+
+private:
+    void dispatch(qintptr descriptor, bool local);
+
+    std::unique_ptr<ServerContext> context;
+    QVector<QThread *> threads;
+    QVector<QObject *> workers;
+    // One per worker, only touched on that worker's thread.
+    std::vector<std::unique_ptr<model::ReplayJournal>> journals;
+    int nextWorker{0};
+    QTcpServer *tcpServer = nullptr;
+    QLocalServer *localServer = nullptr;
+};
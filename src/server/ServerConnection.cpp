@@ -0,0 +1,329 @@
+#include "ServerConnection.h"
+
+#include <QLocalSocket>
+#include <QTcpSocket>
+
+ServerConnection::ServerConnection(qintptr descriptor,
+                                   bool local,
+                                   ServerContext &context,
+                                   model::ReplayJournal *journal,
+                                   QObject *parent)
+    : QObject(parent),
+      context(context),
+      journal(journal)
+{
+    ++context.counters.connections;
+
+    bool attached = false;
+    if (local) {
+        auto *localSocket = new QLocalSocket(this);
+        localSocket->setReadBufferSize(context.options.readBufferBytes);
+        connect(localSocket, &QLocalSocket::disconnected, this, &QObject::deleteLater);
+        attached = localSocket->setSocketDescriptor(descriptor);
+        socket = localSocket;
+    } else {
+        auto *tcpSocket = new QTcpSocket(this);
+        tcpSocket->setReadBufferSize(context.options.readBufferBytes);
+        connect(tcpSocket, &QAbstractSocket::disconnected, this, &QObject::deleteLater);
+        attached = tcpSocket->setSocketDescriptor(descriptor);
+        // Replies are small and latency-bound; don't let Nagle batch them.
+        tcpSocket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        socket = tcpSocket;
+    }
+
+    if (!attached) {
+        qWarning("undaunted-server: cannot attach socket: %s", qPrintable(socket->errorString()));
+        dropped = true;
+        deleteLater();
+        return;
+    }
+
+    connect(socket, &QIODevice::readyRead, this, &ServerConnection::readFrames);
+    connect(socket, &QIODevice::bytesWritten, this, &ServerConnection::writtenBytes);
+}
+
+ServerConnection::~ServerConnection()
+{
+    for (auto &entry : sessions) {
+        archive(*entry.second);
+    }
+    context.counters.sessions -= static_cast<qint64>(sessions.size());
+    if (paused) {
+        --context.counters.pausedConnections;
+    }
+    --context.counters.connections;
+}
+
+void ServerConnection::readFrames()
+{
+    if (paused || dropped) {
+        return;
+    }
+
+    const QByteArray incoming = socket->readAll();
+    context.counters.bytesIn += incoming.size();
+    inbox.append(incoming);
+
+    int offset = 0;
+    QByteArray payload;
+    while (!paused) {
+        const model::WireFrameStatus status = model::takeWireFrame(inbox, offset, payload);
+        if (status == model::WireFrameStatus::Incomplete) {
+            break;
+        }
+        if (status == model::WireFrameStatus::Oversized) {
+            drop(QStringLiteral("Frame too large."));
+            return;
+        }
+
+        ++context.counters.frames;
+        if (!handleFrame(payload)) {
+            return;
+        }
+
+        // Backpressure: a client that sends faster than it reads gets no
+        // further replies queued until it has drained what it already has.
+        if (socket->bytesToWrite() > context.options.highWatermark) {
+            paused = true;
+            ++context.counters.pausedConnections;
+        }
+    }
+    inbox.remove(0, offset);
+}
+
+void ServerConnection::writtenBytes()
+{
+    if (paused && socket->bytesToWrite() <= context.options.lowWatermark) {
+        paused = false;
+        --context.counters.pausedConnections;
+        readFrames();
+    }
+}
+
+bool ServerConnection::handleFrame(const QByteArray &payload)
+{
+    model::WireReader reader(payload);
+    switch (reader.type()) {
+    case model::WireMessage::Hello: {
+        const quint16 version = reader.u16();
+        if (!reader.ok() || version != model::kWireVersion) {
+            drop(QStringLiteral("Unsupported protocol version: %1").arg(version));
+            return false;
+        }
+        model::WireWriter writer(model::WireMessage::Welcome);
+        writer.u16(model::kWireVersion);
+        writer.u16(static_cast<quint16>(context.workers));
+        send(writer);
+        return true;
+    }
+    case model::WireMessage::CreateSession:
+        return handleCreate(reader);
+    case model::WireMessage::CloseSession:
+        return handleClose(reader);
+    case model::WireMessage::Legal:
+        return handleLegal(reader);
+    case model::WireMessage::Action:
+        return handleAction(reader);
+    default:
+        break;
+    }
+
+    drop(QStringLiteral("Unknown message type: %1").arg(static_cast<int>(reader.type())));
+    return false;
+}
+
+bool ServerConnection::handleCreate(model::WireReader &reader)
+{
+    const quint32 request = reader.u32();
+    const quint32 seed = reader.u32();
+    const QString map = reader.string();
+    if (!reader.ok() || !reader.atEnd()) {
+        drop(QStringLiteral("Malformed CreateSession message."));
+        return false;
+    }
+
+    const auto paths = context.maps.constFind(map);
+    if (paths == context.maps.cend()) {
+        sendError(request, QStringLiteral("Unknown map: %1").arg(map));
+        return true;
+    }
+    if (static_cast<int>(sessions.size()) >= context.options.maxSessionsPerConnection) {
+        sendError(request, QStringLiteral("Session limit reached (%1).").arg(context.options.maxSessionsPerConnection));
+        return true;
+    }
+
+    auto hosted = std::make_unique<HostedSession>();
+    hosted->session.setSeed(seed);
+    QString errorMessage;
+    if (!hosted->session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), paths->first, paths->second, true,
+                                             errorMessage)) {
+        sendError(request, errorMessage);
+        return true;
+    }
+    if (journal != nullptr) {
+        if (hosted->recorder.beginGame(context.nextGameId++, hosted->session, paths->first, paths->second, errorMessage)) {
+            hosted->session.setRecorder(&hosted->recorder);
+        } else {
+            qWarning("undaunted-server: not recording session: %s", qPrintable(errorMessage));
+        }
+    }
+    hosted->cellIndex = model::wireCellIndex(hosted->state.board);
+    model::captureWireSnapshot(hosted->state, hosted->cellIndex, hosted->sent);
+
+    const quint32 sessionId = nextSessionId++;
+    model::WireWriter writer(model::WireMessage::SessionCreated);
+    writer.u32(request);
+    writer.u32(sessionId);
+    writer.u16(static_cast<quint16>(hosted->state.board.cells.size()));
+    for (const auto &cell : hosted->state.board.cells) {
+        writer.string(cell->id);
+    }
+    model::writeWireDelta(writer, model::WireSnapshot{}, hosted->sent);
+
+    sessions.emplace(sessionId, std::move(hosted));
+    ++context.counters.sessions;
+    send(writer);
+    return true;
+}
+
+bool ServerConnection::handleClose(model::WireReader &reader)
+{
+    const quint32 request = reader.u32();
+    const quint32 sessionId = reader.u32();
+    if (!reader.ok() || !reader.atEnd()) {
+        drop(QStringLiteral("Malformed CloseSession message."));
+        return false;
+    }
+
+    const auto found = sessions.find(sessionId);
+    if (found == sessions.end()) {
+        sendError(request, QStringLiteral("Unknown session: %1").arg(sessionId));
+        return true;
+    }
+    archive(*found->second);
+    sessions.erase(found);
+    --context.counters.sessions;
+
+    model::WireWriter writer(model::WireMessage::SessionClosed);
+    writer.u32(request);
+    writer.u32(sessionId);
+    send(writer);
+    return true;
+}
+
+bool ServerConnection::handleLegal(model::WireReader &reader)
+{
+    const quint32 request = reader.u32();
+    const quint32 sessionId = reader.u32();
+    if (!reader.ok() || !reader.atEnd()) {
+        drop(QStringLiteral("Malformed Legal message."));
+        return false;
+    }
+
+    HostedSession *hosted = findSession(request, sessionId);
+    if (hosted == nullptr) {
+        return true;
+    }
+
+    const QVector<model::GameAction> actions = model::legalActions(hosted->state);
+    model::WireWriter writer(model::WireMessage::LegalActions);
+    writer.u32(request);
+    writer.u32(sessionId);
+    writer.u16(static_cast<quint16>(actions.size()));
+    for (const model::GameAction &action : actions) {
+        model::writeWireAction(writer, action, hosted->cellIndex);
+    }
+    send(writer);
+    return true;
+}
+
+bool ServerConnection::handleAction(model::WireReader &reader)
+{
+    const quint32 request = reader.u32();
+    const quint32 sessionId = reader.u32();
+    if (!reader.ok()) {
+        drop(QStringLiteral("Malformed Action message."));
+        return false;
+    }
+
+    HostedSession *hosted = findSession(request, sessionId);
+    if (hosted == nullptr) {
+        return true;
+    }
+
+    model::GameAction action;
+    QString errorMessage;
+    if (!model::readWireAction(reader, hosted->state.board, action, errorMessage)) {
+        if (!reader.ok()) {
+            drop(QStringLiteral("Malformed Action message."));
+            return false;
+        }
+        sendError(request, errorMessage);
+        return true;
+    }
+
+    const model::CommandResult result = model::executeAction(hosted->session, action);
+    model::WireWriter writer(model::WireMessage::ActionResult);
+    writer.u32(request);
+    writer.u32(sessionId);
+    writer.u8(result.ok ? 1 : 0);
+    if (result.ok) {
+        // The delta says everything the success message would.
+        model::WireSnapshot current;
+        model::captureWireSnapshot(hosted->state, hosted->cellIndex, current);
+        model::writeWireDelta(writer, hosted->sent, current);
+        hosted->sent = std::move(current);
+    } else {
+        writer.string(result.message);
+    }
+    send(writer);
+    return true;
+}
+
+ServerConnection::HostedSession *ServerConnection::findSession(quint32 request, quint32 sessionId)
+{
+    const auto found = sessions.find(sessionId);
+    if (found == sessions.end()) {
+        sendError(request, QStringLiteral("Unknown session: %1").arg(sessionId));
+        return nullptr;
+    }
+    return found->second.get();
+}
+
+void ServerConnection::archive(HostedSession &hosted)
+{
+    if (journal == nullptr || !hosted.recorder.isRecording()) {
+        return;
+    }
+    hosted.session.setRecorder(nullptr);
+    QString errorMessage;
+    if (!journal->append(hosted.recorder.finishGame(hosted.state), errorMessage)) {
+        qWarning("undaunted-server: %s", qPrintable(errorMessage));
+    }
+}
+
+void ServerConnection::send(const model::WireWriter &writer)
+{
+    const QByteArray frame = writer.frame();
+    socket->write(frame);
+    context.counters.bytesOut += frame.size();
+}
+
+void ServerConnection::sendError(quint32 request, const QString &message)
+{
+    model::WireWriter writer(model::WireMessage::Error);
+    writer.u32(request);
+    writer.string(message);
+    send(writer);
+}
+
+void ServerConnection::drop(const QString &reason)
+{
+    if (dropped) {
+        return;
+    }
+    dropped = true;
+    sendError(0, reason);
+    // close() flushes the error first; the disconnected signal then deletes us.
+    socket->close();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <QHash>
+#include <QObject>
+#include <QPair>
+#include <QString>
+
+#include "game/GameModel.h"
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+class QIODevice;
+
+struct GameServerOptions {
+    // Directory holding boards/ and maps/ (same layout as src/assets).
+    QString assetsDir;
+    // Worker threads, each with its own event loop; 0 uses all cores.
+    int workers{0};
+    int maxSessionsPerConnection{1024};
+    // A connection stops reading requests once this many reply bytes are
+    // queued and resumes below the low watermark.
+    qint64 highWatermark{1 << 20};
+    qint64 lowWatermark{256 << 10};
+    // Kernel-side read buffer per socket, so a paused client is throttled by
+    // TCP flow control instead of growing server memory.
+    qint64 readBufferBytes{256 << 10};
+    // When set, every session is recorded into a replay journal here, one
+    // file per worker.
+    QString journalDir;
+};
+
+struct GameServerCounters {
+    std::atomic<qint64> connections{0};
+    std::atomic<qint64> sessions{0};
+    std::atomic<qint64> frames{0};
+    std::atomic<qint64> bytesIn{0};
+    std::atomic<qint64> bytesOut{0};
+    std::atomic<qint64> pausedConnections{0};
+};
+
+// Shared by every worker; only the counters change after startup.
+struct ServerContext {
+    GameServerOptions options;
+    int workers{1};
+    // Map name -> (board path, scenario path).
+    QHash<QString, QPair<QString, QString>> maps;
+    GameServerCounters counters;
+    std::atomic<quint64> nextGameId{1};
+};
+
+// One client socket and the game sessions it created. Lives on a worker
+// thread for its whole life, so its sessions need no locking. journal may be
+// null; otherwise it belongs to the same worker and finished games go there.
+class ServerConnection : public QObject
+{
+public:
+    ServerConnection(qintptr descriptor, bool local, ServerContext &context, model::ReplayJournal *journal, QObject *parent);
+    ~ServerConnection() override;
+
+private:
+    struct HostedSession {
+        model::GameState state;
+        model::GameSession session{state};
+        QHash<QString, int> cellIndex;
+        // Last state the client was sent; replies carry the difference.
+        model::WireSnapshot sent;
+        model::ReplayRecorder recorder;
+    };
+
+    void readFrames();
+    void writtenBytes();
+    bool handleFrame(const QByteArray &payload);
+    bool handleCreate(model::WireReader &reader);
+    bool handleClose(model::WireReader &reader);
+    bool handleLegal(model::WireReader &reader);
+    bool handleAction(model::WireReader &reader);
+    HostedSession *findSession(quint32 request, quint32 sessionId);
+    void archive(HostedSession &hosted);
+    void send(const model::WireWriter &writer);
+    void sendError(quint32 request, const QString &message);
+    void drop(const QString &reason);
+
+    QIODevice *socket = nullptr;
+    ServerContext &context;
+    model::ReplayJournal *journal = nullptr;
+    QByteArray inbox;
+    bool paused{false};
+    bool dropped{false};
+    std::unordered_map<quint32, std::unique_ptr<HostedSession>> sessions;
+    quint32 nextSessionId{1};
+};
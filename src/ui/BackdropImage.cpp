@@ -0,0 +1,109 @@
+#include "BackdropImage.h"
+
+#include <QFileInfo>
+#include <QPainter>
+#include <QWidget>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+// Quiet time after the last resize before the smooth rescale starts.
+constexpr int kSettleMs = 150;
+
+QImage decodeFirst(const QStringList &candidates)
+{
+    for (const QString &path : candidates) {
+        if (!QFileInfo::exists(path)) {
+            continue;
+        }
+        QImage image(path);
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+    return QImage();
+}
+
+} // namespace
+
+BackdropImage::BackdropImage(QWidget *target)
+    : target(target)
+{
+    settleTimer.setSingleShot(true);
+    settleTimer.setInterval(kSettleMs);
+    QObject::connect(&settleTimer, &QTimer::timeout, target, [this]() { rescale(); });
+
+    QObject::connect(&decodeWatcher, &QFutureWatcher<QImage>::finished, target, [this]() {
+        source = decodeWatcher.result();
+        smoothSize = QSize();
+        if (source.isNull()) {
+            return;
+        }
+        // A quick scale to show something now; the smooth one follows.
+        const qreal ratio = this->target->devicePixelRatioF();
+        scaled = QPixmap::fromImage(source.scaled(wantedSize(), Qt::KeepAspectRatioByExpanding, Qt::FastTransformation));
+        scaled.setDevicePixelRatio(ratio);
+        this->target->update();
+        rescale();
+    });
+
+    QObject::connect(&scaleWatcher, &QFutureWatcher<QImage>::finished, target, [this]() {
+        const QImage image = scaleWatcher.result();
+        if (image.isNull()) {
+            return;
+        }
+        scaled = QPixmap::fromImage(image);
+        scaled.setDevicePixelRatio(this->target->devicePixelRatioF());
+        this->target->update();
+    });
+}
+
+void BackdropImage::load(const QStringList &candidates)
+{
+    decodeWatcher.setFuture(QtConcurrent::run([candidates]() { return decodeFirst(candidates); }));
+}
+
+void BackdropImage::resized()
+{
+    if (!source.isNull()) {
+        settleTimer.start();
+    }
+}
+
+bool BackdropImage::paint(QPainter &painter, const QRect &rect) const
+{
+    if (scaled.isNull()) {
+        return false;
+    }
+
+    // The scaled copy covers its size with the image's aspect ratio; show
+    // its centre at the aspect ratio of `rect`.
+    const QSizeF crop = QSizeF(rect.size() * scaled.devicePixelRatio()).scaled(scaled.size(), Qt::KeepAspectRatio);
+    const QRectF sourceRect(QPointF((scaled.width() - crop.width()) / 2.0, (scaled.height() - crop.height()) / 2.0), crop);
+
+    // Once the smooth rescale for this size is in, this is a 1:1 copy; until
+    // then the old copy is stretched with the fast transform.
+    painter.save();
+    painter.setRenderHint(QPainter::SmoothPixmapTransform, false);
+    painter.drawPixmap(QRectF(rect), scaled, sourceRect);
+    painter.restore();
+    return true;
+}
+
+QSize BackdropImage::wantedSize() const
+{
+    return target->size() * target->devicePixelRatioF();
+}
+
+void BackdropImage::rescale()
+{
+    const QSize size = wantedSize();
+    if (source.isNull() || size == smoothSize) {
+        return;
+    }
+    smoothSize = size;
+    const QImage image = source;
+    scaleWatcher.setFuture(QtConcurrent::run([image, size]() {
+        return image.scaled(size, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
+    }));
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QFutureWatcher>
+#include <QImage>
+#include <QPixmap>
+#include <QStringList>
+#include <QTimer>
+
+class QPainter;
+class QWidget;
+
+// Full-window background picture for the splash and login screens. The file
+// is found and decoded on a worker thread, so construction never waits for
+// it; the owner paints its gradient until paint() succeeds. While the window
+// is being resized the last scaled copy is stretched with a fast transform,
+// and one smooth rescale (also on a worker) runs after the size settles.
+class BackdropImage
+{
+public:
+    explicit BackdropImage(QWidget *target);
+
+    // Decodes the first readable file among `candidates`.
+    void load(const QStringList &candidates);
+    // Call from the target's resizeEvent.
+    void resized();
+    // Draws the image cropped to fill `rect`; false while none is decoded.
+    bool paint(QPainter &painter, const QRect &rect) const;
+
+private:
+    QSize wantedSize() const;
+    void rescale();
+
+    QWidget *target;
+    QImage source;
+    QPixmap scaled;
+    // Size of the last smooth rescale started, to skip repeats.
+    QSize smoothSize;
+    QTimer settleTimer;
+    QFutureWatcher<QImage> decodeWatcher;
+    QFutureWatcher<QImage> scaleWatcher;
+};
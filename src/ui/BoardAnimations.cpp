@@ -0,0 +1,175 @@
+#include "BoardAnimations.h"
+
+#include "BoardGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr qint64 kMoveMs = 220;
+constexpr qint64 kTracerMs = 280;
+constexpr qint64 kEliminationMs = 360;
+// Tracer trail length in hex radii.
+constexpr qreal kTrailRadii = 1.6;
+
+qreal easeOut(qreal t)
+{
+    const qreal rest = 1.0 - t;
+    return 1.0 - rest * rest * rest;
+}
+
+qreal segmentLength(const QPointF &a, const QPointF &b)
+{
+    return std::hypot(b.x() - a.x(), b.y() - a.y());
+}
+
+// Point at `distance` along the polyline through `points`.
+QPointF pointAlong(const QVector<QPointF> &points, qreal distance)
+{
+    for (int i = 1; i < points.size(); ++i) {
+        const qreal length = segmentLength(points[i - 1], points[i]);
+        if (distance <= length && length > 0.0) {
+            return points[i - 1] + (points[i] - points[i - 1]) * (distance / length);
+        }
+        distance -= length;
+    }
+    return points.last();
+}
+
+// The part of the polyline between two distances, as its own polyline.
+QPolygonF trailBetween(const QVector<QPointF> &points, qreal from, qreal to)
+{
+    QPolygonF trail;
+    trail << pointAlong(points, from);
+    qreal walked = 0.0;
+    for (int i = 1; i < points.size(); ++i) {
+        walked += segmentLength(points[i - 1], points[i]);
+        if (walked > from && walked < to) {
+            trail << points[i];
+        }
+    }
+    trail << pointAlong(points, to);
+    return trail;
+}
+
+} // namespace
+
+void BoardAnimations::clear()
+{
+    effects.clear();
+    tokens.clear();
+    tracers.clear();
+    lastBounds.clear();
+}
+
+bool BoardAnimations::isEmpty() const
+{
+    return effects.isEmpty() && lastBounds.isEmpty();
+}
+
+void BoardAnimations::addMove(const Token &token, int fromCell, int toCell, qint64 now)
+{
+    effects.append(Effect{Kind::Move, now, kMoveMs, 0, {fromCell, toCell}, token, false});
+}
+
+void BoardAnimations::addAttack(const QVector<int> &path, bool hit, const std::optional<Token> &eliminated, qint64 now)
+{
+    const bool tracer = path.size() >= 2;
+    if (tracer) {
+        effects.append(Effect{Kind::Tracer, now, kTracerMs, 0, path, Token{}, hit});
+    }
+    if (eliminated.has_value() && !path.isEmpty()) {
+        const qint64 hold = tracer ? kTracerMs : 0;
+        effects.append(Effect{Kind::Elimination, now, hold + kEliminationMs, hold, {path.last()}, *eliminated, true});
+    }
+}
+
+bool BoardAnimations::hidesToken(int cell) const
+{
+    return std::any_of(effects.cbegin(), effects.cend(), [cell](const Effect &effect) {
+        return effect.kind == Kind::Move && effect.cells.last() == cell;
+    });
+}
+
+QRegion BoardAnimations::advance(const BoardGeometry &geometry, qint64 now)
+{
+    QRegion dirty;
+    for (const QRect &bounds : std::as_const(lastBounds)) {
+        dirty += bounds;
+    }
+    lastBounds.clear();
+    tokens.clear();
+    tracers.clear();
+
+    effects.erase(std::remove_if(effects.begin(), effects.end(),
+                                 [now](const Effect &effect) { return now >= effect.start + effect.duration; }),
+                  effects.end());
+    if (!geometry.isValid()) {
+        effects.clear();
+        return dirty;
+    }
+
+    const qreal radius = geometry.radius();
+    for (const Effect &effect : std::as_const(effects)) {
+        const qreal t = std::clamp(qreal(now - effect.start - effect.hold) / (effect.duration - effect.hold), 0.0, 1.0);
+
+        switch (effect.kind) {
+        case Kind::Move: {
+            const QPointF from = geometry.center(effect.cells.first());
+            const QPointF to = geometry.center(effect.cells.last());
+            const QPointF center = from + (to - from) * easeOut(t);
+            tokens.append(TokenFrame{center, effect.token, 1.0, 1.0});
+            lastBounds.append(tokenRect(center, radius).adjusted(-2, -2, 2, 2).toAlignedRect());
+            break;
+        }
+        case Kind::Tracer: {
+            QVector<QPointF> points;
+            points.reserve(effect.cells.size());
+            qreal length = 0.0;
+            for (const int cell : effect.cells) {
+                points.append(geometry.center(cell));
+                if (points.size() > 1) {
+                    length += segmentLength(points[points.size() - 2], points.last());
+                }
+            }
+            const qreal head = length * t;
+            const qreal tail = std::max(0.0, head - radius * kTrailRadii);
+            const QPolygonF trail = trailBetween(points, tail, head);
+            tracers.append(TracerFrame{trail, effect.hit});
+            const qreal margin = std::max(3.0, radius * 0.2);
+            lastBounds.append(trail.boundingRect().adjusted(-margin, -margin, margin, margin).toAlignedRect());
+            break;
+        }
+        case Kind::Elimination: {
+            const QPointF center = geometry.center(effect.cells.first());
+            const qreal scale = 1.0 + 0.4 * t;
+            tokens.append(TokenFrame{center, effect.token, scale, 1.0 - t});
+            lastBounds.append(tokenRect(center, radius, scale).adjusted(-2, -2, 2, 2).toAlignedRect());
+            break;
+        }
+        }
+    }
+
+    for (const QRect &bounds : std::as_const(lastBounds)) {
+        dirty += bounds;
+    }
+    return dirty;
+}
+
+const QVector<BoardAnimations::TokenFrame> &BoardAnimations::tokenFrames() const
+{
+    return tokens;
+}
+
+const QVector<BoardAnimations::TracerFrame> &BoardAnimations::tracerFrames() const
+{
+    return tracers;
+}
+
+QRectF BoardAnimations::tokenRect(const QPointF &center, qreal radius, qreal scale)
+{
+    // Tokens sit a little below the hex centre, under the cell id.
+    const qreal half = radius * 0.48 * scale;
+    return QRectF(center.x() - half, center.y() + radius * 0.18 - half, half * 2.0, half * 2.0);
+}
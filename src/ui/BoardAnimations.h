@@ -0,0 +1,82 @@
+#pragma once
+
+#include <QPointF>
+#include <QPolygonF>
+#include <QRect>
+#include <QRegion>
+#include <QVector>
+
+#include <optional>
+
+#include "game/GameModel.h"
+
+class BoardGeometry;
+
+// Short effects BoardView plays after an action: a token sliding to its new
+// cell, a tracer along the attack path and a fading token for an
+// elimination. They only draw over the board; the game state is final
+// before they start, so input and the engine never wait for them.
+class BoardAnimations
+{
+public:
+    struct Token {
+        model::PlayerId owner{model::PlayerId::None};
+        model::AgentType type{model::AgentType::Scout};
+    };
+    // Where to draw one animated token this frame (cell-centre coordinates).
+    struct TokenFrame {
+        QPointF center;
+        Token token;
+        qreal scale{1.0};
+        qreal opacity{1.0};
+    };
+    struct TracerFrame {
+        QPolygonF trail;
+        bool hit{false};
+    };
+
+    void clear();
+    bool isEmpty() const;
+
+    // Cells are BoardGeometry indices; `now` is in milliseconds.
+    void addMove(const Token &token, int fromCell, int toCell, qint64 now);
+    // `path` runs from the attacker's cell to the target. With `eliminated`
+    // the target's token stays until the tracer arrives, then fades out.
+    void addAttack(const QVector<int> &path, bool hit, const std::optional<Token> &eliminated, qint64 now);
+
+    // True while a token is still travelling to `cell`; its occupant must
+    // not be drawn there yet.
+    bool hidesToken(int cell) const;
+
+    // Moves every effect to `now`, drops finished ones and returns what to
+    // repaint: the previous frame's bounds and the new ones, nothing else.
+    QRegion advance(const BoardGeometry &geometry, qint64 now);
+    const QVector<TokenFrame> &tokenFrames() const;
+    const QVector<TracerFrame> &tracerFrames() const;
+
+    // Bounds of a token drawn at `scale` on the cell centred at `center`.
+    static QRectF tokenRect(const QPointF &center, qreal radius, qreal scale = 1.0);
+
+private:
+    enum class Kind {
+        Move,
+        Tracer,
+        Elimination
+    };
+    struct Effect {
+        Kind kind{Kind::Move};
+        qint64 start{0};
+        qint64 duration{0};
+        // Leading part of the duration during which the effect holds its
+        // first frame (an eliminated token waits for the tracer).
+        qint64 hold{0};
+        QVector<int> cells;
+        Token token;
+        bool hit{false};
+    };
+
+    QVector<Effect> effects;
+    QVector<TokenFrame> tokens;
+    QVector<TracerFrame> tracers;
+    QVector<QRect> lastBounds;
+};
@@ -0,0 +1,255 @@
+#include "BoardGeometry.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+const double kSqrt3 = std::sqrt(3.0);
+
+QPointF unitCenter(const model::CellNode &cell)
+{
+    return QPointF(cell.col * kSqrt3 + (cell.offset ? kSqrt3 / 2.0 : 0.0), cell.row * 1.5);
+}
+
+} // namespace
+
+void BoardGeometry::clear()
+{
+    centers.clear();
+    ids.clear();
+    indexById.clear();
+    hex = QPainterPath();
+    hexCorners.clear();
+    grid.clear();
+    rowOffset.clear();
+    gridRows = 0;
+    gridCols = 0;
+    hexRadius = 0.0;
+    valid = false;
+}
+
+void BoardGeometry::build(const model::BoardState &board,
+                          const QRectF &area,
+                          qreal devicePixelRatio,
+                          qreal zoom,
+                          const QPointF &pan)
+{
+    clear();
+    builtArea = area;
+    builtRatio = devicePixelRatio;
+    builtZoom = zoom;
+    builtPan = pan;
+    if (board.cells.empty()) {
+        return;
+    }
+
+    double minX = 1e9;
+    double maxX = -1e9;
+    double minY = 1e9;
+    double maxY = -1e9;
+    for (const auto &cell : board.cells) {
+        const QPointF u = unitCenter(*cell);
+        minX = std::min(minX, u.x());
+        maxX = std::max(maxX, u.x());
+        minY = std::min(minY, u.y());
+        maxY = std::max(maxY, u.y());
+    }
+
+    const double gridW = (maxX - minX) + kSqrt3;
+    const double gridH = (maxY - minY) + 2.0;
+    const QRectF inner = area.adjusted(18, 18, -18, -18);
+    boardUnits = QSizeF(gridW, gridH);
+    baseRadius = std::max(14.0, std::min(inner.width() / gridW, inner.height() / gridH));
+    hexRadius = baseRadius * zoom;
+    const QPointF middle((minX + maxX) * 0.5, (minY + maxY) * 0.5);
+    origin = inner.center() + pan - middle * hexRadius;
+
+    for (const auto &cell : board.cells) {
+        gridRows = std::max(gridRows, cell->row + 1);
+        gridCols = std::max(gridCols, cell->col + 1);
+    }
+    grid.fill(-1, gridRows * gridCols);
+    rowOffset.fill(false, gridRows);
+
+    int oddRowMatches = 0;
+    centers.reserve(static_cast<int>(board.cells.size()));
+    ids.reserve(static_cast<int>(board.cells.size()));
+    for (const auto &cell : board.cells) {
+        indexById.insert(cell->id, ids.size());
+        grid[cell->row * gridCols + cell->col] = ids.size();
+        rowOffset[cell->row] = cell->offset;
+        oddRowMatches += cell->offset == ((cell->row & 1) != 0) ? 1 : -1;
+        ids.append(cell->id);
+        centers.append(origin + unitCenter(*cell) * hexRadius);
+    }
+    oddRowsOffset = oddRowMatches >= 0;
+
+    hexCorners.reserve(6);
+    for (int i = 0; i < 6; ++i) {
+        const double angle = (60.0 * i - 30.0) * kPi / 180.0;
+        hexCorners << QPointF(hexRadius * std::cos(angle), hexRadius * std::sin(angle));
+    }
+    hex.addPolygon(hexCorners);
+    hex.closeSubpath();
+    valid = true;
+}
+
+bool BoardGeometry::isValid() const
+{
+    return valid;
+}
+
+bool BoardGeometry::matches(const QRectF &area, qreal devicePixelRatio, qreal zoom, const QPointF &pan) const
+{
+    return valid && builtArea == area && qFuzzyCompare(builtRatio, devicePixelRatio) && qFuzzyCompare(builtZoom, zoom) &&
+           builtPan == pan;
+}
+
+int BoardGeometry::cellCount() const
+{
+    return centers.size();
+}
+
+qreal BoardGeometry::radius() const
+{
+    return hexRadius;
+}
+
+qreal BoardGeometry::fitRadius() const
+{
+    return baseRadius;
+}
+
+QSizeF BoardGeometry::unitSize() const
+{
+    return boardUnits;
+}
+
+QPointF BoardGeometry::center(int index) const
+{
+    return centers[index];
+}
+
+const QString &BoardGeometry::cellId(int index) const
+{
+    return ids[index];
+}
+
+int BoardGeometry::indexOf(const QString &cellId) const
+{
+    return indexById.value(cellId, -1);
+}
+
+const QPainterPath &BoardGeometry::hexPath() const
+{
+    return hex;
+}
+
+const QPolygonF &BoardGeometry::hexPolygon() const
+{
+    return hexCorners;
+}
+
+QRectF BoardGeometry::hexBounds(int index) const
+{
+    return hexCorners.boundingRect().translated(centers[index]);
+}
+
+int BoardGeometry::cellAtGrid(int row, int col) const
+{
+    if (row < 0 || row >= gridRows || col < 0 || col >= gridCols) {
+        return -1;
+    }
+    return grid[row * gridCols + col];
+}
+
+bool BoardGeometry::hexContains(int index, const QPointF &point) const
+{
+    return hexCorners.containsPoint(point - centers[index], Qt::OddEvenFill);
+}
+
+int BoardGeometry::cellAt(const QPointF &point) const
+{
+    if (!valid) {
+        return -1;
+    }
+
+    // Pointy-top axial coordinates: x = sqrt3 * (q + r / 2), y = 1.5 * r,
+    // with the x shift that puts the board's offset rows on odd r.
+    const QPointF unit = (point - origin) / hexRadius;
+    const double x = unit.x() - (oddRowsOffset ? 0.0 : kSqrt3 / 2.0);
+    const double r = unit.y() / 1.5;
+    const double q = x / kSqrt3 - r / 2.0;
+    const double s = -q - r;
+
+    // Cube rounding: round all three, then fix the one that moved most.
+    double rq = std::round(q);
+    double rr = std::round(r);
+    const double rs = std::round(s);
+    const double dq = std::abs(rq - q);
+    const double dr = std::abs(rr - r);
+    const double ds = std::abs(rs - s);
+    if (dq > dr && dq > ds) {
+        rq = -rr - rs;
+    } else if (dr > ds) {
+        rr = -rq - rs;
+    }
+
+    const int row = static_cast<int>(rr);
+    if (row >= 0 && row < gridRows) {
+        const double centerX = kSqrt3 * (rq + rr / 2.0) + (oddRowsOffset ? 0.0 : kSqrt3 / 2.0);
+        const double shift = rowOffset[row] ? kSqrt3 / 2.0 : 0.0;
+        const int index = cellAtGrid(row, static_cast<int>(std::lround((centerX - shift) / kSqrt3)));
+        if (index >= 0 && hexContains(index, point)) {
+            return index;
+        }
+    }
+
+    // Ragged boards (rows whose offset breaks the lattice): the point can
+    // only be in a hex of the nearest row or the rows next to it.
+    const int nearRow = static_cast<int>(std::lround(unit.y() / 1.5));
+    for (int candidateRow = nearRow - 1; candidateRow <= nearRow + 1; ++candidateRow) {
+        if (candidateRow < 0 || candidateRow >= gridRows) {
+            continue;
+        }
+        const double shift = rowOffset[candidateRow] ? kSqrt3 / 2.0 : 0.0;
+        const int col = static_cast<int>(std::floor((unit.x() - shift) / kSqrt3));
+        for (int candidateCol = col; candidateCol <= col + 1; ++candidateCol) {
+            const int index = cellAtGrid(candidateRow, candidateCol);
+            if (index >= 0 && hexContains(index, point)) {
+                return index;
+            }
+        }
+    }
+    return -1;
+}
+
+void BoardGeometry::cellsIn(const QRectF &rect, QVector<int> &out) const
+{
+    out.clear();
+    if (!valid || rect.isEmpty()) {
+        return;
+    }
+
+    // A hex reaches one radius above and below its centre and sqrt3/2 radii
+    // to either side; rows are 1.5 radii apart, columns sqrt3.
+    const QRectF unit((rect.left() - origin.x()) / hexRadius,
+                      (rect.top() - origin.y()) / hexRadius,
+                      rect.width() / hexRadius,
+                      rect.height() / hexRadius);
+    const int firstRow = std::max(0, static_cast<int>(std::floor((unit.top() - 1.0) / 1.5)) + 1);
+    const int lastRow = std::min(gridRows - 1, static_cast<int>(std::ceil((unit.bottom() + 1.0) / 1.5)) - 1);
+    for (int row = firstRow; row <= lastRow; ++row) {
+        const double shift = rowOffset[row] ? kSqrt3 / 2.0 : 0.0;
+        const int firstCol = std::max(0, static_cast<int>(std::floor((unit.left() - shift) / kSqrt3 - 0.5)) + 1);
+        const int lastCol = std::min(gridCols - 1, static_cast<int>(std::ceil((unit.right() - shift) / kSqrt3 + 0.5)) - 1);
+        for (int col = firstCol; col <= lastCol; ++col) {
+            const int index = grid[row * gridCols + col];
+            if (index >= 0) {
+                out.append(index);
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <QHash>
+#include <QPainterPath>
+#include <QPointF>
+#include <QPolygonF>
+#include <QRectF>
+#include <QSizeF>
+#include <QVector>
+
+#include "game/GameModel.h"
+
+// Pixel layout of the board's hexes, built once per board, widget size,
+// device pixel ratio and view (zoom, pan) and reused by every paint and
+// click. Cells are indexed in BoardState::cells order.
+class BoardGeometry
+{
+public:
+    void clear();
+    // Fits the board into `area` (minimum hex radius 14 px), then scales the
+    // hexes by `zoom` and shifts them by `pan` pixels.
+    void build(const model::BoardState &board,
+               const QRectF &area,
+               qreal devicePixelRatio,
+               qreal zoom = 1.0,
+               const QPointF &pan = QPointF());
+
+    bool isValid() const;
+    bool matches(const QRectF &area, qreal devicePixelRatio, qreal zoom, const QPointF &pan) const;
+
+    int cellCount() const;
+    qreal radius() const;
+    // Hex radius at zoom 1, and the board's extent in those radii.
+    qreal fitRadius() const;
+    QSizeF unitSize() const;
+    QPointF center(int index) const;
+    const QString &cellId(int index) const;
+    int indexOf(const QString &cellId) const;
+
+    // One hex around the origin; paint translates it to each centre.
+    const QPainterPath &hexPath() const;
+    const QPolygonF &hexPolygon() const;
+    QRectF hexBounds(int index) const;
+
+    // Index of the cell under `point`, or -1. Converts the point to hex
+    // coordinates and rounds to the nearest hex, so the cost does not depend
+    // on the board size.
+    int cellAt(const QPointF &point) const;
+    // Cells whose hex bounds may intersect `rect`, from the row/column index;
+    // cost follows the number of cells returned, not the board size.
+    void cellsIn(const QRectF &rect, QVector<int> &out) const;
+
+private:
+    int cellAtGrid(int row, int col) const;
+    bool hexContains(int index, const QPointF &point) const;
+
+    QVector<QPointF> centers;
+    QVector<QString> ids;
+    QHash<QString, int> indexById;
+    // Board row/column -> cell index (-1 for holes), and per-row offsets.
+    QVector<int> grid;
+    QVector<bool> rowOffset;
+    int gridRows{0};
+    int gridCols{0};
+    // The rows whose offset flag does not follow the lattice below are
+    // resolved by the neighbour search in cellAt().
+    bool oddRowsOffset{true};
+    // Pixel position of hex-unit (0, 0); a cell's centre is origin + unit * radius.
+    QPointF origin;
+
+    QPainterPath hex;
+    QPolygonF hexCorners;
+    QRectF builtArea;
+    QSizeF boardUnits;
+    QPointF builtPan;
+    qreal hexRadius{0.0};
+    qreal baseRadius{0.0};
+    qreal builtRatio{0.0};
+    qreal builtZoom{1.0};
+    bool valid{false};
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <QColor>
+
+// Cell and token colours shared by BoardView and the map thumbnails.
+namespace BoardPalette {
+
+inline const QColor kNeutral(230, 221, 187);
+inline const QColor kFriendly(103, 135, 80);
+inline const QColor kHostile(170, 104, 52);
+inline const QColor kPlayerA(86, 149, 224);
+inline const QColor kPlayerB(227, 123, 102);
+
+// Base fill of a cell with `shield` (0 neutral, 1 friendly, 2+ hostile).
+inline QColor shieldColor(int shield)
+{
+    if (shield <= 0) {
+        return kNeutral;
+    }
+    if (shield == 1) {
+        return kFriendly;
+    }
+    return kHostile;
+}
+
+} // namespace BoardPalette
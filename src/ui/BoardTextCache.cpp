@@ -0,0 +1,80 @@
+#include "BoardTextCache.h"
+
+#include "BoardGeometry.h"
+
+#include <QTransform>
+
+namespace {
+
+QStaticText prepared(const QString &text, const QFont &font, qreal devicePixelRatio)
+{
+    QStaticText result(text);
+    result.setTextFormat(Qt::PlainText);
+    result.setPerformanceHint(QStaticText::AggressiveCaching);
+    result.prepare(QTransform::fromScale(devicePixelRatio, devicePixelRatio), font);
+    return result;
+}
+
+QPointF centered(const QStaticText &text, const QPointF &center)
+{
+    const QSizeF size = text.size();
+    return QPointF(center.x() - size.width() / 2.0, center.y() - size.height() / 2.0);
+}
+
+} // namespace
+
+void BoardTextCache::clear()
+{
+    ids.clear();
+    cachedRatio = 0.0;
+}
+
+void BoardTextCache::ensure(const BoardGeometry &geometry, const QFont &idFont, const QFont &tokenFont, qreal devicePixelRatio)
+{
+    if (ids.size() == geometry.cellCount() && cachedIdFont == idFont && cachedTokenFont == tokenFont &&
+        qFuzzyCompare(cachedRatio, devicePixelRatio)) {
+        return;
+    }
+
+    ids.clear();
+    ids.reserve(geometry.cellCount());
+    for (int index = 0; index < geometry.cellCount(); ++index) {
+        ids.append(prepared(geometry.cellId(index), idFont, devicePixelRatio));
+    }
+    tokens[static_cast<int>(model::AgentType::Scout)] = prepared(QStringLiteral("SC"), tokenFont, devicePixelRatio);
+    tokens[static_cast<int>(model::AgentType::Sniper)] = prepared(QStringLiteral("SN"), tokenFont, devicePixelRatio);
+    tokens[static_cast<int>(model::AgentType::Sergeant)] = prepared(QStringLiteral("SG"), tokenFont, devicePixelRatio);
+    cachedIdFont = idFont;
+    cachedTokenFont = tokenFont;
+    cachedRatio = devicePixelRatio;
+}
+
+QPointF BoardTextCache::idOrigin(int index, const QPointF &center) const
+{
+    return centered(ids[index], center);
+}
+
+const QStaticText &BoardTextCache::id(int index) const
+{
+    return ids[index];
+}
+
+QPointF BoardTextCache::tokenOrigin(model::AgentType type, const QPointF &center) const
+{
+    return centered(token(type), center);
+}
+
+const QStaticText &BoardTextCache::token(model::AgentType type) const
+{
+    return tokens[static_cast<int>(type)];
+}
+
+const QFont &BoardTextCache::idFont() const
+{
+    return cachedIdFont;
+}
+
+const QFont &BoardTextCache::tokenFont() const
+{
+    return cachedTokenFont;
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <QFont>
+#include <QPointF>
+#include <QStaticText>
+#include <QVector>
+
+#include <array>
+
+#include "game/GameModel.h"
+
+class BoardGeometry;
+
+// Laid-out cell ids and token labels (SC/SN/SG) for BoardView. drawText()
+// shapes its string on every call; these QStaticTexts are shaped once per
+// font and device pixel ratio and only redrawn afterwards.
+class BoardTextCache
+{
+public:
+    void clear();
+    // Lays everything out again if the fonts or the ratio differ from the
+    // cached ones, or the board changed since the last call.
+    void ensure(const BoardGeometry &geometry, const QFont &idFont, const QFont &tokenFont, qreal devicePixelRatio);
+
+    // Top-left position that centres the text on `center`.
+    QPointF idOrigin(int index, const QPointF &center) const;
+    const QStaticText &id(int index) const;
+    QPointF tokenOrigin(model::AgentType type, const QPointF &center) const;
+    const QStaticText &token(model::AgentType type) const;
+    // Fonts the texts were laid out with. drawStaticText() uses the painter's
+    // font, so set the matching one first.
+    const QFont &idFont() const;
+    const QFont &tokenFont() const;
+
+private:
+    QVector<QStaticText> ids;
+    std::array<QStaticText, 3> tokens;
+    QFont cachedIdFont;
+    QFont cachedTokenFont;
+    qreal cachedRatio{0.0};
+};
@@ -1,47 +1,113 @@
 #include "BoardView.h"
 
-#include <QCoreApplication>
+#include "BoardPalette.h"
+#include "MapLibrary.h"
+#include "../controllers/ComputerPlayer.h"
+
+#include <QCloseEvent>
+#include <QDateTime>
+#include <QDebug>
 #include <QDir>
-#include <QFile>
 #include <QFileInfo>
 #include <QHBoxLayout>
+#include <QKeyEvent>
 #include <QLabel>
 #include <QLinearGradient>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QPixmap>
 #include <QPushButton>
+#include <QSignalBlocker>
 #include <QRadialGradient>
+#include <QRegion>
+#include <QResizeEvent>
+#include <QScreen>
+#include <QSlider>
+#include <QStandardPaths>
+#include <QStaticText>
 #include <QStyle>
 #include <QStringList>
-#include <QTextStream>
+#include <QTimer>
+#include <QTransform>
 #include <QVBoxLayout>
+#include <QWheelEvent>
 
 #include <algorithm>
 #include <cmath>
 
+namespace {
+
+// View zoom range, relative to the board fitted into the frame.
+constexpr qreal kMinZoom = 0.25;
+constexpr qreal kMaxZoom = 8.0;
+// Level of detail by hex radius in pixels: below kDetailRadius the cell ids,
+// token labels and fill gradients are dropped; below kFlatRadius hexes are
+// flat fills without outlines.
+constexpr qreal kDetailRadius = 16.0;
+constexpr qreal kFlatRadius = 7.0;
+constexpr int kOverlayRefreshMs = 250;
+
+bool developerOverlayDefault = false;
+
+} // namespace
+
+void BoardView::setDeveloperOverlayDefault(bool on)
+{
+    developerOverlayDefault = on;
+}
+
 BoardView::BoardView(const QString &playerOne,
                      const QString &playerTwo,
                      const QString &scenario,
+                     bool computerOpponent,
                      QWidget *parent)
     : QWidget(parent),
       session(gameState),
       playerOneName(playerOne.isEmpty() ? tr("PLAYER 1") : playerOne),
       playerTwoName(playerTwo.isEmpty() ? tr("PLAYER 2") : playerTwo),
-      scenarioPath(scenario)
+      scenarioPath(scenario),
+      vsComputer(computerOpponent)
 {
-    friendlyColor = QColor(103, 135, 80);
-    neutralColor = QColor(230, 221, 187);
-    hostileColor = QColor(170, 104, 52);
-    playerAColor = QColor(86, 149, 224);
-    playerBColor = QColor(227, 123, 102);
-
     setMinimumSize(1200, 760);
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
     setMouseTracking(true);
 
+    // One frame timer drives every running animation; it only runs while
+    // there is something to animate.
+    frameTimer = new QTimer(this);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer, &QTimer::timeout, this, [this]() { advanceAnimations(); });
+    animationClock.start();
+
+    overlayTimer = new QTimer(this);
+    overlayTimer->setInterval(kOverlayRefreshMs);
+    connect(overlayTimer, &QTimer::timeout, this, [this]() {
+        update(frameStats.overlayRect(chromeArea).toAlignedRect());
+    });
+    setFocusPolicy(Qt::StrongFocus);
+
+    if (vsComputer) {
+        computer = new ComputerPlayer(this);
+        connect(computer, &ComputerPlayer::progress, this,
+                [this](int depth, const QString &bestAction, int score, qint64 nodes) {
+                    setActionMessage(tr("Computer is thinking... depth %1, best: %2 (score %3, %4 nodes)")
+                                         .arg(depth)
+                                         .arg(bestAction)
+                                         .arg(score)
+                                         .arg(nodes),
+                                     false);
+                });
+        connect(computer, &ComputerPlayer::actionChosen, this, &BoardView::executeComputerAction);
+        connect(computer, &ComputerPlayer::failed, this, [this](const QString &message) {
+            setActionMessage(tr("Computer: %1").arg(message), true);
+            updateHud();
+        });
+    }
+
     setupUi();
     setupStyles();
+    setDeveloperOverlay(developerOverlayDefault);
     initializeGame();
 }
 
@@ -98,8 +164,18 @@ void BoardView::setupUi()
     controlButton = makeButton(tr("Sergeant Control"), "ActionButton");
     releaseButton = makeButton(tr("Sergeant Release"), "ActionButton");
 
+    resignButton = makeButton(tr("Resign"), "MenuButton");
     menuButton = makeButton(tr("Back To Menu"), "MenuButton");
 
+    replayLabel = new QLabel(sidePanel);
+    replayLabel->setObjectName("MetaLabel");
+    replaySlider = new QSlider(Qt::Horizontal, sidePanel);
+    replaySlider->setPageStep(10);
+    panelLayout->addWidget(replayLabel);
+    panelLayout->addWidget(replaySlider);
+    replayLabel->hide();
+    replaySlider->hide();
+
     panelLayout->addSpacing(8);
     actionResultLabel = new QLabel(tr("Choose an action."), sidePanel);
     actionResultLabel->setObjectName("ResultOk");
@@ -126,7 +202,9 @@ void BoardView::setupUi()
     connect(markButton, &QPushButton::clicked, this, &BoardView::handleScoutMarkAction);
     connect(controlButton, &QPushButton::clicked, this, &BoardView::handleSergeantControlAction);
     connect(releaseButton, &QPushButton::clicked, this, &BoardView::handleSergeantReleaseAction);
+    connect(resignButton, &QPushButton::clicked, this, &BoardView::handleResign);
     connect(menuButton, &QPushButton::clicked, this, [this]() { close(); });
+    connect(replaySlider, &QSlider::valueChanged, this, &BoardView::showReplayPosition);
 }
 
 void BoardView::setupStyles()
@@ -200,58 +278,21 @@ void BoardView::setupStyles()
     )");
 }
 
-QString BoardView::resolveBoardPath(const QString &inputPath, bool &isScenario, QString &errorMessage) const
-{
-    isScenario = false;
-
-    QFile probe(inputPath);
-    if (!probe.open(QIODevice::ReadOnly | QIODevice::Text)) {
-        errorMessage = tr("Cannot open selected file: %1").arg(inputPath);
-        return {};
-    }
-
-    QTextStream in(&probe);
-    QString firstNonEmpty;
-    while (!in.atEnd()) {
-        firstNonEmpty = in.readLine().trimmed();
-        if (!firstNonEmpty.isEmpty()) {
-            break;
-        }
-    }
-
-    if (firstNonEmpty.startsWith('|')) {
-        return QFileInfo(inputPath).absoluteFilePath();
-    }
-
-    isScenario = true;
-    const QString fileName = QFileInfo(inputPath).fileName();
-    const QString baseDir = QCoreApplication::applicationDirPath();
-    const QStringList candidates = {
-        baseDir + QLatin1String("/assets/boards/") + fileName,
-        QDir(baseDir).filePath(QStringLiteral("../src/assets/boards/") + fileName),
-        QDir::currentPath() + QLatin1String("/src/assets/boards/") + fileName,
-        QDir::currentPath() + QLatin1String("/assets/boards/") + fileName
-    };
-
-    for (const QString &candidate : candidates) {
-        if (QFileInfo::exists(candidate)) {
-            return QFileInfo(candidate).absoluteFilePath();
-        }
-    }
-
-    errorMessage = tr("Scenario selected but matching board file was not found: %1").arg(fileName);
-    return {};
-}
-
 void BoardView::initializeGame()
 {
     gameLoaded = false;
     selectedCellId.clear();
-    cellPolygons.clear();
+    hoveredCell = -1;
+    viewZoom = 1.0;
+    viewPan = QPointF();
+    geometry.clear();
+    labels.clear();
+    animations.clear();
+    staticLayer = QPixmap();
 
     QString error;
     bool isScenario = false;
-    boardPath = resolveBoardPath(scenarioPath, isScenario, error);
+    boardPath = resolveMapBoard(scenarioPath, isScenario, error);
     if (boardPath.isEmpty()) {
         setActionMessage(error, true);
         updateHud();
@@ -265,9 +306,100 @@ void BoardView::initializeGame()
     }
 
     gameLoaded = session.isLoaded();
-    setActionMessage(tr("Battle loaded. Select a hex and execute your action."), false);
+    if (gameLoaded && computer != nullptr && !computer->setBoard(gameState.board, error)) {
+        setActionMessage(error, true);
+        gameLoaded = false;
+        updateHud();
+        return;
+    }
+    QString tablebaseError;
+    if (gameLoaded && computer != nullptr) {
+        // Optional; a board without a tablebase next to it just plays on search,
+        // but one that fails to load is reported.
+        const QFileInfo boardInfo(boardPath);
+        const QString tablebasePath = boardInfo.dir().filePath(boardInfo.completeBaseName() + QStringLiteral(".udtb"));
+        if (QFileInfo::exists(tablebasePath) && !computer->loadTablebase(tablebasePath, tablebaseError)) {
+            qWarning().noquote() << tablebaseError;
+        }
+    }
+
+    if (!tablebaseError.isEmpty()) {
+        setActionMessage(tr("Battle loaded; the computer plays without its endgame tablebase: %1").arg(tablebaseError), true);
+    } else {
+        setActionMessage(tr("Battle loaded. Select a hex and execute your action."), false);
+    }
     updateHud();
     update();
+    maybeStartComputerTurn();
+}
+
+bool BoardView::loadReplay(const model::ReplayGame &game, int actionCount, QString &errorMessage)
+{
+    if (computer != nullptr) {
+        computer->cancel();
+    }
+    gameLoaded = false;
+    replaying = true;
+    selectedCellId.clear();
+    hoveredCell = -1;
+    viewZoom = 1.0;
+    viewPan = QPointF();
+    geometry.clear();
+    labels.clear();
+    animations.clear();
+    staticLayer = QPixmap();
+    replayTimeline.clear();
+
+    model::PackedState start;
+    if (!model::loadReplayStart(session, game, errorMessage) ||
+        !model::buildPackedBoard(gameState.board, replayBoard, errorMessage) ||
+        !model::packGameState(gameState, replayBoard, start, errorMessage) ||
+        !replayTimeline.build(replayBoard, start, game, errorMessage)) {
+        setActionMessage(errorMessage, true);
+        updateHud();
+        update();
+        return false;
+    }
+
+    replayGame = game;
+    replayShown = start;
+    boardPath = game.boardPath;
+    scenarioPath = game.scenarioPath;
+    gameLoaded = session.isLoaded();
+
+    const int length = replayTimeline.length();
+    const int position = actionCount < 0 || actionCount > length ? length : actionCount;
+    replayLabel->show();
+    replaySlider->show();
+    // Setting the value emits valueChanged only when it changes.
+    const QSignalBlocker blocker(replaySlider);
+    replaySlider->setRange(0, length);
+    replaySlider->setValue(position);
+    showReplayPosition(position);
+    update();
+    return true;
+}
+
+void BoardView::showReplayPosition(int position)
+{
+    if (!replaying || !gameLoaded) {
+        return;
+    }
+
+    const model::PackedState next = replayTimeline.seek(position);
+    const model::CellMask changed = model::changedPackedCells(replayShown, next);
+    replayShown = next;
+    model::unpackGameState(next, replayBoard, gameState);
+    replayLabel->setText(tr("Replay: action %1 / %2").arg(position).arg(replayTimeline.length()));
+
+    if (position == 0) {
+        setActionMessage(tr("Replay of game %1: start position.").arg(replayGame.id), false);
+    } else {
+        const QString text = model::replayActionText(replayBoard, replayGame.actions[position - 1]);
+        setActionMessage(tr("Replay of game %1, last action: %2").arg(replayGame.id).arg(text), false);
+    }
+    updateHud();
+    updateCells(changed);
 }
 
 QString BoardView::playerDisplayName(model::PlayerId id) const
@@ -328,6 +460,7 @@ void BoardView::updateHud()
         markButton->setEnabled(false);
         controlButton->setEnabled(false);
         releaseButton->setEnabled(false);
+        resignButton->setEnabled(false);
         return;
     }
 
@@ -404,13 +537,15 @@ void BoardView::updateHud()
     }
 
     const bool inProgress = (gameState.status == model::GameStatus::InProgress);
-    const bool canAct = inProgress && gameState.turn.hasActiveCard;
+    const bool canAct = inProgress && gameState.turn.hasActiveCard && !isComputerTurn() && !replaying;
 
     moveButton->setEnabled(false);
     attackButton->setEnabled(false);
     markButton->setEnabled(false);
     controlButton->setEnabled(false);
     releaseButton->setEnabled(false);
+    // Resigning stays available while the computer thinks.
+    resignButton->setEnabled(inProgress && !replaying);
 
     if (canAct) {
         moveButton->setEnabled(true);
@@ -438,16 +573,16 @@ void BoardView::handleMoveAction()
         return;
     }
 
-    const model::CommandResult result = session.execute(model::MoveCommand(selectedCellId));
+    const QString target = selectedCellId;
+    const ActionOrigin origin = captureOrigin(target);
+    const model::CommandResult result = runCommand(model::MoveCommand(target));
     if (!result.ok) {
         setActionMessage(result.message, true);
         return;
     }
 
-    selectedCellId.clear();
-    setActionMessage(result.message, false);
-    updateHud();
-    update();
+    animateAction(model::ActionKind::Move, target, origin);
+    finishCommand(result);
 }
 
 void BoardView::handleAttackAction()
@@ -458,61 +593,225 @@ void BoardView::handleAttackAction()
         return;
     }
 
-    const model::CommandResult result = session.execute(model::AttackCommand(selectedCellId));
+    const QString target = selectedCellId;
+    const ActionOrigin origin = captureOrigin(target);
+    const model::CommandResult result = runCommand(model::AttackCommand(target));
     if (!result.ok) {
         setActionMessage(result.message, true);
         return;
     }
 
-    selectedCellId.clear();
-    setActionMessage(result.message, false);
-    updateHud();
-    update();
+    animateAction(model::ActionKind::Attack, target, origin);
+    finishCommand(result);
 }
 
 void BoardView::handleScoutMarkAction()
 {
     const model::CommandResult result =
-        session.execute(model::UseAgentSpecialCommand(model::AgentSpecialAction::ScoutMark));
+        runCommand(model::UseAgentSpecialCommand(model::AgentSpecialAction::ScoutMark));
     if (!result.ok) {
         setActionMessage(result.message, true);
         return;
     }
 
-    selectedCellId.clear();
-    setActionMessage(result.message, false);
-    updateHud();
-    update();
+    finishCommand(result);
 }
 
 void BoardView::handleSergeantControlAction()
 {
     const model::CommandResult result =
-        session.execute(model::UseAgentSpecialCommand(model::AgentSpecialAction::SergeantControl));
+        runCommand(model::UseAgentSpecialCommand(model::AgentSpecialAction::SergeantControl));
     if (!result.ok) {
         setActionMessage(result.message, true);
         return;
     }
 
-    selectedCellId.clear();
-    setActionMessage(result.message, false);
-    updateHud();
-    update();
+    finishCommand(result);
 }
 
 void BoardView::handleSergeantReleaseAction()
 {
     const model::CommandResult result =
-        session.execute(model::UseAgentSpecialCommand(model::AgentSpecialAction::SergeantRelease));
+        runCommand(model::UseAgentSpecialCommand(model::AgentSpecialAction::SergeantRelease));
     if (!result.ok) {
         setActionMessage(result.message, true);
         return;
     }
 
+    finishCommand(result);
+}
+
+void BoardView::handleResign()
+{
+    if (computer != nullptr) {
+        computer->cancel();
+    }
+
+    const model::PlayerId loser = computer != nullptr
+                                      ? model::opponentOf(computerSide)
+                                      : gameState.turn.currentPlayer;
+    QString error;
+    if (!session.resign(loser, error)) {
+        setActionMessage(error, true);
+        updateHud();
+        return;
+    }
+
+    const int selected = geometry.indexOf(selectedCellId);
+    selectedCellId.clear();
+    setActionMessage(tr("%1 resigned.").arg(playerDisplayName(loser)), false);
+    updateHud();
+    updateCell(selected);
+}
+
+model::CommandResult BoardView::runCommand(const model::ActionCommand &command)
+{
+    FrameStats::Scope timing(frameStats, FrameStats::Metric::Execute);
+    return session.execute(command);
+}
+
+void BoardView::finishCommand(const model::CommandResult &result)
+{
+    // Repaint the cells the command changed and the ring of the selection it
+    // consumed, not the whole board.
+    QStringList dirty = result.changedCells;
+    dirty.append(selectedCellId);
     selectedCellId.clear();
     setActionMessage(result.message, false);
     updateHud();
-    update();
+    updateCells(dirty);
+    maybeStartComputerTurn();
+}
+
+bool BoardView::isComputerTurn() const
+{
+    return computer != nullptr && gameLoaded && !replaying && gameState.turn.currentPlayer == computerSide;
+}
+
+void BoardView::maybeStartComputerTurn()
+{
+    if (!isComputerTurn() || gameState.status != model::GameStatus::InProgress ||
+        !gameState.turn.hasActiveCard || computer->isThinking()) {
+        return;
+    }
+
+    setActionMessage(tr("Computer is thinking..."), false);
+    computer->startTurn(gameState);
+}
+
+void BoardView::executeComputerAction(const model::GameAction &action)
+{
+    if (!isComputerTurn()) {
+        return;
+    }
+
+    const ActionOrigin origin = captureOrigin(action.cellId);
+    model::CommandResult result;
+    {
+        FrameStats::Scope timing(frameStats, FrameStats::Metric::Execute);
+        result = model::executeAction(session, action);
+    }
+    if (!result.ok) {
+        setActionMessage(tr("Computer: %1").arg(result.message), true);
+        updateHud();
+        return;
+    }
+
+    animateAction(action.kind, action.cellId, origin);
+    setActionMessage(tr("Computer: %1").arg(result.message), false);
+    updateHud();
+    updateCells(result.changedCells);
+    maybeStartComputerTurn();
+}
+
+BoardView::ActionOrigin BoardView::captureOrigin(const QString &targetCellId) const
+{
+    ActionOrigin origin;
+    origin.owner = gameState.turn.currentPlayer;
+    if (!gameState.turn.hasActiveCard) {
+        return origin;
+    }
+    origin.type = gameState.turn.activeCard.agent;
+    if (const model::PlayerState *player = model::playerById(gameState, origin.owner)) {
+        if (const model::AgentState *agent = model::findAgent(*player, origin.type)) {
+            origin.cellId = agent->cellId;
+        }
+    }
+
+    const model::CellNode *target = model::findCell(gameState.board, targetCellId);
+    const model::PlayerState *enemy = model::playerById(gameState, model::opponentOf(origin.owner));
+    if (target != nullptr && enemy != nullptr) {
+        origin.target = origin.owner == model::PlayerId::A ? target->occupantB : target->occupantA;
+        const model::AgentState *agent = origin.target.has_value() ? model::findAgent(*enemy, *origin.target) : nullptr;
+        origin.targetHp = agent != nullptr ? agent->hp : 0;
+    }
+    return origin;
+}
+
+void BoardView::animateAction(model::ActionKind kind, const QString &targetCellId, const ActionOrigin &origin)
+{
+    const int from = geometry.indexOf(origin.cellId);
+    const int to = geometry.indexOf(targetCellId);
+    if (replaying || !geometry.isValid() || from < 0 || to < 0) {
+        return;
+    }
+
+    const qint64 now = animationClock.elapsed();
+    if (kind == model::ActionKind::Move) {
+        animations.addMove(BoardAnimations::Token{origin.owner, origin.type}, from, to, now);
+    } else if (kind == model::ActionKind::Attack) {
+        QVector<int> path;
+        for (const model::CellNode *cell : model::shortestPath(gameState.board, origin.cellId, targetCellId)) {
+            path.append(geometry.indexOf(cell->id));
+        }
+        const model::PlayerId enemyId = model::opponentOf(origin.owner);
+        const model::PlayerState *enemy = model::playerById(gameState, enemyId);
+        const model::AgentState *agent =
+            enemy != nullptr && origin.target.has_value() ? model::findAgent(*enemy, *origin.target) : nullptr;
+        const bool eliminated = agent != nullptr && !agent->alive;
+        const bool hit = eliminated || (agent != nullptr && agent->hp < origin.targetHp);
+        std::optional<BoardAnimations::Token> removed;
+        if (eliminated) {
+            removed = BoardAnimations::Token{enemyId, *origin.target};
+        }
+        animations.addAttack(path, hit, removed, now);
+    } else {
+        return;
+    }
+
+    if (!frameTimer->isActive()) {
+        const qreal refresh = screen() != nullptr ? screen()->refreshRate() : 60.0;
+        frameTimer->start(std::max(1, qRound(1000.0 / std::max(refresh, 30.0))));
+    }
+    advanceAnimations();
+}
+
+void BoardView::advanceAnimations()
+{
+    const QRegion dirty = animations.advance(geometry, animationClock.elapsed());
+    if (!dirty.isEmpty()) {
+        update(dirty);
+    }
+    if (animations.isEmpty()) {
+        frameTimer->stop();
+    }
+}
+
+void BoardView::drawToken(QPainter &p, const QPointF &center, model::PlayerId owner, model::AgentType type, qreal scale)
+{
+    const qreal radius = geometry.radius();
+    p.setTransform(QTransform::fromTranslate(center.x(), center.y()));
+    p.setPen(radius < kFlatRadius ? QPen(Qt::NoPen) : QPen(QColor(255, 255, 255, 180), 1.6));
+    p.setBrush(owner == model::PlayerId::A ? BoardPalette::kPlayerA : BoardPalette::kPlayerB);
+    const QRectF token = BoardAnimations::tokenRect(QPointF(), radius, scale);
+    p.drawEllipse(token);
+
+    // Labels are laid out for one size; scaled tokens (eliminations) go without.
+    if (radius >= kDetailRadius && scale == 1.0) {
+        p.setPen(QColor(10, 15, 20));
+        p.setFont(labels.tokenFont());
+        p.drawStaticText(labels.tokenOrigin(type, token.center()), labels.token(type));
+    }
 }
 
 QRectF BoardView::boardAreaRect() const
@@ -525,50 +824,65 @@ QRectF BoardView::boardAreaRect() const
     return QRectF(left, top, widthValue, heightValue);
 }
 
-QPolygonF BoardView::hexPolygon(const QPointF &center, double radius) const
+void BoardView::ensureGeometry()
 {
-    constexpr double kPi = 3.14159265358979323846;
-    QPolygonF poly;
-    poly.reserve(6);
-    for (int i = 0; i < 6; ++i) {
-        const double angle = (60.0 * i - 30.0) * kPi / 180.0;
-        poly << QPointF(center.x() + radius * std::cos(angle),
-                        center.y() + radius * std::sin(angle));
+    const QRectF area = boardAreaRect();
+    const qreal ratio = devicePixelRatioF();
+    if (!geometry.matches(area, ratio, viewZoom, viewPan)) {
+        FrameStats::Scope timing(frameStats, FrameStats::Metric::Layout);
+        geometry.build(gameState.board, area, ratio, viewZoom, viewPan);
+        ensureLabels();
+        staticLayer = QPixmap();
     }
-    return poly;
 }
 
-QColor BoardView::shieldColor(int shield) const
+void BoardView::setView(qreal zoom, const QPointF &pan)
 {
-    if (shield <= 0) {
-        return neutralColor;
-    }
-    if (shield == 1) {
-        return friendlyColor;
+    zoom = std::clamp(zoom, kMinZoom, kMaxZoom);
+    // Keep the board's centre within half the board's extent of the frame's
+    // centre, so some of it is always in view.
+    const QSizeF extent = geometry.unitSize() * (geometry.fitRadius() * zoom * 0.5);
+    const QPointF clamped(std::clamp(pan.x(), -extent.width(), extent.width()),
+                          std::clamp(pan.y(), -extent.height(), extent.height()));
+    if (zoom == viewZoom && clamped == viewPan) {
+        return;
     }
-    return hostileColor;
+    viewZoom = zoom;
+    viewPan = clamped;
+    update();
+}
+
+void BoardView::ensureLabels()
+{
+    // Labels grow with the zoom; 8 pt at the fitted size.
+    QFont idFont = font();
+    idFont.setPointSizeF(8.0 * viewZoom);
+    idFont.setWeight(QFont::DemiBold);
+    QFont tokenFont = font();
+    tokenFont.setPointSizeF(8.0 * viewZoom);
+    tokenFont.setWeight(QFont::Bold);
+    labels.ensure(geometry, idFont, tokenFont, devicePixelRatioF());
 }
 
-QString BoardView::pieceShortName(model::AgentType type) const
+int BoardView::cellAtPoint(const QPointF &point)
 {
-    switch (type) {
-    case model::AgentType::Scout:
-        return QStringLiteral("SC");
-    case model::AgentType::Sniper:
-        return QStringLiteral("SN");
-    case model::AgentType::Sergeant:
-        return QStringLiteral("SG");
+    FrameStats::Scope timing(frameStats, FrameStats::Metric::HitTest);
+    // Zoomed in, hexes continue under the frame and the side panel.
+    if (!geometry.isValid() || !boardAreaRect().contains(point)) {
+        return -1;
     }
-    return QStringLiteral("??");
+    return geometry.cellAt(point);
 }
 
-void BoardView::paintEvent(QPaintEvent *event)
+void BoardView::renderChromeLayer()
 {
-    Q_UNUSED(event);
+    const qreal ratio = devicePixelRatioF();
+    chromeLayer = QPixmap(size() * ratio);
+    chromeLayer.setDevicePixelRatio(ratio);
+    chromeArea = boardAreaRect();
 
-    QPainter p(this);
+    QPainter p(&chromeLayer);
     p.setRenderHint(QPainter::Antialiasing, true);
-    p.setRenderHint(QPainter::TextAntialiasing, true);
 
     const QRectF full = rect();
     QLinearGradient bg(full.topLeft(), full.bottomRight());
@@ -582,112 +896,162 @@ void BoardView::paintEvent(QPaintEvent *event)
     vignette.setColorAt(1.0, QColor(0, 0, 0, 165));
     p.fillRect(full, vignette);
 
-    QRectF boardArea = boardAreaRect();
-    QLinearGradient frameGrad(boardArea.topLeft(), boardArea.bottomRight());
+    QLinearGradient frameGrad(chromeArea.topLeft(), chromeArea.bottomRight());
     frameGrad.setColorAt(0.0, QColor(47, 67, 51, 235));
     frameGrad.setColorAt(1.0, QColor(36, 49, 38, 235));
     p.setPen(QPen(QColor(240, 233, 199, 60), 2.0));
     p.setBrush(frameGrad);
-    p.drawRoundedRect(boardArea, 18, 18);
+    p.drawRoundedRect(chromeArea, 18, 18);
+}
+
+void BoardView::renderStaticLayer()
+{
+    staticLayer = chromeLayer;
 
-    cellPolygons.clear();
+    QPainter p(&staticLayer);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.setRenderHint(QPainter::TextAntialiasing, true);
 
+    const QRectF boardArea = chromeArea;
     if (!gameLoaded || gameState.board.cells.empty()) {
         p.setPen(QColor(238, 238, 238));
         p.drawText(boardArea, Qt::AlignCenter, tr("Board is not loaded"));
         return;
     }
+    if (!geometry.isValid()) {
+        return;
+    }
 
-    const double sqrt3 = std::sqrt(3.0);
-    QHash<QString, QPointF> unitCenters;
-    unitCenters.reserve(static_cast<int>(gameState.board.cells.size()));
+    const double radius = geometry.radius();
+    const QPainterPath &hex = geometry.hexPath();
+    const bool detailed = radius >= kDetailRadius;
+    const bool flat = radius < kFlatRadius;
+
+    ensureLabels();
+
+    // Hex-local shapes, shared by every cell; only the translation changes.
+    const auto fillFor = [&](int shield) {
+        const QColor base = BoardPalette::shieldColor(shield);
+        if (!detailed) {
+            return QBrush(base);
+        }
+        QLinearGradient fillGrad(QPointF(0, -radius * 0.55), QPointF(0, radius * 0.9));
+        fillGrad.setColorAt(0.0, base.lighter(125));
+        fillGrad.setColorAt(1.0, base.darker(130));
+        return QBrush(fillGrad);
+    };
+    const QBrush fills[3] = {fillFor(0), fillFor(1), fillFor(2)};
+    const QPointF idCenter(0, -radius * 0.525);
+    const QPen cellPen = flat ? QPen(Qt::NoPen) : QPen(QColor(255, 255, 255, 95), 1.4);
 
-    double minX = 1e9;
-    double maxX = -1e9;
-    double minY = 1e9;
-    double maxY = -1e9;
+    if (detailed) {
+        p.setFont(labels.idFont());
+    }
 
-    for (const auto &cellPtr : gameState.board.cells) {
-        const model::CellNode *cell = cellPtr.get();
-        const double ux = cell->col * sqrt3 + (cell->offset ? sqrt3 / 2.0 : 0.0);
-        const double uy = cell->row * 1.5;
-        unitCenters.insert(cell->id, QPointF(ux, uy));
-        minX = std::min(minX, ux);
-        maxX = std::max(maxX, ux);
-        minY = std::min(minY, uy);
-        maxY = std::max(maxY, uy);
+    // Zoomed in, hexes spill past the frame; only the visible ones are drawn.
+    p.setClipRect(boardArea);
+    geometry.cellsIn(boardArea, visibleCells);
+    for (const int index : std::as_const(visibleCells)) {
+        const model::CellNode *cell = gameState.board.cells[index].get();
+        const QPointF center = geometry.center(index);
+        p.setTransform(QTransform::fromTranslate(center.x(), center.y()));
+
+        p.setPen(cellPen);
+        p.setBrush(fills[std::clamp(cell->shield, 0, 2)]);
+        p.drawPath(hex);
+
+        if (detailed) {
+            p.setPen(QColor(16, 16, 16));
+            p.drawStaticText(labels.idOrigin(index, idCenter), labels.id(index));
+        }
     }
+}
 
-    const double gridW = (maxX - minX) + sqrt3;
-    const double gridH = (maxY - minY) + 2.0;
-    if (gridW <= 0 || gridH <= 0) {
+void BoardView::paintEvent(QPaintEvent *event)
+{
+    QPainter p(this);
+    if (!frameStats.isEnabled()) {
+        paintBoard(p, event->rect());
         return;
     }
 
-    const QRectF inner = boardArea.adjusted(18, 18, -18, -18);
-    const double radius = std::max(14.0, std::min(inner.width() / gridW, inner.height() / gridH));
-    const QPointF boardCenter = inner.center();
-    const double midX = (minX + maxX) * 0.5;
-    const double midY = (minY + maxY) * 0.5;
+    // The overlay's own refreshes are not frames worth timing.
+    if (frameStats.overlayRect(chromeArea).toAlignedRect().contains(event->rect())) {
+        paintBoard(p, event->rect());
+    } else {
+        FrameStats::Scope timing(frameStats, FrameStats::Metric::Paint);
+        paintBoard(p, event->rect());
+    }
+    frameStats.framePainted();
+    frameStats.paint(p, chromeArea);
+}
+
+void BoardView::paintBoard(QPainter &p, const QRectF &dirty)
+{
+    // Background, frame, hex fills and ids come from the cached layers; only
+    // the state-dependent overlays are drawn per frame.
+    if (gameLoaded) {
+        ensureGeometry();
+    }
+    const qreal ratio = devicePixelRatioF();
+    if (chromeLayer.isNull() || chromeLayer.size() != size() * ratio || chromeLayer.devicePixelRatio() != ratio ||
+        chromeArea != boardAreaRect()) {
+        renderChromeLayer();
+        staticLayer = QPixmap();
+    }
+    if (staticLayer.isNull()) {
+        renderStaticLayer();
+    }
+    p.drawPixmap(dirty, staticLayer, QRectF(dirty.topLeft() * ratio, dirty.size() * ratio));
 
-    QFont idFont = p.font();
-    idFont.setPointSize(8);
-    idFont.setWeight(QFont::DemiBold);
+    if (!gameLoaded || !geometry.isValid()) {
+        return;
+    }
 
-    QFont tokenFont = p.font();
-    tokenFont.setPointSize(8);
-    tokenFont.setWeight(QFont::Bold);
+    const QRectF visible = dirty.intersected(chromeArea);
+    geometry.cellsIn(visible, visibleCells);
+    if (visibleCells.isEmpty() && animations.isEmpty()) {
+        return;
+    }
 
-    for (const auto &cellPtr : gameState.board.cells) {
-        const model::CellNode *cell = cellPtr.get();
-        const QPointF u = unitCenters.value(cell->id);
-        const QPointF center(boardCenter.x() + (u.x() - midX) * radius,
-                             boardCenter.y() + (u.y() - midY) * radius);
+    p.setClipRect(visible);
+    p.setRenderHint(QPainter::Antialiasing, true);
+    p.setRenderHint(QPainter::TextAntialiasing, true);
 
-        const QPolygonF poly = hexPolygon(center, radius);
-        cellPolygons.insert(cell->id, poly);
+    const double radius = geometry.radius();
+    const QPainterPath &hex = geometry.hexPath();
 
-        QColor base = shieldColor(cell->shield);
-        QLinearGradient fillGrad(center + QPointF(0, -radius * 0.55),
-                                 center + QPointF(0, radius * 0.9));
-        fillGrad.setColorAt(0.0, base.lighter(125));
-        fillGrad.setColorAt(1.0, base.darker(130));
+    ensureLabels();
 
-        if (cell->id == selectedCellId) {
-            p.setPen(QPen(QColor(250, 235, 156), 3.2));
-        } else {
-            p.setPen(QPen(QColor(255, 255, 255, 95), 1.4));
-        }
-        p.setBrush(fillGrad);
-        p.drawPolygon(poly);
+    const QPen selectedPen(QColor(250, 235, 156), 3.2);
+    const QPen hoverPen(QColor(255, 255, 255, 200), 2.2);
+
+    for (const int index : std::as_const(visibleCells)) {
+        const model::CellNode *cell = gameState.board.cells[index].get();
+        const QPointF center = geometry.center(index);
+        p.setTransform(QTransform::fromTranslate(center.x(), center.y()));
 
         if (cell->controlledBy == model::PlayerId::A) {
-            p.setPen(QPen(playerAColor, 2.8));
+            p.setPen(QPen(BoardPalette::kPlayerA, 2.8));
             p.setBrush(Qt::NoBrush);
-            p.drawPolygon(poly);
+            p.drawPath(hex);
         } else if (cell->controlledBy == model::PlayerId::B) {
-            p.setPen(QPen(playerBColor, 2.8));
+            p.setPen(QPen(BoardPalette::kPlayerB, 2.8));
             p.setBrush(Qt::NoBrush);
-            p.drawPolygon(poly);
+            p.drawPath(hex);
         }
 
         if (cell->markedByA) {
             p.setPen(Qt::NoPen);
-            p.setBrush(playerAColor);
-            p.drawEllipse(center + QPointF(-radius * 0.42, -radius * 0.32), radius * 0.14, radius * 0.14);
+            p.setBrush(BoardPalette::kPlayerA);
+            p.drawEllipse(QPointF(-radius * 0.42, -radius * 0.32), radius * 0.14, radius * 0.14);
         }
         if (cell->markedByB) {
             p.setPen(Qt::NoPen);
-            p.setBrush(playerBColor);
-            p.drawEllipse(center + QPointF(radius * 0.42, -radius * 0.32), radius * 0.14, radius * 0.14);
+            p.setBrush(BoardPalette::kPlayerB);
+            p.drawEllipse(QPointF(radius * 0.42, -radius * 0.32), radius * 0.14, radius * 0.14);
         }
 
-        p.setFont(idFont);
-        p.setPen(QColor(16, 16, 16));
-        p.drawText(QRectF(center.x() - radius, center.y() - radius * 0.75, radius * 2, radius * 0.45),
-                   Qt::AlignCenter,
-                   cell->id);
-
         std::optional<model::AgentType> occ;
         model::PlayerId owner = model::PlayerId::None;
         if (cell->occupantA.has_value()) {
@@ -698,52 +1062,235 @@ void BoardView::paintEvent(QPaintEvent *event)
             owner = model::PlayerId::B;
         }
 
-        if (occ.has_value()) {
-            const QRectF tokenRect(center.x() - radius * 0.48,
-                                   center.y() - radius * 0.3,
-                                   radius * 0.96,
-                                   radius * 0.96);
-            p.setPen(QPen(QColor(255, 255, 255, 180), 1.6));
-            p.setBrush(owner == model::PlayerId::A ? playerAColor : playerBColor);
-            p.drawEllipse(tokenRect);
-
-            p.setFont(tokenFont);
-            p.setPen(QColor(10, 15, 20));
-            p.drawText(tokenRect, Qt::AlignCenter, pieceShortName(*occ));
+        if (occ.has_value() && !animations.hidesToken(index)) {
+            drawToken(p, center, owner, *occ);
         }
     }
+
+    // Animated tokens and attack tracers, in widget coordinates.
+    p.resetTransform();
+    for (const BoardAnimations::TracerFrame &tracer : animations.tracerFrames()) {
+        const QColor color = tracer.hit ? QColor(255, 176, 84) : QColor(235, 235, 235, 210);
+        p.setPen(QPen(color, std::max(2.0, radius * 0.12), Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        p.setBrush(Qt::NoBrush);
+        p.drawPolyline(tracer.trail);
+        p.setPen(Qt::NoPen);
+        p.setBrush(color.lighter(120));
+        p.drawEllipse(tracer.trail.last(), radius * 0.12 + 1.0, radius * 0.12 + 1.0);
+    }
+    for (const BoardAnimations::TokenFrame &frame : animations.tokenFrames()) {
+        p.setOpacity(frame.opacity);
+        drawToken(p, frame.center, frame.token.owner, frame.token.type, frame.scale);
+    }
+    p.setOpacity(1.0);
+
+    // Selection and hover rings go last so no neighbouring overlay covers them.
+    p.setBrush(Qt::NoBrush);
+    if (hoveredCell >= 0 && hoveredCell < geometry.cellCount() && geometry.cellId(hoveredCell) != selectedCellId) {
+        p.setTransform(QTransform::fromTranslate(geometry.center(hoveredCell).x(), geometry.center(hoveredCell).y()));
+        p.setPen(hoverPen);
+        p.drawPath(hex);
+    }
+    const int selected = geometry.indexOf(selectedCellId);
+    if (selected >= 0) {
+        p.setTransform(QTransform::fromTranslate(geometry.center(selected).x(), geometry.center(selected).y()));
+        p.setPen(selectedPen);
+        p.drawPath(hex);
+    }
+    p.resetTransform();
 }
 
 void BoardView::mousePressEvent(QMouseEvent *event)
 {
+    if ((event->button() == Qt::RightButton || event->button() == Qt::MiddleButton) && gameLoaded &&
+        boardAreaRect().contains(event->position())) {
+        panning = true;
+        panAnchor = event->position() - viewPan;
+        setCursor(Qt::ClosedHandCursor);
+        return;
+    }
     if (event->button() != Qt::LeftButton) {
         QWidget::mousePressEvent(event);
         return;
     }
 
+    frameStats.pressed();
     const QPointF click = event->position();
-    QString hit;
+    const int hit = cellAtPoint(click);
 
-    for (auto it = cellPolygons.constBegin(); it != cellPolygons.constEnd(); ++it) {
-        if (it.value().containsPoint(click, Qt::OddEvenFill)) {
-            hit = it.key();
-            break;
-        }
-    }
-
-    if (!hit.isEmpty()) {
-        selectedCellId = hit;
+    if (hit >= 0) {
+        updateCell(geometry.indexOf(selectedCellId));
+        selectedCellId = geometry.cellId(hit);
         updateHud();
-        update();
+        updateCell(hit);
         return;
     }
 
+    // Only presses that change the selection are followed by a repaint.
     if (boardAreaRect().contains(click)) {
+        if (selectedCellId.isEmpty()) {
+            frameStats.dropPress();
+        }
+        updateCell(geometry.indexOf(selectedCellId));
         selectedCellId.clear();
         updateHud();
-        update();
         return;
     }
 
+    frameStats.dropPress();
     QWidget::mousePressEvent(event);
 }
+
+void BoardView::mouseMoveEvent(QMouseEvent *event)
+{
+    if (panning) {
+        setView(viewZoom, event->position() - panAnchor);
+        return;
+    }
+    setHoveredCell(cellAtPoint(event->position()));
+    QWidget::mouseMoveEvent(event);
+}
+
+void BoardView::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (panning && (event->button() == Qt::RightButton || event->button() == Qt::MiddleButton)) {
+        panning = false;
+        unsetCursor();
+        return;
+    }
+    QWidget::mouseReleaseEvent(event);
+}
+
+void BoardView::wheelEvent(QWheelEvent *event)
+{
+    const QPointF at = event->position();
+    const int steps = event->angleDelta().y();
+    if (!gameLoaded || !geometry.isValid() || steps == 0 || !boardAreaRect().contains(at)) {
+        QWidget::wheelEvent(event);
+        return;
+    }
+
+    // Zoom about the cursor: the board point under it stays put.
+    const qreal zoom = std::clamp(viewZoom * std::pow(1.0015, steps), kMinZoom, kMaxZoom);
+    const QPointF fromCenter = at - boardAreaRect().center();
+    setView(zoom, fromCenter - (fromCenter - viewPan) * (zoom / viewZoom));
+    ensureGeometry();
+    hoveredCell = cellAtPoint(at);
+    event->accept();
+}
+
+void BoardView::leaveEvent(QEvent *event)
+{
+    setHoveredCell(-1);
+    QWidget::leaveEvent(event);
+}
+
+void BoardView::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() == Qt::Key_F3) {
+        setDeveloperOverlay(!frameStats.isEnabled());
+        return;
+    }
+    if (event->key() == Qt::Key_F4 && frameStats.isEnabled()) {
+        exportFrameStats();
+        return;
+    }
+    QWidget::keyPressEvent(event);
+}
+
+void BoardView::setDeveloperOverlay(bool on)
+{
+    frameStats.setEnabled(on);
+    if (on) {
+        overlayTimer->start();
+    } else {
+        overlayTimer->stop();
+    }
+    update();
+}
+
+void BoardView::exportFrameStats()
+{
+    const QString dir = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation);
+    const QString path = QDir(dir).filePath(
+        QStringLiteral("frame-stats-%1.csv").arg(QDateTime::currentDateTime().toString(QStringLiteral("yyyyMMdd-HHmmss"))));
+    QString error;
+    if (!QDir().mkpath(dir) || !frameStats.writeCsv(path, error)) {
+        setActionMessage(error.isEmpty() ? tr("Cannot create %1").arg(dir) : error, true);
+        return;
+    }
+    setActionMessage(tr("Frame stats written to %1").arg(QDir::toNativeSeparators(path)), false);
+}
+
+QRect BoardView::cellRepaintRect(int index) const
+{
+    // Widest outline (the selection ring) is 3.2 px, half of it outside the hex.
+    return geometry.hexBounds(index).adjusted(-3, -3, 3, 3).toAlignedRect();
+}
+
+void BoardView::updateCell(int index)
+{
+    if (index >= 0 && index < geometry.cellCount()) {
+        update(cellRepaintRect(index));
+    }
+}
+
+void BoardView::updateCells(const QStringList &cellIds)
+{
+    if (!geometry.isValid()) {
+        update();
+        return;
+    }
+    QRegion region;
+    for (const QString &cellId : cellIds) {
+        const int index = geometry.indexOf(cellId);
+        if (index >= 0) {
+            region += cellRepaintRect(index);
+        }
+    }
+    if (!region.isEmpty()) {
+        update(region);
+    }
+}
+
+void BoardView::updateCells(const model::CellMask &cells)
+{
+    if (!geometry.isValid()) {
+        update();
+        return;
+    }
+    QRegion region;
+    for (int index = 0; index < geometry.cellCount(); ++index) {
+        if (cells.test(index)) {
+            region += cellRepaintRect(index);
+        }
+    }
+    if (!region.isEmpty()) {
+        update(region);
+    }
+}
+
+void BoardView::setHoveredCell(int index)
+{
+    if (index == hoveredCell) {
+        return;
+    }
+    updateCell(hoveredCell);
+    hoveredCell = index;
+    updateCell(hoveredCell);
+}
+
+void BoardView::resizeEvent(QResizeEvent *event)
+{
+    geometry.clear();
+    staticLayer = QPixmap();
+    QWidget::resizeEvent(event);
+}
+
+void BoardView::closeEvent(QCloseEvent *event)
+{
+    if (computer != nullptr) {
+        computer->cancel();
+    }
+    QWidget::closeEvent(event);
+}
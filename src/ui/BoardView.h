@@ -1,17 +1,30 @@
 #pragma once
 
 #include <QWidget>
-#include <QColor>
-#include <QHash>
-#include <QPolygonF>
+#include <QElapsedTimer>
+#include <QPixmap>
 
+#include <optional>
+
+#include "BoardAnimations.h"
+#include "BoardGeometry.h"
+#include "BoardTextCache.h"
+#include "FrameStats.h"
 #include "game/GameModel.h"
 
+class ComputerPlayer;
+class QCloseEvent;
+class QKeyEvent;
 class QLabel;
 class QPushButton;
+class QSlider;
 class QWidget;
 class QPaintEvent;
 class QMouseEvent;
+class QPainter;
+class QResizeEvent;
+class QTimer;
+class QWheelEvent;
 
 class BoardView : public QWidget
 {
@@ -19,17 +32,41 @@ public:
     explicit BoardView(const QString &playerOne,
                        const QString &playerTwo,
                        const QString &scenarioPath,
+                       bool vsComputer = false,
                        QWidget *parent = nullptr);
 
+    // Shows a recorded game at actionCount (-1 = the end) instead of a live
+    // battle. The view becomes read-only and a slider scrubs through the game.
+    bool loadReplay(const model::ReplayGame &game, int actionCount, QString &errorMessage);
+
+    // Whether new views start with the developer timing overlay (F3 toggles
+    // it, F4 writes its histograms to CSV).
+    static void setDeveloperOverlayDefault(bool on);
+
 protected:
     void paintEvent(QPaintEvent *event) override;
     void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+    void leaveEvent(QEvent *event) override;
+    void keyPressEvent(QKeyEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void closeEvent(QCloseEvent *event) override;
 
 private:
+    // What an action's animation needs from the state before the action.
+    struct ActionOrigin {
+        model::PlayerId owner{model::PlayerId::None};
+        model::AgentType type{model::AgentType::Scout};
+        QString cellId;
+        std::optional<model::AgentType> target;
+        int targetHp{0};
+    };
+
     void setupUi();
     void setupStyles();
     void initializeGame();
-    QString resolveBoardPath(const QString &inputPath, bool &isScenario, QString &errorMessage) const;
 
     void updateHud();
     void setActionMessage(const QString &message, bool isError);
@@ -37,16 +74,57 @@ private:
     QString gameStatusText() const;
     bool requireSelectedCell(QString &errorMessage) const;
 
+    // Runs a player command through the session, timed for the overlay.
+    model::CommandResult runCommand(const model::ActionCommand &command);
+    // Common tail of a successful player command.
+    void finishCommand(const model::CommandResult &result);
     void handleMoveAction();
     void handleAttackAction();
     void handleScoutMarkAction();
     void handleSergeantControlAction();
     void handleSergeantReleaseAction();
+    // Ends the game for the human side (the side to move in hot-seat games)
+    // and stops any computer search still running.
+    void handleResign();
+
+    bool isComputerTurn() const;
+    void maybeStartComputerTurn();
+    void executeComputerAction(const model::GameAction &action);
+    void showReplayPosition(int position);
+
+    ActionOrigin captureOrigin(const QString &targetCellId) const;
+    // Queues the move slide or attack tracer for an action that already
+    // changed the state; never delays the state itself.
+    void animateAction(model::ActionKind kind, const QString &targetCellId, const ActionOrigin &origin);
+    void advanceAnimations();
+    void drawToken(QPainter &p, const QPointF &center, model::PlayerId owner, model::AgentType type, qreal scale = 1.0);
 
     QRectF boardAreaRect() const;
-    QPolygonF hexPolygon(const QPointF &center, double radius) const;
-    QColor shieldColor(int shield) const;
-    QString pieceShortName(model::AgentType type) const;
+    // Rebuilds the cached layout if the board area, device pixel ratio or
+    // view changed since it was built.
+    void ensureGeometry();
+    // Zoom is relative to the fitted board, pan in pixels; both are clamped
+    // and the layout and static layer follow on the next paint.
+    void setView(qreal zoom, const QPointF &pan);
+    int cellAtPoint(const QPointF &point);
+    // Lays out the id and token labels for the current zoom and ratio.
+    void ensureLabels();
+    // Cached layers: chromeLayer (background, vignette, frame) changes only
+    // with the widget size; staticLayer adds the visible hex fills and cell
+    // ids and is rebuilt whenever the layout (board, size or view) changes.
+    void renderChromeLayer();
+    void renderStaticLayer();
+    // Everything paintEvent draws except the developer overlay.
+    void paintBoard(QPainter &p, const QRectF &dirty);
+    void setDeveloperOverlay(bool on);
+    void exportFrameStats();
+    // Partial repaints: just the listed hexes and their outlines. Fall back to
+    // a full update while the layout is not built.
+    QRect cellRepaintRect(int index) const;
+    void updateCell(int index);
+    void updateCells(const QStringList &cellIds);
+    void updateCells(const model::CellMask &cells);
+    void setHoveredCell(int index);
 
 private:
     model::GameState gameState{};
@@ -57,8 +135,13 @@ private:
     QString scenarioPath;
     QString boardPath;
     QString selectedCellId;
+    int hoveredCell{-1};
 
     bool gameLoaded{false};
+    bool vsComputer{false};
+    bool replaying{false};
+    model::PlayerId computerSide{model::PlayerId::B};
+    ComputerPlayer *computer = nullptr;
 
     QLabel *titleLabel = nullptr;
     QLabel *turnLabel = nullptr;
@@ -74,13 +157,31 @@ private:
     QPushButton *markButton = nullptr;
     QPushButton *controlButton = nullptr;
     QPushButton *releaseButton = nullptr;
+    QPushButton *resignButton = nullptr;
     QWidget *sidePanel = nullptr;
+    QLabel *replayLabel = nullptr;
+    QSlider *replaySlider = nullptr;
 
-    QHash<QString, QPolygonF> cellPolygons;
+    model::ReplayGame replayGame;
+    model::PackedBoard replayBoard;
+    model::ReplayTimeline replayTimeline;
+    // Position currently shown, to find the cells a seek changes.
+    model::PackedState replayShown;
 
-    QColor friendlyColor;
-    QColor neutralColor;
-    QColor hostileColor;
-    QColor playerAColor;
-    QColor playerBColor;
+    BoardGeometry geometry;
+    BoardTextCache labels;
+    BoardAnimations animations;
+    QTimer *frameTimer = nullptr;
+    QElapsedTimer animationClock;
+    QPixmap chromeLayer;
+    QRectF chromeArea;
+    QPixmap staticLayer;
+    QVector<int> visibleCells;
+    qreal viewZoom{1.0};
+    QPointF viewPan;
+    bool panning{false};
+    QPointF panAnchor;
+    FrameStats frameStats;
+    // Refreshes the overlay while it is shown.
+    QTimer *overlayTimer = nullptr;
 };
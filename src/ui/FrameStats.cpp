@@ -0,0 +1,226 @@
+#include "FrameStats.h"
+
+#include <QFont>
+#include <QPainter>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include <algorithm>
+
+namespace {
+
+// Histogram bucket lower bounds in microseconds; the last bucket is open.
+// 16667 and 33333 are one and two frames at 60 Hz.
+constexpr std::array<qint64, 11> kBucketLowerUs = {0, 50, 100, 250, 500, 1000, 2000, 4000, 8000, 16667, 33333};
+
+const char *const kMetricNames[FrameStats::kMetricCount] = {"paint", "layout", "hit-test", "latency", "execute"};
+
+constexpr qreal kRowHeight = 16.0;
+constexpr qreal kPadding = 8.0;
+constexpr qreal kBarWidth = 5.0;
+constexpr qreal kTextWidth = 250.0;
+
+QString millis(qint64 nanoseconds)
+{
+    return QString::number(nanoseconds / 1e6, 'f', 2);
+}
+
+} // namespace
+
+FrameStats::Scope::Scope(FrameStats &stats, Metric metric)
+    : stats(stats),
+      metric(metric)
+{
+    if (stats.enabled) {
+        start = stats.now();
+    }
+}
+
+FrameStats::Scope::~Scope()
+{
+    if (start >= 0) {
+        stats.add(metric, stats.now() - start);
+    }
+}
+
+FrameStats::FrameStats()
+{
+    clock.start();
+}
+
+bool FrameStats::isEnabled() const
+{
+    return enabled;
+}
+
+void FrameStats::setEnabled(bool on)
+{
+    enabled = on;
+    pressedAt = -1;
+    for (Series &s : series) {
+        s = Series();
+    }
+}
+
+void FrameStats::add(Metric metric, qint64 nanoseconds)
+{
+    if (!enabled) {
+        return;
+    }
+    Series &s = series[static_cast<int>(metric)];
+    if (s.samples.size() < kWindow) {
+        s.samples.append(nanoseconds);
+    } else {
+        s.samples[s.next] = nanoseconds;
+    }
+    s.next = (s.next + 1) % kWindow;
+}
+
+void FrameStats::pressed()
+{
+    if (enabled) {
+        pressedAt = now();
+    }
+}
+
+void FrameStats::dropPress()
+{
+    pressedAt = -1;
+}
+
+void FrameStats::framePainted()
+{
+    if (pressedAt >= 0) {
+        add(Metric::Latency, now() - pressedAt);
+        pressedAt = -1;
+    }
+}
+
+QRectF FrameStats::overlayRect(const QRectF &area) const
+{
+    const qreal width = kPadding * 3 + kTextWidth + kBarWidth * kBucketLowerUs.size();
+    const qreal height = kPadding * 2 + kRowHeight * (kMetricCount + 1);
+    return QRectF(area.topLeft() + QPointF(kPadding, kPadding), QSizeF(width, height));
+}
+
+void FrameStats::paint(QPainter &painter, const QRectF &area) const
+{
+    const QRectF box = overlayRect(area);
+    painter.save();
+    painter.resetTransform();
+    painter.setClipping(false);
+    painter.setRenderHint(QPainter::Antialiasing, false);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(0, 0, 0, 190));
+    painter.drawRect(box);
+
+    QFont font(QStringLiteral("monospace"));
+    font.setStyleHint(QFont::Monospace);
+    font.setPixelSize(11);
+    painter.setFont(font);
+
+    const qreal left = box.left() + kPadding;
+    const qreal barsLeft = left + kTextWidth + kPadding;
+    qreal y = box.top() + kPadding;
+    painter.setPen(QColor(200, 200, 200));
+    painter.drawText(QRectF(left, y, kTextWidth, kRowHeight), Qt::AlignVCenter,
+                     QStringLiteral("%1%2%3%4%5")
+                         .arg(QStringLiteral("ms"), -8)
+                         .arg(QStringLiteral("last"), 7)
+                         .arg(QStringLiteral("p50"), 6)
+                         .arg(QStringLiteral("p95"), 6)
+                         .arg(QStringLiteral("max"), 6));
+    painter.drawText(QRectF(barsLeft, y, kBarWidth * kBucketLowerUs.size(), kRowHeight), Qt::AlignVCenter,
+                     QStringLiteral("hist"));
+
+    for (int i = 0; i < kMetricCount; ++i) {
+        y += kRowHeight;
+        const Summary summary = summarize(static_cast<Metric>(i));
+        painter.setPen(QColor(235, 235, 235));
+        const QString line = QStringLiteral("%1%2%3%4%5")
+                                 .arg(QString::fromLatin1(kMetricNames[i]).leftJustified(8))
+                                 .arg(summary.count > 0 ? millis(summary.last) : QStringLiteral("-"), 7)
+                                 .arg(summary.count > 0 ? millis(summary.median) : QStringLiteral("-"), 6)
+                                 .arg(summary.count > 0 ? millis(summary.p95) : QStringLiteral("-"), 6)
+                                 .arg(summary.count > 0 ? millis(summary.max) : QStringLiteral("-"), 6);
+        painter.drawText(QRectF(left, y, kTextWidth, kRowHeight), Qt::AlignVCenter, line);
+
+        // Bars scaled to the fullest bucket; buckets past one 60 Hz frame
+        // are drawn in red.
+        const QVector<int> counts = histogram(static_cast<Metric>(i));
+        const int peak = *std::max_element(counts.cbegin(), counts.cend());
+        if (peak == 0) {
+            continue;
+        }
+        for (int b = 0; b < counts.size(); ++b) {
+            const qreal height = (kRowHeight - 4) * counts[b] / peak;
+            painter.fillRect(QRectF(barsLeft + b * kBarWidth, y + kRowHeight - 2 - height, kBarWidth - 1, height),
+                             kBucketLowerUs[b] >= 16667 ? QColor(235, 96, 80) : QColor(120, 200, 140));
+        }
+    }
+    painter.restore();
+}
+
+bool FrameStats::writeCsv(const QString &path, QString &errorMessage) const
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        errorMessage = QStringLiteral("Cannot write frame stats: %1").arg(path);
+        return false;
+    }
+
+    QTextStream out(&file);
+    out << "metric,lower_us,upper_us,count,window\n";
+    for (int i = 0; i < kMetricCount; ++i) {
+        const QVector<int> counts = histogram(static_cast<Metric>(i));
+        const int window = series[i].samples.size();
+        for (int b = 0; b < counts.size(); ++b) {
+            out << kMetricNames[i] << ',' << kBucketLowerUs[b] << ',';
+            if (b + 1 < counts.size()) {
+                out << kBucketLowerUs[b + 1];
+            }
+            out << ',' << counts[b] << ',' << window << '\n';
+        }
+    }
+    out.flush();
+
+    if (out.status() != QTextStream::Ok || !file.commit()) {
+        errorMessage = QStringLiteral("Failed to write frame stats: %1").arg(path);
+        return false;
+    }
+    return true;
+}
+
+qint64 FrameStats::now() const
+{
+    return clock.nsecsElapsed();
+}
+
+FrameStats::Summary FrameStats::summarize(Metric metric) const
+{
+    const Series &s = series[static_cast<int>(metric)];
+    Summary summary;
+    summary.count = s.samples.size();
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    summary.last = s.samples[(s.next + kWindow - 1) % kWindow];
+    QVector<qint64> sorted = s.samples;
+    std::sort(sorted.begin(), sorted.end());
+    summary.median = sorted[sorted.size() / 2];
+    summary.p95 = sorted[std::min<int>(sorted.size() - 1, sorted.size() * 95 / 100)];
+    summary.max = sorted.last();
+    return summary;
+}
+
+QVector<int> FrameStats::histogram(Metric metric) const
+{
+    QVector<int> counts(static_cast<int>(kBucketLowerUs.size()), 0);
+    for (const qint64 sample : series[static_cast<int>(metric)].samples) {
+        const qint64 us = sample / 1000;
+        const auto bucket = std::upper_bound(kBucketLowerUs.cbegin(), kBucketLowerUs.cend(), us) - kBucketLowerUs.cbegin() - 1;
+        ++counts[static_cast<int>(bucket)];
+    }
+    return counts;
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QElapsedTimer>
+#include <QRectF>
+#include <QString>
+#include <QVector>
+
+#include <array>
+
+class QPainter;
+
+// Developer timings for BoardView: rolling windows of the last samples of
+// each metric, summarised in an overlay and exportable as histograms. Nothing
+// is recorded while disabled, so the timers cost one branch each.
+class FrameStats
+{
+public:
+    enum class Metric {
+        Paint,      // one paintEvent, overlay excluded
+        Layout,     // geometry and label rebuilds
+        HitTest,    // point -> cell lookups
+        Latency,    // mouse press -> end of the next paint
+        Execute     // one GameSession::execute
+    };
+    static constexpr int kMetricCount = 5;
+    // Samples kept per metric.
+    static constexpr int kWindow = 600;
+
+    // Times its scope into `metric` when the stats are enabled.
+    class Scope
+    {
+    public:
+        Scope(FrameStats &stats, Metric metric);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        FrameStats &stats;
+        Metric metric;
+        qint64 start{-1};
+    };
+
+    FrameStats();
+
+    bool isEnabled() const;
+    // Disabling drops the recorded samples.
+    void setEnabled(bool on);
+
+    void add(Metric metric, qint64 nanoseconds);
+    // Starts a press-to-repaint measurement; framePainted() completes it.
+    void pressed();
+    // Forgets a press that will not repaint anything.
+    void dropPress();
+    void framePainted();
+
+    // Overlay box anchored at the top-left of `area`.
+    QRectF overlayRect(const QRectF &area) const;
+    void paint(QPainter &painter, const QRectF &area) const;
+
+    // One row per metric and histogram bucket:
+    // metric,lower_us,upper_us,count,window
+    bool writeCsv(const QString &path, QString &errorMessage) const;
+
+private:
+    struct Series {
+        QVector<qint64> samples; // ring buffer, nanoseconds
+        int next{0};
+    };
+    struct Summary {
+        qint64 last{0};
+        qint64 median{0};
+        qint64 p95{0};
+        qint64 max{0};
+        int count{0};
+    };
+
+    qint64 now() const;
+    Summary summarize(Metric metric) const;
+    QVector<int> histogram(Metric metric) const;
+
+    bool enabled{false};
+    QElapsedTimer clock;
+    qint64 pressedAt{-1};
+    std::array<Series, kMetricCount> series;
+};
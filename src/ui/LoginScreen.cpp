@@ -1,6 +1,7 @@
 #include "LoginScreen.h"
 
 #include <QVBoxLayout>
+#include <QCheckBox>
 #include <QHBoxLayout>
 #include <QLineEdit>
 #include <QLabel>
@@ -14,6 +15,11 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QIcon>
+#include <QPixmap>
+
+#include "MapLibrary.h"
 
 namespace
 {
@@ -23,7 +29,8 @@ const char *kBackgroundImageAlt = "assets/photos/image.png";
 }
 
 LoginScreen::LoginScreen(QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent),
+      background(this)
 {
     setupUi();
     setupStyles();
@@ -96,6 +103,15 @@ void LoginScreen::setupUi()
     makeRow(tr("Player One"), &playerOneEdit);
     makeRow(tr("Player Two"), &playerTwoEdit);
 
+    computerCheck = new QCheckBox(tr("Player Two is the computer"), card);
+    computerCheck->setObjectName("ComputerToggle");
+    computerCheck->setCursor(Qt::PointingHandCursor);
+    connect(computerCheck, &QCheckBox::toggled, this, [this](bool checked) {
+        playerTwoEdit->setEnabled(!checked);
+        handleInputChanged();
+    });
+    cardLayout->addWidget(computerCheck);
+
     errorLabel = new QLabel(this);
     errorLabel->setObjectName("ErrorLabel");
     errorLabel->setVisible(false);
@@ -191,6 +207,11 @@ void LoginScreen::setupStyles()
             border: 1px solid #6fa36f;
             background: rgba(255, 255, 255, 0.12);
         }
+        #ComputerToggle {
+            font-size: 13px;
+            font-weight: 600;
+            color: #e1d5c4;
+        }
         #ErrorLabel {
             color: #ffb4a9;
             font-size: 13px;
@@ -269,6 +290,10 @@ bool LoginScreen::validateForm(QString &errorMessage) const
         return false;
     }
 
+    if (computerCheck->isChecked()) {
+        return true;
+    }
+
     QString error2;
     if (!isNameValid(playerTwoEdit->text(), error2)) {
         errorMessage = tr("Player 2: %1").arg(error2);
@@ -292,38 +317,34 @@ QString LoginScreen::openMapDialog() const
     auto *label = new QLabel(tr("Choose a battlefield:"), &dialog);
     auto *list = new QListWidget(&dialog);
 
-    const QString base = QCoreApplication::applicationDirPath();
-    const QStringList dirs = {
-        base + QLatin1String("/assets/maps"),
-        QDir(base).filePath("../src/assets/maps"),
-        QDir::currentPath() + QLatin1String("/src/assets/maps"),
-        QDir::currentPath() + QLatin1String("/assets/maps")
-    };
-
-    QStringList added;
-    for (const QString &dirPath : dirs) {
-        QDir dir(dirPath);
-        if (!dir.exists()) continue;
-        const QStringList files = dir.entryList(QStringList() << "*.txt", QDir::Files, QDir::Name);
-        for (const QString &f : files) {
-            const QString abs = dir.filePath(f);
-            QString canon = QFileInfo(abs).canonicalFilePath();
-            if (canon.isEmpty()) {
-                canon = QFileInfo(abs).absoluteFilePath();
-            }
-            if (added.contains(canon)) continue;
-            added << canon;
-            auto *item = new QListWidgetItem(f, list);
-            item->setData(Qt::UserRole, canon);
+    // The scan and the thumbnails run on a worker; entries appear as they
+    // are ready, so the dialog opens at once.
+    const QSize thumbnailSize(96, 72);
+    list->setIconSize(thumbnailSize);
+    list->setSpacing(2);
+    auto *scanning = new QListWidgetItem(tr("Scanning maps..."), list);
+    scanning->setFlags(Qt::NoItemFlags);
+
+    QFutureWatcher<MapEntry> scan;
+    connect(&scan, &QFutureWatcher<MapEntry>::resultReadyAt, list, [&scan, list](int index) {
+        const MapEntry entry = scan.resultAt(index);
+        auto *item = new QListWidgetItem(entry.name, list);
+        item->setData(Qt::UserRole, entry.path);
+        if (!entry.thumbnail.isNull()) {
+            item->setIcon(QIcon(QPixmap::fromImage(entry.thumbnail)));
         }
-    }
-
-    if (list->count() == 0) {
-        auto *empty = new QListWidgetItem(tr("No map files found"), list);
-        empty->setFlags(Qt::NoItemFlags);
-    } else {
-        list->setCurrentRow(0);
-    }
+        if (list->currentItem() == nullptr) {
+            list->setCurrentItem(item);
+        }
+    });
+    connect(&scan, &QFutureWatcher<MapEntry>::finished, list, [scanning, list]() {
+        if (list->count() > 1) {
+            delete scanning;
+        } else {
+            scanning->setText(tr("No map files found"));
+        }
+    });
+    scan.setFuture(scanMaps(mapSearchDirs(), thumbnailSize, devicePixelRatioF()));
 
     auto *buttons = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel, Qt::Horizontal, &dialog);
     layout->addWidget(label);
@@ -333,7 +354,9 @@ QString LoginScreen::openMapDialog() const
     connect(buttons, &QDialogButtonBox::accepted, &dialog, &QDialog::accept);
     connect(buttons, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
 
-    if (dialog.exec() == QDialog::Accepted && list->currentItem()) {
+    const bool accepted = dialog.exec() == QDialog::Accepted;
+    scan.cancel();
+    if (accepted && list->currentItem()) {
         return list->currentItem()->data(Qt::UserRole).toString();
     }
 
@@ -355,7 +378,8 @@ void LoginScreen::handleStartClicked()
     }
 
     errorLabel->setVisible(false);
-    emit startRequested(playerOneEdit->text(), playerTwoEdit->text(), map);
+    const bool vsComputer = computerCheck->isChecked();
+    emit startRequested(playerOneEdit->text(), vsComputer ? tr("Computer") : playerTwoEdit->text(), map, vsComputer);
 }
 
 void LoginScreen::handleInputChanged()
@@ -388,35 +412,13 @@ void LoginScreen::loadBackground()
         QDir::currentPath() + QLatin1String("/src/assets/photos/image.png")
     };
 
-    for (const QString &path : candidates) {
-        if (!QFileInfo::exists(path)) {
-            continue;
-        }
-        QPixmap pix(path);
-        if (!pix.isNull()) {
-            bgPixmap = pix;
-            updateBackground();
-            return;
-        }
-    }
-
-    bgPixmap = QPixmap();
-}
-
-void LoginScreen::updateBackground()
-{
-    if (bgPixmap.isNull()) {
-        return;
-    }
-    const QSize targetSize = size() * devicePixelRatioF();
-    bgScaled = bgPixmap.scaled(targetSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-    bgScaled.setDevicePixelRatio(devicePixelRatioF());
+    background.load(candidates);
 }
 
 void LoginScreen::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
-    updateBackground();
+    background.resized();
 }
 
 void LoginScreen::paintEvent(QPaintEvent *event)
@@ -426,9 +428,7 @@ void LoginScreen::paintEvent(QPaintEvent *event)
 
     QRect targetRect = rect();
 
-    if (!bgScaled.isNull()) {
-        painter.drawPixmap(targetRect, bgScaled, bgScaled.rect());
-    } else {
+    if (!background.paint(painter, targetRect)) {
         QLinearGradient base(targetRect.topLeft(), targetRect.bottomRight());
         base.setColorAt(0.0, QColor(26, 22, 18));
         base.setColorAt(1.0, QColor(12, 10, 8));
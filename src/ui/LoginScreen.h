@@ -2,8 +2,10 @@
 
 #include <QWidget>
 #include <QString>
-#include <QPixmap>
 
+#include "BackdropImage.h"
+
+class QCheckBox;
 class QLabel;
 class QLineEdit;
 class QPushButton;
@@ -18,7 +20,7 @@ public:
     explicit LoginScreen(QWidget *parent = nullptr);
 
 signals:
-    void startRequested(const QString &playerOne, const QString &playerTwo, const QString &mapName);
+    void startRequested(const QString &playerOne, const QString &playerTwo, const QString &mapName, bool vsComputer);
 
 private slots:
     void handleStartClicked();
@@ -27,10 +29,10 @@ private slots:
 private:
     QLineEdit *playerOneEdit{};
     QLineEdit *playerTwoEdit{};
+    QCheckBox *computerCheck{};
     QLabel *errorLabel{};
     QPushButton *startButton{};
-    QPixmap bgPixmap{};
-    QPixmap bgScaled{};
+    BackdropImage background;
 
     void setupUi();
     void setupStyles();
@@ -38,7 +40,6 @@ private:
     bool validateForm(QString &errorMessage) const;
     QString openMapDialog() const;
     void loadBackground();
-    void updateBackground();
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -0,0 +1,234 @@
+#include "MapLibrary.h"
+
+#include "BoardGeometry.h"
+#include "BoardPalette.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QPainter>
+#include <QPromise>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTransform>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
+
+namespace {
+
+// Part of every cache key; bump it when the drawing below changes.
+const char *kThumbnailFormat = "map-thumbnail-1";
+
+// The board and scenario (empty for a bare board) behind one map file.
+bool mapSources(const QString &mapPath, QString &boardPath, QString &scenarioPath)
+{
+    bool isScenario = false;
+    QString error;
+    boardPath = resolveMapBoard(mapPath, isScenario, error);
+    scenarioPath = isScenario ? mapPath : QString();
+    return !boardPath.isEmpty();
+}
+
+bool hashFile(QCryptographicHash &hash, const QString &path)
+{
+    QFile file(path);
+    return file.open(QIODevice::ReadOnly) && hash.addData(&file);
+}
+
+QString thumbnailCacheDir()
+{
+    const QString base = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (base.isEmpty()) {
+        return {};
+    }
+    const QString dir = QDir(base).filePath(QStringLiteral("map-thumbnails"));
+    return QDir().mkpath(dir) ? dir : QString();
+}
+
+QImage thumbnailFor(const QString &mapPath, const QSize &pixelSize, const QString &cacheDir)
+{
+    QString boardPath;
+    QString scenarioPath;
+    if (!mapSources(mapPath, boardPath, scenarioPath)) {
+        return {};
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(QByteArray(kThumbnailFormat));
+    if (!hashFile(hash, boardPath) || (!scenarioPath.isEmpty() && !hashFile(hash, scenarioPath))) {
+        return {};
+    }
+
+    QString cachePath;
+    if (!cacheDir.isEmpty()) {
+        cachePath = QDir(cacheDir).filePath(QStringLiteral("%1-%2x%3.png")
+                                                .arg(QString::fromLatin1(hash.result().toHex()))
+                                                .arg(pixelSize.width())
+                                                .arg(pixelSize.height()));
+        QImage cached;
+        if (cached.load(cachePath, "PNG") && cached.size() == pixelSize) {
+            return cached;
+        }
+    }
+
+    QString error;
+    const QImage image = renderMapThumbnail(boardPath, scenarioPath, pixelSize, error);
+    if (!image.isNull() && !cachePath.isEmpty()) {
+        // A failed write only costs a render next time.
+        QSaveFile file(cachePath);
+        if (file.open(QIODevice::WriteOnly) && image.save(&file, "PNG")) {
+            file.commit();
+        }
+    }
+    return image;
+}
+
+} // namespace
+
+QStringList mapSearchDirs()
+{
+    const QString base = QCoreApplication::applicationDirPath();
+    return {
+        base + QLatin1String("/assets/maps"),
+        QDir(base).filePath("../src/assets/maps"),
+        QDir::currentPath() + QLatin1String("/src/assets/maps"),
+        QDir::currentPath() + QLatin1String("/assets/maps")
+    };
+}
+
+QString resolveMapBoard(const QString &mapPath, bool &isScenario, QString &errorMessage)
+{
+    isScenario = false;
+
+    QFile probe(mapPath);
+    if (!probe.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        errorMessage = QCoreApplication::translate("BoardView", "Cannot open selected file: %1").arg(mapPath);
+        return {};
+    }
+
+    QTextStream in(&probe);
+    QString firstNonEmpty;
+    while (!in.atEnd()) {
+        firstNonEmpty = in.readLine().trimmed();
+        if (!firstNonEmpty.isEmpty()) {
+            break;
+        }
+    }
+
+    if (firstNonEmpty.startsWith('|')) {
+        return QFileInfo(mapPath).absoluteFilePath();
+    }
+
+    isScenario = true;
+    const QString fileName = QFileInfo(mapPath).fileName();
+    const QString baseDir = QCoreApplication::applicationDirPath();
+    const QStringList candidates = {
+        baseDir + QLatin1String("/assets/boards/") + fileName,
+        QDir(baseDir).filePath(QStringLiteral("../src/assets/boards/") + fileName),
+        QDir::currentPath() + QLatin1String("/src/assets/boards/") + fileName,
+        QDir::currentPath() + QLatin1String("/assets/boards/") + fileName
+    };
+
+    for (const QString &candidate : candidates) {
+        if (QFileInfo::exists(candidate)) {
+            return QFileInfo(candidate).absoluteFilePath();
+        }
+    }
+
+    errorMessage = QCoreApplication::translate("BoardView", "Scenario selected but matching board file was not found: %1")
+                       .arg(fileName);
+    return {};
+}
+
+QFuture<MapEntry> scanMaps(const QStringList &dirs, const QSize &size, qreal devicePixelRatio)
+{
+    return QtConcurrent::run([dirs, size, devicePixelRatio](QPromise<MapEntry> &promise) {
+        const QSize pixelSize = size * devicePixelRatio;
+        const QString cacheDir = thumbnailCacheDir();
+
+        QStringList added;
+        for (const QString &dirPath : dirs) {
+            QDir dir(dirPath);
+            if (!dir.exists()) continue;
+            const QStringList files = dir.entryList(QStringList() << "*.txt", QDir::Files, QDir::Name);
+            for (const QString &f : files) {
+                if (promise.isCanceled()) {
+                    return;
+                }
+                const QString abs = dir.filePath(f);
+                QString canon = QFileInfo(abs).canonicalFilePath();
+                if (canon.isEmpty()) {
+                    canon = QFileInfo(abs).absoluteFilePath();
+                }
+                if (added.contains(canon)) continue;
+                added << canon;
+
+                MapEntry entry{f, canon, thumbnailFor(canon, pixelSize, cacheDir)};
+                entry.thumbnail.setDevicePixelRatio(devicePixelRatio);
+                promise.addResult(std::move(entry));
+            }
+        }
+    });
+}
+
+QImage renderMapThumbnail(const QString &boardPath,
+                          const QString &scenarioPath,
+                          const QSize &pixelSize,
+                          QString &errorMessage)
+{
+    model::GameState state = model::buildInitialGameState(QStringLiteral("A"), QStringLiteral("B"));
+    if (!model::loadBoardFromMapFile(state.board, boardPath, errorMessage)) {
+        return {};
+    }
+    if (!scenarioPath.isEmpty() && !model::loadScenarioFromFile(state, scenarioPath, errorMessage)) {
+        return {};
+    }
+
+    // BoardGeometry keeps hexes at 14 px or more and insets the area by 18 px;
+    // widen the area by that inset and pass the fitted radius as a zoom.
+    const QRectF frame(QPointF(), QSizeF(pixelSize));
+    const QRectF area = frame.adjusted(-18, -18, 18, 18);
+    BoardGeometry geometry;
+    geometry.build(state.board, area, 1.0);
+    if (!geometry.isValid()) {
+        errorMessage = QStringLiteral("Board has no cells: %1").arg(boardPath);
+        return {};
+    }
+    const QSizeF units = geometry.unitSize();
+    const qreal fit = std::min(frame.width() / units.width(), frame.height() / units.height());
+    geometry.build(state.board, area, 1.0, fit * 0.94 / geometry.fitRadius());
+
+    QImage image(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    image.fill(Qt::transparent);
+    QPainter p(&image);
+    p.setRenderHint(QPainter::Antialiasing, true);
+
+    const qreal radius = geometry.radius();
+    const QPen cellPen = radius < 4 ? QPen(Qt::NoPen) : QPen(QColor(20, 24, 20, 110), 1.0);
+    const qreal controlWidth = std::max(1.0, radius * 0.18);
+    for (int index = 0; index < geometry.cellCount(); ++index) {
+        const model::CellNode *cell = state.board.cells[index].get();
+        const QPointF center = geometry.center(index);
+        p.setTransform(QTransform::fromTranslate(center.x(), center.y()));
+
+        if (cell->controlledBy == model::PlayerId::None) {
+            p.setPen(cellPen);
+        } else {
+            const QColor owner = cell->controlledBy == model::PlayerId::A ? BoardPalette::kPlayerA : BoardPalette::kPlayerB;
+            p.setPen(QPen(owner, controlWidth));
+        }
+        p.setBrush(BoardPalette::shieldColor(cell->shield));
+        p.drawPath(geometry.hexPath());
+
+        if (cell->occupantA || cell->occupantB) {
+            p.setPen(Qt::NoPen);
+            p.setBrush(cell->occupantA ? BoardPalette::kPlayerA : BoardPalette::kPlayerB);
+            p.drawEllipse(QPointF(), radius * 0.45, radius * 0.45);
+        }
+    }
+    return image;
+}
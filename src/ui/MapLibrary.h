@@ -0,0 +1,40 @@
+#pragma once
+
+#include <QFuture>
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+
+// One map file offered by the map dialog.
+struct MapEntry {
+    QString name;
+    // Canonical path, as passed on to BoardView.
+    QString path;
+    // Null when the board or scenario could not be loaded.
+    QImage thumbnail;
+};
+
+// Directories searched for map files, in order.
+QStringList mapSearchDirs();
+
+// Board behind the map file `mapPath`. A file whose first line is a board row
+// is a bare board and resolves to itself; anything else is a scenario
+// (`isScenario`) for the board of the same file name in the first of the
+// board directories that has one. Returns an empty path on failure.
+QString resolveMapBoard(const QString &mapPath, bool &isScenario, QString &errorMessage);
+
+// Lists the `*.txt` files in `dirs` on a worker thread and reports one entry
+// per distinct file, each with a thumbnail of `size` logical pixels at
+// `devicePixelRatio`. Thumbnails are read from the disk cache when the board
+// and scenario files hash to a cached one, and rendered offscreen otherwise.
+// Cancelling the future stops the scan after the current entry.
+QFuture<MapEntry> scanMaps(const QStringList &dirs, const QSize &size, qreal devicePixelRatio);
+
+// Draws the board of `boardPath` with the start position of `scenarioPath`
+// (empty for a bare board) into an image of `pixelSize`. Safe off the GUI
+// thread.
+QImage renderMapThumbnail(const QString &boardPath,
+                          const QString &scenarioPath,
+                          const QSize &pixelSize,
+                          QString &errorMessage);
@@ -3,8 +3,6 @@
 #include <QApplication>
 #include <QCoreApplication>
 #include <QDir>
-#include <QFileInfo>
-#include <QPixmap>
 #include <QResizeEvent>
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -21,7 +19,8 @@ const char *kSplashImageAlt = "assets/photos/image.png";
 }
 
 SplashScreen::SplashScreen(QWidget *parent)
-    : QWidget(parent)
+    : QWidget(parent),
+      hero(this)
 {
     setupUi();
     setupStyles();
@@ -91,30 +90,7 @@ void SplashScreen::loadHeroImage()
         QDir::currentPath() + QLatin1String("/src/assets/photos/image.png")
     };
 
-    for (const QString &path : candidates) {
-        if (!QFileInfo::exists(path)) {
-            continue;
-        }
-        QPixmap pix(path);
-        if (!pix.isNull()) {
-            heroPixmap = pix;
-            updateHeroPixmap();
-            return;
-        }
-    }
-
-    heroPixmap = QPixmap();
-}
-
-void SplashScreen::updateHeroPixmap()
-{
-    if (heroPixmap.isNull()) {
-        return;
-    }
-
-    const QSize targetSize = size() * devicePixelRatioF();
-    heroScaled = heroPixmap.scaled(targetSize, Qt::KeepAspectRatioByExpanding, Qt::SmoothTransformation);
-    heroScaled.setDevicePixelRatio(devicePixelRatioF());
+    hero.load(candidates);
 }
 
 void SplashScreen::handlePlayClicked()
@@ -125,7 +101,7 @@ void SplashScreen::handlePlayClicked()
 void SplashScreen::resizeEvent(QResizeEvent *event)
 {
     QWidget::resizeEvent(event);
-    updateHeroPixmap();
+    hero.resized();
 }
 
 void SplashScreen::paintEvent(QPaintEvent *event)
@@ -135,9 +111,7 @@ void SplashScreen::paintEvent(QPaintEvent *event)
 
     QRect targetRect = rect();
 
-    if (!heroScaled.isNull()) {
-        painter.drawPixmap(targetRect, heroScaled, heroScaled.rect());
-    } else {
+    if (!hero.paint(painter, targetRect)) {
         QLinearGradient grad(targetRect.topLeft(), targetRect.bottomLeft());
         grad.setColorAt(0.0, QColor(20, 24, 32));
         grad.setColorAt(1.0, QColor(9, 11, 18));
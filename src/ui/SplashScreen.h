@@ -1,7 +1,8 @@
 #pragma once
 
 #include <QWidget>
-#include <QPixmap>
+
+#include "BackdropImage.h"
 
 class QPushButton;
 class QPaintEvent;
@@ -22,13 +23,11 @@ private slots:
 
 private:
     QPushButton *playButton{};
-    QPixmap heroPixmap{};
-    QPixmap heroScaled{};
+    BackdropImage hero;
 
     void setupUi();
     void setupStyles();
     void loadHeroImage();
-    void updateHeroPixmap();
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
@@ -0,0 +1,249 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+namespace {
+
+using model::ArchiveColumn;
+
+QString percent(qint64 part, qint64 total)
+{
+    return total > 0 ? QString::number(100.0 * part / total, 'f', 1) + QLatin1Char('%') : QStringLiteral("-");
+}
+
+int buildArchive(const QStringList &args, QTextStream &out, QTextStream &err)
+{
+    if (args.size() < 2) {
+        err << "usage: undaunted-archive build <archive.udca> <journal>...\n";
+        return 1;
+    }
+
+    model::GameArchiveWriter writer;
+    QString errorMessage;
+    int skipped = 0;
+    for (int i = 1; i < args.size(); ++i) {
+        model::ReplayJournalReader reader;
+        if (!reader.open(args[i], errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        model::ReplayGame game;
+        while (reader.next(game, errorMessage)) {
+            // Only finished games; sessions closed mid-game would skew every
+            // per-game aggregate.
+            if (game.finalStatus == model::GameStatus::InProgress) {
+                ++skipped;
+            } else if (!writer.addGame(game, errorMessage)) {
+                err << args[i] << ": " << errorMessage << '\n';
+                ++skipped;
+            }
+            game = model::ReplayGame();
+        }
+        if (!errorMessage.isEmpty()) {
+            err << args[i] << ": " << errorMessage << '\n';
+        }
+    }
+
+    if (!writer.write(args[0], errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+    out << "wrote " << writer.gameCount() << " games to " << args[0] << " (" << skipped << " skipped)\n";
+    return 0;
+}
+
+void printInfo(const model::GameArchive &archive, QTextStream &out)
+{
+    out << "maps: " << archive.mapNames().join(QStringLiteral(", ")) << '\n';
+    for (int i = 0; i < model::kArchiveColumnCount; ++i) {
+        const auto column = static_cast<ArchiveColumn>(i);
+        out << model::archiveColumnName(column).leftJustified(18) << archive.rows(column) << " rows, " << archive.storedBytes(column) << " bytes, max "
+            << archive.maxValue(column) << '\n';
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-archive"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Builds a columnar archive of finished games from replay journals and runs aggregate queries over it.\n\n"
+        "  build <archive> <journal>...   convert journals\n"
+        "  info <archive>                 list columns and sizes\n"
+        "  winrate <archive>              win rate by map\n"
+        "  length <archive>               game length by map\n"
+        "  hits <archive>                 attack hit rate by threshold and dice\n"
+        "  actions <archive>              action mix by agent\n"
+        "  count <archive> <col> [<col>]  row counts per value (pair)"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("command"), QStringLiteral("build, info, winrate, length, hits, actions or count."));
+    parser.addPositionalArgument(QStringLiteral("args"), QStringLiteral("Command arguments."), QStringLiteral("args..."));
+
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Query threads (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    parser.addOption(threadsOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    QStringList args = parser.positionalArguments();
+    if (args.size() < 2) {
+        parser.showHelp(1);
+    }
+    const QString command = args.takeFirst();
+    if (command == QLatin1String("build")) {
+        return buildArchive(args, out, err);
+    }
+
+    model::GameArchive archive;
+    QString errorMessage;
+    if (!archive.open(args[0], errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+    if (command == QLatin1String("info")) {
+        printInfo(archive, out);
+        return 0;
+    }
+
+    const int threads = parser.value(threadsOption).toInt();
+    QElapsedTimer timer;
+    timer.start();
+    qint64 scanned = 0;
+    const auto tabulate = [&](ArchiveColumn a, ArchiveColumn b, QVector<qint64> &counts) {
+        if (!archive.crossTabulate(a, b, threads, counts, errorMessage)) {
+            err << errorMessage << '\n';
+            return false;
+        }
+        scanned += archive.rows(a) * (a == b ? 1 : 2);
+        return true;
+    };
+    const QStringList &maps = archive.mapNames();
+
+    QVector<qint64> counts;
+    if (command == QLatin1String("winrate")) {
+        if (!tabulate(ArchiveColumn::GameMap, ArchiveColumn::GameWinner, counts)) {
+            return 1;
+        }
+        const int stride = int(archive.maxValue(ArchiveColumn::GameWinner)) + 1;
+        const auto at = [&](int map, model::GameStatus status) {
+            const int winner = static_cast<int>(status);
+            return winner < stride ? counts[map * stride + winner] : 0;
+        };
+        out << "map       games   A wins   B wins\n";
+        for (int map = 0; map < maps.size(); ++map) {
+            const qint64 a = at(map, model::GameStatus::WonByA);
+            const qint64 b = at(map, model::GameStatus::WonByB);
+            out << maps[map].leftJustified(8) << QString::number(a + b).rightJustified(7) << "  "
+                << percent(a, a + b).rightJustified(7) << "  " << percent(b, a + b).rightJustified(7) << '\n';
+        }
+    } else if (command == QLatin1String("length")) {
+        if (!tabulate(ArchiveColumn::GameMap, ArchiveColumn::GameTurns, counts)) {
+            return 1;
+        }
+        const int stride = int(archive.maxValue(ArchiveColumn::GameTurns)) + 1;
+        out << "map       games     mean   median      max\n";
+        for (int map = 0; map < maps.size(); ++map) {
+            qint64 games = 0;
+            qint64 turns = 0;
+            int longest = 0;
+            for (int length = 0; length < stride; ++length) {
+                const qint64 n = counts[map * stride + length];
+                games += n;
+                turns += n * length;
+                longest = n > 0 ? length : longest;
+            }
+            int median = 0;
+            qint64 seen = counts[map * stride];
+            while (median + 1 < stride && seen * 2 < games) {
+                seen += counts[map * stride + ++median];
+            }
+            out << maps[map].leftJustified(8) << QString::number(games).rightJustified(7)
+                << QString::number(games > 0 ? double(turns) / games : 0.0, 'f', 1).rightJustified(9)
+                << QString::number(median).rightJustified(9) << QString::number(longest).rightJustified(9) << '\n';
+        }
+    } else if (command == QLatin1String("hits")) {
+        QVector<qint64> dice;
+        if (!tabulate(ArchiveColumn::AttackThreshold, ArchiveColumn::AttackHit, counts) ||
+            !tabulate(ArchiveColumn::AttackThreshold, ArchiveColumn::AttackDice, dice)) {
+            return 1;
+        }
+        const int hitStride = int(archive.maxValue(ArchiveColumn::AttackHit)) + 1;
+        const int diceStride = int(archive.maxValue(ArchiveColumn::AttackDice)) + 1;
+        out << "threshold  attacks  hit rate  dice/attack\n";
+        for (int threshold = 0; threshold <= int(archive.maxValue(ArchiveColumn::AttackThreshold)); ++threshold) {
+            const qint64 misses = counts[threshold * hitStride];
+            const qint64 hits = hitStride > 1 ? counts[threshold * hitStride + 1] : 0;
+            qint64 totalDice = 0;
+            for (int n = 0; n < diceStride; ++n) {
+                totalDice += n * dice[threshold * diceStride + n];
+            }
+            if (hits + misses == 0) {
+                continue;
+            }
+            out << QString::number(threshold).rightJustified(9) << QString::number(hits + misses).rightJustified(9)
+                << percent(hits, hits + misses).rightJustified(10)
+                << QString::number(double(totalDice) / (hits + misses), 'f', 2).rightJustified(13) << '\n';
+        }
+    } else if (command == QLatin1String("actions")) {
+        if (!tabulate(ArchiveColumn::ActionAgent, ArchiveColumn::ActionKind, counts)) {
+            return 1;
+        }
+        const int stride = int(archive.maxValue(ArchiveColumn::ActionKind)) + 1;
+        const char *kinds[] = {"move", "attack", "mark", "control", "release"};
+        out << "agent     ";
+        for (int kind = 0; kind < stride && kind < 5; ++kind) {
+            out << QString::fromLatin1(kinds[kind]).rightJustified(9);
+        }
+        out << '\n';
+        for (int agent = 0; agent <= int(archive.maxValue(ArchiveColumn::ActionAgent)); ++agent) {
+            qint64 total = 0;
+            for (int kind = 0; kind < stride; ++kind) {
+                total += counts[agent * stride + kind];
+            }
+            out << model::agentTypeName(static_cast<model::AgentType>(agent)).leftJustified(10);
+            for (int kind = 0; kind < stride && kind < 5; ++kind) {
+                out << percent(counts[agent * stride + kind], total).rightJustified(9);
+            }
+            out << '\n';
+        }
+    } else if (command == QLatin1String("count")) {
+        ArchiveColumn a;
+        ArchiveColumn b;
+        if (args.size() < 2 || !model::parseArchiveColumn(args[1], a) ||
+            !model::parseArchiveColumn(args.value(2, args[1]), b)) {
+            err << "count needs one or two column names; see 'info'.\n";
+            return 1;
+        }
+        if (!tabulate(a, b, counts)) {
+            return 1;
+        }
+        const int stride = int(archive.maxValue(b)) + 1;
+        for (int i = 0; i < counts.size(); ++i) {
+            if (counts[i] == 0) {
+                continue;
+            }
+            out << (i / stride);
+            if (a != b) {
+                out << ' ' << (i % stride);
+            }
+            out << '\t' << counts[i] << '\n';
+        }
+    } else {
+        parser.showHelp(1);
+    }
+
+    const qint64 elapsedNs = std::max<qint64>(timer.nsecsElapsed(), 1);
+    err << "scanned " << scanned << " values in " << QString::number(elapsedNs / 1e6, 'f', 1) << " ms ("
+        << QString::number(scanned * 1e3 / elapsedNs, 'f', 0) << " M values/s)\n";
+    return 0;
+}
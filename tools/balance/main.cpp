@@ -0,0 +1,139 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-balance"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Estimates whether scenarios are fair, stopping each as soon as the answer is clear."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("scenarios"), QStringLiteral("Scenario files (src/assets/maps/*.txt); boards are looked up in ../boards."), QStringLiteral("scenario..."));
+
+    const QCommandLineOption policyOption(QStringLiteral("policy"), QStringLiteral("random or search."), QStringLiteral("policy"), QStringLiteral("random"));
+    const QCommandLineOption depthOption(QStringLiteral("depth"), QStringLiteral("Search depth for --policy search."), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption marginOption(QStringLiteral("margin"), QStringLiteral("Largest score deviation from 0.5 still called fair."), QStringLiteral("x"), QStringLiteral("0.05"));
+    const QCommandLineOption alphaOption(QStringLiteral("alpha"), QStringLiteral("SPRT false-positive rate."), QStringLiteral("x"), QStringLiteral("0.05"));
+    const QCommandLineOption betaOption(QStringLiteral("beta"), QStringLiteral("SPRT false-negative rate."), QStringLiteral("x"), QStringLiteral("0.05"));
+    const QCommandLineOption precisionOption(QStringLiteral("precision"), QStringLiteral("Stop when the 95% interval half-width is below this."), QStringLiteral("x"), QStringLiteral("0.005"));
+    const QCommandLineOption batchOption(QStringLiteral("batch"), QStringLiteral("Games between stopping checks."), QStringLiteral("n"), QStringLiteral("1024"));
+    const QCommandLineOption maxGamesOption(QStringLiteral("max-games"), QStringLiteral("Hard cap per scenario."), QStringLiteral("n"), QStringLiteral("1000000"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turns before a game counts as unfinished."), QStringLiteral("n"), QStringLiteral("400"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Worker threads (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for decks and dice."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption reportOption(QStringLiteral("report"), QStringLiteral("Also write the report as CSV."), QStringLiteral("path"));
+    const QCommandLineOption verboseOption(QStringLiteral("verbose"), QStringLiteral("Print the running estimate after every batch."));
+    parser.addOption(policyOption);
+    parser.addOption(depthOption);
+    parser.addOption(marginOption);
+    parser.addOption(alphaOption);
+    parser.addOption(betaOption);
+    parser.addOption(precisionOption);
+    parser.addOption(batchOption);
+    parser.addOption(maxGamesOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(reportOption);
+    parser.addOption(verboseOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList scenarios = parser.positionalArguments();
+    if (scenarios.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    model::BalanceOptions options;
+    const QString policy = parser.value(policyOption);
+    if (policy == QLatin1String("search")) {
+        options.policy = model::BalancePolicy::Search;
+    } else if (policy != QLatin1String("random")) {
+        err << "unknown policy: " << policy << '\n';
+        return 1;
+    }
+    options.searchDepth = std::max(parser.value(depthOption).toInt(), 1);
+    options.margin = std::clamp(parser.value(marginOption).toDouble(), 0.001, 0.499);
+    options.alpha = std::clamp(parser.value(alphaOption).toDouble(), 1e-6, 0.5);
+    options.beta = std::clamp(parser.value(betaOption).toDouble(), 1e-6, 0.5);
+    options.precision = std::max(parser.value(precisionOption).toDouble(), 0.0);
+    options.batchGames = std::max<qint64>(parser.value(batchOption).toLongLong(), 1);
+    options.maxGames = std::max<qint64>(parser.value(maxGamesOption).toLongLong(), 1);
+    options.maxTurns = std::max(parser.value(maxTurnsOption).toInt(), 1);
+    options.threads = parser.value(threadsOption).toInt();
+    options.seed = parser.value(seedOption).toULongLong();
+
+    const auto percent = [](double value) {
+        return QString::number(value * 100.0, 'f', 1);
+    };
+
+    QVector<model::BalanceReport> reports;
+    for (const QString &scenario : scenarios) {
+        const QFileInfo scenarioInfo(scenario);
+        const QString board = scenarioInfo.dir().filePath(QStringLiteral("../boards/") + scenarioInfo.fileName());
+
+        model::BalanceReport report;
+        QString errorMessage;
+        const bool verbose = parser.isSet(verboseOption);
+        const bool ok = model::analyzeScenarioBalance(board, scenario, options, report, errorMessage,
+                                                      [&](const model::BalanceReport &running) {
+            if (verbose) {
+                out << "  " << running.scenario << ": " << running.games << " games, A "
+                    << percent(running.scoreA) << "% [" << percent(running.low) << ", " << percent(running.high)
+                    << "]  llr " << QString::number(running.llrFavorsA, 'f', 2) << " / "
+                    << QString::number(running.llrFavorsB, 'f', 2) << '\n';
+                out.flush();
+            }
+        });
+        if (!ok) {
+            err << scenario << ": " << errorMessage << '\n';
+            return 1;
+        }
+        reports.append(report);
+    }
+
+    out << "scenario  games     A wins  B wins  unfinished  A score  95% interval    verdict    stopped by  time\n";
+    for (const model::BalanceReport &report : reports) {
+        out << report.scenario.leftJustified(8) << "  " << QString::number(report.games).leftJustified(8)
+            << "  " << QString::number(report.winsA).leftJustified(6) << "  " << QString::number(report.winsB).leftJustified(6)
+            << "  " << QString::number(report.unfinished).leftJustified(10) << "  " << (percent(report.scoreA) + '%').leftJustified(7)
+            << "  " << QStringLiteral("[%1, %2]").arg(percent(report.low), percent(report.high)).leftJustified(14)
+            << "  " << model::balanceVerdictName(report.verdict).leftJustified(9) << "  " << report.stopReason.leftJustified(10)
+            << "  " << QString::number(report.elapsedMs / 1000.0, 'f', 1) << " s\n";
+    }
+
+    if (parser.isSet(reportOption)) {
+        QSaveFile file(parser.value(reportOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "Cannot write report: " << parser.value(reportOption) << '\n';
+            return 1;
+        }
+        QTextStream csv(&file);
+        csv << "scenario,games,wins_a,wins_b,unfinished,avg_turns,score_a,low,high,llr_a,llr_b,verdict,stopped_by,seconds\n";
+        for (const model::BalanceReport &report : reports) {
+            csv << report.scenario << ',' << report.games << ',' << report.winsA << ',' << report.winsB << ','
+                << report.unfinished << ',' << QString::number(double(report.totalTurns) / std::max<qint64>(report.games, 1), 'f', 1) << ','
+                << QString::number(report.scoreA, 'f', 4) << ',' << QString::number(report.low, 'f', 4) << ','
+                << QString::number(report.high, 'f', 4) << ',' << QString::number(report.llrFavorsA, 'f', 3) << ','
+                << QString::number(report.llrFavorsB, 'f', 3) << ',' << model::balanceVerdictName(report.verdict) << ','
+                << report.stopReason << ',' << QString::number(report.elapsedMs / 1000.0, 'f', 2) << '\n';
+        }
+        csv.flush();
+        if (!file.commit()) {
+            err << "Failed to write report: " << parser.value(reportOption) << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
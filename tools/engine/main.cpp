@@ -0,0 +1,43 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <cstdio>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-engine"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless engine speaking the line protocol on stdin/stdout (see README.md)."));
+    parser.addHelpOption();
+    parser.process(app);
+
+    // Search info arrives from the worker thread, so every line is written
+    // and flushed under one lock to keep lines whole.
+    QMutex outputMutex;
+    QTextStream out(stdout);
+    model::EngineProtocol engine([&](const QString &line) {
+        QMutexLocker locker(&outputMutex);
+        out << line << '\n';
+        out.flush();
+    });
+
+    QTextStream in(stdin);
+    QString line;
+    while (in.readLineInto(&line)) {
+        if (!engine.handleLine(line)) {
+            return 0;
+        }
+    }
+
+    // End of input behaves like "quit" but lets a running search finish, so
+    // a piped script ending in "go" still gets its bestmove.
+    engine.waitForSearch();
+    return 0;
+}
@@ -0,0 +1,113 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-features"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Writes labelled feature tensors for evaluator training, from self-play games or replay journals."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("inputs"),
+                                 QStringLiteral("Scenario files (boards are looked up in ../boards), or journals with --journal."),
+                                 QStringLiteral("input..."));
+
+    const QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("Output file."), QStringLiteral("path"), QStringLiteral("features.udft"));
+    const QCommandLineOption journalOption(QStringLiteral("journal"), QStringLiteral("Inputs are replay journals rather than scenarios."));
+    const QCommandLineOption gamesOption(QStringLiteral("games"), QStringLiteral("Self-play games, spread over the scenarios."), QStringLiteral("n"), QStringLiteral("1000"));
+    const QCommandLineOption policyOption(QStringLiteral("policy"), QStringLiteral("random or search."), QStringLiteral("policy"), QStringLiteral("random"));
+    const QCommandLineOption depthOption(QStringLiteral("depth"), QStringLiteral("Search depth for --policy search."), QStringLiteral("n"), QStringLiteral("1"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turns before a game counts as unfinished."), QStringLiteral("n"), QStringLiteral("400"));
+    const QCommandLineOption formatOption(QStringLiteral("format"), QStringLiteral("int8 or float32."), QStringLiteral("format"), QStringLiteral("int8"));
+    const QCommandLineOption chunkOption(QStringLiteral("chunk"), QStringLiteral("Samples per chunk."), QStringLiteral("n"), QStringLiteral("4096"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Encoding threads (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for decks, dice and random moves."), QStringLiteral("seed"), QStringLiteral("1"));
+    parser.addOption(outOption);
+    parser.addOption(journalOption);
+    parser.addOption(gamesOption);
+    parser.addOption(policyOption);
+    parser.addOption(depthOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(formatOption);
+    parser.addOption(chunkOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList inputs = parser.positionalArguments();
+    if (inputs.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    model::FeatureExportOptions options;
+    const QString policy = parser.value(policyOption);
+    if (policy == QLatin1String("search")) {
+        options.policy = model::FeaturePolicy::Search;
+    } else if (policy != QLatin1String("random")) {
+        err << "unknown policy: " << policy << '\n';
+        return 1;
+    }
+    const QString format = parser.value(formatOption);
+    if (format == QLatin1String("float32")) {
+        options.format = model::FeatureFormat::Float32;
+    } else if (format != QLatin1String("int8")) {
+        err << "unknown format: " << format << '\n';
+        return 1;
+    }
+    options.searchDepth = std::max(parser.value(depthOption).toInt(), 1);
+    options.games = std::max<qint64>(parser.value(gamesOption).toLongLong(), 1);
+    options.maxTurns = std::max(parser.value(maxTurnsOption).toInt(), 1);
+    options.chunkSamples = std::max(parser.value(chunkOption).toInt(), 1);
+    options.threads = parser.value(threadsOption).toInt();
+    options.seed = parser.value(seedOption).toULongLong();
+
+    const QString path = parser.value(outOption);
+    model::FeatureExportStats stats;
+    QString errorMessage;
+    if (parser.isSet(journalOption)) {
+        QStringList warnings;
+        if (!model::exportJournalFeatures(inputs, options, path, stats, warnings, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        for (const QString &warning : warnings) {
+            err << warning << '\n';
+        }
+    } else {
+        QVector<model::SelfPlayOpening> openings;
+        for (const QString &scenario : inputs) {
+            const QFileInfo scenarioInfo(scenario);
+            const QString board = scenarioInfo.dir().filePath(QStringLiteral("../boards/") + scenarioInfo.fileName());
+            model::SelfPlayOpening opening;
+            if (!model::loadSelfPlayOpening(board, scenario, static_cast<quint32>(options.seed), opening, errorMessage)) {
+                err << scenario << ": " << errorMessage << '\n';
+                return 1;
+            }
+            openings.append(opening);
+        }
+
+        if (!model::exportSelfPlayFeatures(openings, options, path, stats, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+    }
+
+    const double seconds = std::max<qint64>(stats.elapsedMs, 1) / 1000.0;
+    out << "wrote " << stats.samples << " samples from " << stats.games << " games to " << path << " ("
+        << stats.bytes << " bytes)\n";
+    out << "results: A " << stats.winsA << ", B " << stats.winsB << ", unfinished " << stats.unfinished << '\n';
+    out << QString::number(seconds, 'f', 2) << " s, " << QString::number(stats.samples / seconds, 'f', 0) << " samples/s\n";
+    return 0;
+}
@@ -0,0 +1,395 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QLocalSocket>
+#include <QRandomGenerator>
+#include <QTcpSocket>
+#include <QTextStream>
+#include <QTimer>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace {
+
+enum class RequestKind {
+    Create,
+    Legal,
+    Action,
+    Close
+};
+
+// One simulated game; it always has exactly one request in flight.
+struct GameSlot {
+    quint32 session{0};
+    model::WireSnapshot state;
+    int turns{0};
+};
+
+struct PendingRequest {
+    int slot{0};
+    RequestKind kind{RequestKind::Create};
+    qint64 sentNs{0};
+};
+
+struct SimulatedClient {
+    QIODevice *socket = nullptr;
+    QByteArray inbox;
+    QVector<GameSlot> gameSlots;
+    QHash<quint32, PendingRequest> pending;
+    quint32 nextRequest{1};
+};
+
+struct LoadTest {
+    QStringList maps;
+    int games{0};
+    int maxTurns{0};
+    quint32 seed{0};
+    QRandomGenerator rng;
+    QElapsedTimer clock;
+
+    int started{0};
+    int finished{0};
+    int winsA{0};
+    int winsB{0};
+    qint64 actions{0};
+    qint64 errors{0};
+    qint64 bytesOut{0};
+    qint64 bytesIn{0};
+    QVector<qint64> latenciesUs;
+    QString fatal;
+};
+
+void send(LoadTest &test, SimulatedClient &client, const model::WireWriter &writer)
+{
+    const QByteArray frame = writer.frame();
+    client.socket->write(frame);
+    test.bytesOut += frame.size();
+}
+
+quint32 beginRequest(LoadTest &test, SimulatedClient &client, int slot, RequestKind kind)
+{
+    const quint32 request = client.nextRequest++;
+    client.pending.insert(request, PendingRequest{slot, kind, test.clock.nsecsElapsed()});
+    return request;
+}
+
+void requestCreate(LoadTest &test, SimulatedClient &client, int slot)
+{
+    const int game = test.started++;
+    model::WireWriter writer(model::WireMessage::CreateSession);
+    writer.u32(beginRequest(test, client, slot, RequestKind::Create));
+    writer.u32(test.seed + static_cast<quint32>(game));
+    writer.string(test.maps[game % test.maps.size()]);
+    send(test, client, writer);
+}
+
+void requestSession(LoadTest &test, SimulatedClient &client, int slot, RequestKind kind)
+{
+    model::WireWriter writer(kind == RequestKind::Legal ? model::WireMessage::Legal : model::WireMessage::CloseSession);
+    writer.u32(beginRequest(test, client, slot, kind));
+    writer.u32(client.gameSlots[slot].session);
+    send(test, client, writer);
+}
+
+void requestAction(LoadTest &test, SimulatedClient &client, int slot, quint8 kind, quint16 cell)
+{
+    model::WireWriter writer(model::WireMessage::Action);
+    writer.u32(beginRequest(test, client, slot, RequestKind::Action));
+    writer.u32(client.gameSlots[slot].session);
+    writer.u8(kind);
+    writer.u16(cell);
+    send(test, client, writer);
+}
+
+void continueGame(LoadTest &test, SimulatedClient &client, int slot)
+{
+    const GameSlot &game = client.gameSlots[slot];
+    const bool over = game.state.status != model::GameStatus::InProgress || game.turns >= test.maxTurns;
+    requestSession(test, client, slot, over ? RequestKind::Close : RequestKind::Legal);
+}
+
+// Returns false on a protocol violation by the server.
+bool handleFrame(LoadTest &test, SimulatedClient &client, const QByteArray &payload)
+{
+    model::WireReader reader(payload);
+    if (reader.type() == model::WireMessage::Welcome) {
+        return true;
+    }
+
+    const quint32 request = reader.u32();
+    if (reader.type() == model::WireMessage::Error && request == 0) {
+        test.fatal = QStringLiteral("Server dropped the connection: %1").arg(reader.string());
+        return false;
+    }
+    const auto found = client.pending.find(request);
+    if (!reader.ok() || found == client.pending.end()) {
+        test.fatal = QStringLiteral("Reply to unknown request %1").arg(request);
+        return false;
+    }
+    const PendingRequest pending = *found;
+    client.pending.erase(found);
+    test.latenciesUs.append((test.clock.nsecsElapsed() - pending.sentNs) / 1000);
+
+    GameSlot &game = client.gameSlots[pending.slot];
+    QString errorMessage;
+    switch (reader.type()) {
+    case model::WireMessage::SessionCreated: {
+        game = GameSlot{};
+        game.session = reader.u32();
+        game.state.cells.resize(reader.u16());
+        for (int i = 0; i < game.state.cells.size(); ++i) {
+            reader.string();
+        }
+        if (!model::readWireDelta(reader, game.state, errorMessage)) {
+            test.fatal = errorMessage;
+            return false;
+        }
+        continueGame(test, client, pending.slot);
+        return true;
+    }
+    case model::WireMessage::LegalActions: {
+        reader.u32();
+        const int count = reader.u16();
+        if (count == 0) {
+            // The side to move is stalled; nothing left to play.
+            requestSession(test, client, pending.slot, RequestKind::Close);
+            return true;
+        }
+        const int choice = static_cast<int>(test.rng.bounded(count));
+        quint8 kind = 0;
+        quint16 cell = 0;
+        for (int i = 0; i <= choice; ++i) {
+            kind = reader.u8();
+            cell = reader.u16();
+        }
+        if (!reader.ok()) {
+            test.fatal = QStringLiteral("Truncated legal action list");
+            return false;
+        }
+        requestAction(test, client, pending.slot, kind, cell);
+        return true;
+    }
+    case model::WireMessage::ActionResult: {
+        reader.u32();
+        if (reader.u8() == 0) {
+            ++test.errors;
+            requestSession(test, client, pending.slot, RequestKind::Close);
+            return true;
+        }
+        if (!model::readWireDelta(reader, game.state, errorMessage)) {
+            test.fatal = errorMessage;
+            return false;
+        }
+        ++test.actions;
+        ++game.turns;
+        continueGame(test, client, pending.slot);
+        return true;
+    }
+    case model::WireMessage::SessionClosed:
+        ++test.finished;
+        test.winsA += game.state.status == model::GameStatus::WonByA ? 1 : 0;
+        test.winsB += game.state.status == model::GameStatus::WonByB ? 1 : 0;
+        if (test.started < test.games) {
+            requestCreate(test, client, pending.slot);
+        }
+        return true;
+    case model::WireMessage::Error: {
+        const QString message = reader.string();
+        ++test.errors;
+        if (pending.kind == RequestKind::Create) {
+            test.fatal = QStringLiteral("Cannot create session: %1").arg(message);
+            return false;
+        }
+        if (pending.kind == RequestKind::Close) {
+            ++test.finished;
+            if (test.started < test.games) {
+                requestCreate(test, client, pending.slot);
+            }
+        } else {
+            requestSession(test, client, pending.slot, RequestKind::Close);
+        }
+        return true;
+    }
+    default:
+        break;
+    }
+
+    test.fatal = QStringLiteral("Unexpected message type %1").arg(static_cast<int>(reader.type()));
+    return false;
+}
+
+qint64 percentile(const QVector<qint64> &sorted, double fraction)
+{
+    if (sorted.isEmpty()) {
+        return 0;
+    }
+    const int index = std::min(static_cast<int>(fraction * sorted.size()), static_cast<int>(sorted.size()) - 1);
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-loadtest"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Plays random games against undaunted-server over many connections and reports throughput and latency."));
+    parser.addHelpOption();
+
+    const QCommandLineOption tcpOption(QStringLiteral("tcp"), QStringLiteral("Server address."), QStringLiteral("host:port"), QStringLiteral("127.0.0.1:7345"));
+    const QCommandLineOption localOption(QStringLiteral("local"), QStringLiteral("Connect to this local socket name instead of TCP."), QStringLiteral("name"));
+    const QCommandLineOption connectionsOption(QStringLiteral("connections"), QStringLiteral("Client connections."), QStringLiteral("n"), QStringLiteral("32"));
+    const QCommandLineOption sessionsOption(QStringLiteral("sessions"), QStringLiteral("Concurrent games per connection."), QStringLiteral("n"), QStringLiteral("16"));
+    const QCommandLineOption gamesOption(QStringLiteral("games"), QStringLiteral("Games to play in total."), QStringLiteral("n"), QStringLiteral("2000"));
+    const QCommandLineOption mapOption(QStringLiteral("map"), QStringLiteral("Map name on the server; repeat to rotate maps."), QStringLiteral("name"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turns before a game is abandoned."), QStringLiteral("n"), QStringLiteral("300"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for session decks and action choice."), QStringLiteral("seed"), QStringLiteral("1"));
+    parser.addOption(tcpOption);
+    parser.addOption(localOption);
+    parser.addOption(connectionsOption);
+    parser.addOption(sessionsOption);
+    parser.addOption(gamesOption);
+    parser.addOption(mapOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(seedOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    LoadTest test;
+    test.maps = parser.isSet(mapOption) ? parser.values(mapOption) : QStringList{QStringLiteral("1")};
+    test.games = std::max(parser.value(gamesOption).toInt(), 1);
+    test.maxTurns = std::max(parser.value(maxTurnsOption).toInt(), 1);
+    test.seed = parser.value(seedOption).toUInt();
+    test.rng.seed(test.seed);
+    const int connections = std::max(parser.value(connectionsOption).toInt(), 1);
+    const int sessions = std::max(parser.value(sessionsOption).toInt(), 1);
+
+    const QString address = parser.value(tcpOption);
+    const int colon = address.lastIndexOf(QLatin1Char(':'));
+    const QString host = address.left(colon);
+    const quint16 port = static_cast<quint16>(address.mid(colon + 1).toUInt());
+    if (!parser.isSet(localOption) && (colon <= 0 || port == 0)) {
+        err << "invalid --tcp address: " << address << '\n';
+        return 1;
+    }
+
+    const auto finish = [&](int code) {
+        if (!test.fatal.isEmpty()) {
+            err << test.fatal << '\n';
+        }
+        app.exit(code);
+    };
+
+    std::vector<std::unique_ptr<SimulatedClient>> clients;
+    int connected = 0;
+    test.clock.start();
+    for (int c = 0; c < connections; ++c) {
+        auto client = std::make_unique<SimulatedClient>();
+        SimulatedClient *raw = client.get();
+        raw->gameSlots.resize(sessions);
+
+        const auto start = [&, raw]() {
+            ++connected;
+            model::WireWriter hello(model::WireMessage::Hello);
+            hello.u16(model::kWireVersion);
+            raw->socket->write(hello.frame());
+            for (int slot = 0; slot < raw->gameSlots.size() && test.started < test.games; ++slot) {
+                requestCreate(test, *raw, slot);
+            }
+        };
+        const auto lost = [&]() {
+            if (test.finished < test.games) {
+                test.fatal = QStringLiteral("Server closed the connection.");
+                finish(1);
+            }
+        };
+
+        if (parser.isSet(localOption)) {
+            auto *socket = new QLocalSocket(&app);
+            raw->socket = socket;
+            QObject::connect(socket, &QLocalSocket::connected, start);
+            QObject::connect(socket, &QLocalSocket::disconnected, lost);
+            QObject::connect(socket, &QLocalSocket::errorOccurred, [&, socket]() {
+                test.fatal = socket->errorString();
+                finish(1);
+            });
+            socket->connectToServer(parser.value(localOption));
+        } else {
+            auto *socket = new QTcpSocket(&app);
+            raw->socket = socket;
+            QObject::connect(socket, &QTcpSocket::connected, [socket, start]() {
+                socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+                start();
+            });
+            QObject::connect(socket, &QTcpSocket::disconnected, lost);
+            QObject::connect(socket, &QTcpSocket::errorOccurred, [&, socket]() {
+                test.fatal = socket->errorString();
+                finish(1);
+            });
+            socket->connectToHost(host, port);
+        }
+
+        QObject::connect(raw->socket, &QIODevice::readyRead, [&, raw]() {
+            const QByteArray incoming = raw->socket->readAll();
+            test.bytesIn += incoming.size();
+            raw->inbox.append(incoming);
+
+            int offset = 0;
+            QByteArray payload;
+            model::WireFrameStatus status;
+            while ((status = model::takeWireFrame(raw->inbox, offset, payload)) == model::WireFrameStatus::Ready) {
+                if (!handleFrame(test, *raw, payload)) {
+                    finish(1);
+                    return;
+                }
+            }
+            if (status == model::WireFrameStatus::Oversized) {
+                test.fatal = QStringLiteral("Oversized frame from server.");
+                finish(1);
+                return;
+            }
+            raw->inbox.remove(0, offset);
+
+            if (test.finished >= test.games) {
+                finish(0);
+            }
+        });
+        clients.push_back(std::move(client));
+    }
+
+    QTimer progress;
+    QObject::connect(&progress, &QTimer::timeout, [&]() {
+        err << "\r" << test.finished << '/' << test.games << " games, " << connected << " connections, "
+            << test.actions << " actions";
+        err.flush();
+    });
+    progress.start(1000);
+
+    const int code = app.exec();
+    const double seconds = std::max(test.clock.elapsed(), qint64(1)) / 1000.0;
+    err << '\n';
+    if (code != 0) {
+        return code;
+    }
+
+    std::sort(test.latenciesUs.begin(), test.latenciesUs.end());
+    out << test.finished << " games (A " << test.winsA << ", B " << test.winsB << ", unfinished "
+        << test.finished - test.winsA - test.winsB << "), " << test.actions << " actions in "
+        << QString::number(seconds, 'f', 2) << " s\n";
+    out << "throughput: " << qint64(test.actions / seconds) << " actions/s, " << qint64(test.latenciesUs.size() / seconds)
+        << " requests/s, " << QString::number(test.finished / seconds, 'f', 1) << " games/s\n";
+    out << "latency us: p50 " << percentile(test.latenciesUs, 0.50) << "  p90 " << percentile(test.latenciesUs, 0.90)
+        << "  p99 " << percentile(test.latenciesUs, 0.99) << "  max " << (test.latenciesUs.isEmpty() ? 0 : test.latenciesUs.last())
+        << '\n';
+    out << "traffic: sent " << test.bytesOut / 1024 << " KB, received " << test.bytesIn / 1024 << " KB, errors "
+        << test.errors << '\n';
+    return 0;
+}
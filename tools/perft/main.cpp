@@ -0,0 +1,92 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QTextStream>
+#include <QThread>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-perft"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Counts legal action sequences from a scenario start position."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("board"), QStringLiteral("Board file (src/assets/boards/*.txt)."));
+    parser.addPositionalArgument(QStringLiteral("scenario"), QStringLiteral("Scenario file (src/assets/maps/*.txt)."));
+
+    const QCommandLineOption depthOption(QStringLiteral("depth"), QStringLiteral("Plies to enumerate."), QStringLiteral("n"), QStringLiteral("3"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Worker threads for the root split (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption setupSeedOption(QStringLiteral("setup-seed"), QStringLiteral("Seed for the initial deck shuffle."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption drawsOption(QStringLiteral("draws"), QStringLiteral("Branch on every card type the next player could draw."));
+    const QCommandLineOption divideOption(QStringLiteral("divide"), QStringLiteral("Print the leaf count under each root action."));
+    parser.addOption(depthOption);
+    parser.addOption(threadsOption);
+    parser.addOption(setupSeedOption);
+    parser.addOption(drawsOption);
+    parser.addOption(divideOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    model::GameState state;
+    model::GameSession session(state);
+    session.setSeed(parser.value(setupSeedOption).toUInt());
+
+    QString errorMessage;
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), args[0], args[1], true, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::PerftOptions options;
+    options.depth = parser.value(depthOption).toInt();
+    options.threads = parser.value(threadsOption).toInt();
+    options.branchDraws = parser.isSet(drawsOption);
+
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    out << "start: " << model::playerIdName(state.turn.currentPlayer) << " to move, card "
+        << model::agentTypeName(state.turn.activeCard.agent) << ", draws "
+        << (options.branchDraws ? "branched" : "from deck order") << ", " << threads << " threads\n";
+
+    if (options.depth < 1) {
+        err << "perft failed: depth must be at least 1.\n";
+        return 1;
+    }
+    model::PerftResult result;
+    if (!model::runPerft(state, options, result, errorMessage)) {
+        err << "perft failed: " << errorMessage << '\n';
+        return 1;
+    }
+
+    if (parser.isSet(divideOption)) {
+        out << '\n';
+        for (const model::PerftBranch &branch : result.branches) {
+            out << branch.label << ": " << branch.counts.nodes.last() << '\n';
+        }
+        out << '\n';
+    }
+
+    // Per-ply counts from the one depth-N walk; the tree is walked depth
+    // first, so only the whole run has a meaningful time.
+    qint64 totalNodes = 0;
+    for (int depth = 0; depth < options.depth; ++depth) {
+        totalNodes += result.total.nodes[depth];
+        out << "depth " << (depth + 1) << "  nodes " << result.total.nodes[depth]
+            << "  terminal " << result.total.terminal[depth] << '\n';
+    }
+
+    const qint64 elapsedNs = std::max<qint64>(result.elapsedNs, 1);
+    out << "total " << totalNodes << " nodes  time " << QString::number(elapsedNs / 1e9, 'f', 3) << " s  "
+        << QString::number(totalNodes * 1e9 / elapsedNs, 'f', 0) << " nodes/s\n";
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+void printStats(QTextStream &out, const char *label, const model::PlayoutStats &stats, qint64 elapsedMs)
+{
+    if (stats.games == 0) {
+        out << label << ": no games played\n";
+        return;
+    }
+
+    const double games = static_cast<double>(stats.games);
+    const double rateA = stats.winsA / games;
+    const double margin = 1.96 * std::sqrt(rateA * (1.0 - rateA) / games);
+    const double seconds = std::max<qint64>(elapsedMs, 1) / 1000.0;
+
+    out << label << ": games " << stats.games
+        << "  A " << QString::number(rateA * 100.0, 'f', 2) << "% (+/-" << QString::number(margin * 100.0, 'f', 2) << ")"
+        << "  B " << QString::number(stats.winsB * 100.0 / games, 'f', 2) << "%"
+        << "  unfinished " << QString::number(stats.unfinished * 100.0 / games, 'f', 2) << "%"
+        << "  avg turns " << QString::number(stats.totalTurns / games, 'f', 1)
+        << "  " << QString::number(games / seconds, 'f', 0) << " games/s\n";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-playout"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Batched random playouts from a board/scenario start position."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("board"), QStringLiteral("Board file (src/assets/boards/*.txt)."));
+    parser.addPositionalArgument(QStringLiteral("scenario"), QStringLiteral("Scenario file (src/assets/maps/*.txt)."));
+
+    const QCommandLineOption gamesOption(QStringLiteral("games"), QStringLiteral("Number of playouts."), QStringLiteral("n"), QStringLiteral("100000"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Playout RNG seed."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption setupSeedOption(QStringLiteral("setup-seed"), QStringLiteral("Seed for the initial deck shuffle."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turn limit per game."), QStringLiteral("n"), QStringLiteral("400"));
+    const QCommandLineOption reshuffleOption(QStringLiteral("reshuffle"), QStringLiteral("Reshuffle both decks before every game."));
+    const QCommandLineOption referenceOption(QStringLiteral("reference"), QStringLiteral("Also run the same playouts through the engine for comparison."));
+    parser.addOption(gamesOption);
+    parser.addOption(seedOption);
+    parser.addOption(setupSeedOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(reshuffleOption);
+    parser.addOption(referenceOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    model::GameState state;
+    model::GameSession session(state);
+    session.setSeed(parser.value(setupSeedOption).toUInt());
+
+    QString errorMessage;
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), args[0], args[1], true, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::PackedBoard board;
+    model::PackedState packed;
+    if (!model::buildPackedBoard(state.board, board, errorMessage) ||
+        !model::packGameState(state, board, packed, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::PlayoutOptions options;
+    options.games = parser.value(gamesOption).toLongLong();
+    options.seed = parser.value(seedOption).toULongLong();
+    options.maxTurns = parser.value(maxTurnsOption).toInt();
+    options.reshuffleDecks = parser.isSet(reshuffleOption);
+    if (options.games <= 0 || options.maxTurns <= 0) {
+        err << "--games and --max-turns must be positive.\n";
+        return 1;
+    }
+
+    out << "backend " << model::playoutSimdBackend() << ", " << model::kPlayoutLanes << " lanes\n";
+
+    QElapsedTimer timer;
+    timer.start();
+    const model::PlayoutStats batch = model::runBatchPlayouts(board, packed, options);
+    printStats(out, "batch ", batch, timer.elapsed());
+
+    if (parser.isSet(referenceOption)) {
+        timer.restart();
+        const model::PlayoutStats engine = model::runEnginePlayouts(state, options);
+        printStats(out, "engine", engine, timer.elapsed());
+    }
+
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+namespace {
+
+const char *statusName(model::GameStatus status)
+{
+    switch (status) {
+    case model::GameStatus::WonByA:
+        return "A wins";
+    case model::GameStatus::WonByB:
+        return "B wins";
+    case model::GameStatus::InProgress:
+        break;
+    }
+    return "unfinished";
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-replay"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Verifies, lists and prints games from replay journals."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("journal"), QStringLiteral("Journal files written by undaunted-server --journal."), QStringLiteral("journal..."));
+
+    const QCommandLineOption listOption(QStringLiteral("list"), QStringLiteral("List the games instead of verifying them."));
+    const QCommandLineOption gameOption(QStringLiteral("game"), QStringLiteral("Print the actions of one game."), QStringLiteral("id"));
+    const QCommandLineOption sessionOption(QStringLiteral("session"), QStringLiteral("Also replay every game through GameSession commands."));
+    parser.addOption(listOption);
+    parser.addOption(gameOption);
+    const QCommandLineOption timelineOption(QStringLiteral("timeline"), QStringLiteral("Also build seek timelines and time random seeks."));
+    parser.addOption(sessionOption);
+    parser.addOption(timelineOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList journals = parser.positionalArguments();
+    if (journals.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    // Load everything first so the timing below covers replay only.
+    QVector<model::ReplayGame> games;
+    QString errorMessage;
+    bool damaged = false;
+    for (const QString &path : journals) {
+        model::ReplayJournalReader reader;
+        if (!reader.open(path, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        model::ReplayGame game;
+        while (reader.next(game, errorMessage)) {
+            games.append(std::move(game));
+            game = model::ReplayGame();
+        }
+        if (!errorMessage.isEmpty()) {
+            err << path << ": " << errorMessage << '\n';
+            damaged = true;
+        }
+    }
+
+    if (parser.isSet(listOption)) {
+        for (const model::ReplayGame &game : games) {
+            out << "game " << game.id << "  seed " << game.seed << "  " << game.scenarioPath << "  "
+                << game.actions.size() << " actions  " << statusName(game.finalStatus) << '\n';
+        }
+        return damaged ? 1 : 0;
+    }
+
+    if (parser.isSet(gameOption)) {
+        const quint64 id = parser.value(gameOption).toULongLong();
+        const auto found = std::find_if(games.cbegin(), games.cend(), [id](const model::ReplayGame &game) {
+            return game.id == id;
+        });
+        if (found == games.cend()) {
+            err << "No game " << id << " in the journal.\n";
+            return 1;
+        }
+
+        model::PackedBoard board;
+        model::PackedState state;
+        if (!model::packReplayStart(*found, board, state, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        out << "game " << found->id << "  seed " << found->seed << "  " << found->boardPath << "  " << found->scenarioPath << '\n';
+        for (int i = 0; i < found->actions.size(); ++i) {
+            const model::ReplayAction &action = found->actions[i];
+            out << (i + 1) << ". " << (state.currentSide == 0 ? 'A' : 'B') << ' '
+                << model::agentTypeName(static_cast<model::AgentType>(state.activeCard)) << ' '
+                << model::replayActionText(board, action) << '\n';
+
+            if (!model::applyReplayAction(board, state, action, errorMessage)) {
+                err << "action " << (i + 1) << ": " << errorMessage << '\n';
+                return 1;
+            }
+        }
+        out << statusName(found->finalStatus) << '\n';
+        return 0;
+    }
+
+    model::ReplayStartCache starts;
+    qint64 actions = 0;
+    int failures = 0;
+    QElapsedTimer timer;
+    timer.start();
+    for (const model::ReplayGame &game : games) {
+        model::PackedState state;
+        const model::PackedBoard *board = starts.start(game, state, errorMessage);
+        if (board == nullptr) {
+            err << "game " << game.id << ": " << errorMessage << '\n';
+            errorMessage.clear();
+            ++failures;
+            continue;
+        }
+
+        if (!model::replayPacked(*board, game, state, -1, errorMessage) || state.status != game.finalStatus) {
+            err << "game " << game.id << ": "
+                << (errorMessage.isEmpty() ? QStringLiteral("final status differs from the journal.") : errorMessage) << '\n';
+            errorMessage.clear();
+            ++failures;
+            continue;
+        }
+        actions += game.actions.size();
+    }
+    const qint64 elapsedNs = std::max<qint64>(timer.nsecsElapsed(), 1);
+
+    out << games.size() << " games, " << actions << " actions, " << failures << " failed\n";
+    out << "packed replay " << QString::number(elapsedNs / 1e6, 'f', 1) << " ms  "
+        << QString::number(actions * 1e9 / elapsedNs, 'f', 0) << " actions/s\n";
+
+    if (parser.isSet(sessionOption)) {
+        timer.restart();
+        for (const model::ReplayGame &game : games) {
+            model::GameState state;
+            model::GameSession session(state);
+            if (!model::loadReplayStart(session, game, errorMessage) ||
+                !model::replayIntoSession(session, game, -1, errorMessage)) {
+                err << "game " << game.id << " (session): " << errorMessage << '\n';
+                ++failures;
+            }
+        }
+        const qint64 sessionNs = std::max<qint64>(timer.nsecsElapsed(), 1);
+        out << "session replay " << QString::number(sessionNs / 1e6, 'f', 1) << " ms  "
+            << QString::number(actions * 1e9 / sessionNs, 'f', 0) << " actions/s\n";
+    }
+
+    if (parser.isSet(timelineOption)) {
+        QRandomGenerator random(1);
+        qint64 buildNs = 0;
+        qint64 seekNs = 0;
+        qint64 seeks = 0;
+        qint64 bytes = 0;
+        for (const model::ReplayGame &game : games) {
+            model::PackedBoard board;
+            model::PackedState start;
+            if (!model::packReplayStart(game, board, start, errorMessage)) {
+                continue;
+            }
+            model::ReplayTimeline timeline;
+            timer.restart();
+            if (!timeline.build(board, start, game, errorMessage)) {
+                continue;
+            }
+            buildNs += timer.nsecsElapsed();
+            bytes += timeline.memoryBytes();
+
+            timer.restart();
+            for (int i = 0; i < 1000; ++i) {
+                timeline.seek(random.bounded(timeline.length() + 1));
+            }
+            seekNs += timer.nsecsElapsed();
+            seeks += 1000;
+        }
+        out << "timelines: build " << QString::number(buildNs / 1e6, 'f', 1) << " ms, "
+            << bytes / std::max<qsizetype>(games.size(), 1) << " bytes/game, random seek "
+            << QString::number(double(seekNs) / std::max<qint64>(seeks, 1), 'f', 0) << " ns\n";
+    }
+
+    return failures == 0 && !damaged ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QTextStream>
+#include <QTimer>
+
+#include "server/GameServer.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-server"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Headless game server: hosts many game sessions over TCP or a local socket using the binary wire protocol."));
+    parser.addHelpOption();
+
+    const QCommandLineOption tcpOption(QStringLiteral("tcp"), QStringLiteral("Listen on this TCP port (default 7345 when --local is not given)."), QStringLiteral("port"));
+    const QCommandLineOption hostOption(QStringLiteral("host"), QStringLiteral("Address to bind for TCP."), QStringLiteral("address"), QStringLiteral("127.0.0.1"));
+    const QCommandLineOption localOption(QStringLiteral("local"), QStringLiteral("Listen on this local socket name."), QStringLiteral("name"));
+    const QCommandLineOption assetsOption(QStringLiteral("assets"), QStringLiteral("Directory with boards/ and maps/."), QStringLiteral("dir"), QStringLiteral("src/assets"));
+    const QCommandLineOption workersOption(QStringLiteral("workers"), QStringLiteral("Worker threads (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption maxSessionsOption(QStringLiteral("max-sessions"), QStringLiteral("Open sessions allowed per connection."), QStringLiteral("n"), QStringLiteral("1024"));
+    const QCommandLineOption statsOption(QStringLiteral("stats"), QStringLiteral("Print counters every n seconds (0 = never)."), QStringLiteral("n"), QStringLiteral("5"));
+    const QCommandLineOption journalOption(QStringLiteral("journal"), QStringLiteral("Record every session into replay journals in this directory."), QStringLiteral("dir"));
+    parser.addOption(tcpOption);
+    parser.addOption(hostOption);
+    parser.addOption(localOption);
+    parser.addOption(assetsOption);
+    parser.addOption(workersOption);
+    parser.addOption(maxSessionsOption);
+    parser.addOption(statsOption);
+    parser.addOption(journalOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    GameServerOptions options;
+    options.assetsDir = parser.value(assetsOption);
+    options.workers = parser.value(workersOption).toInt();
+    options.maxSessionsPerConnection = std::max(parser.value(maxSessionsOption).toInt(), 1);
+    options.journalDir = parser.value(journalOption);
+
+    GameServer server(options);
+    QString errorMessage;
+    if (!server.start(errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    const bool useTcp = parser.isSet(tcpOption) || !parser.isSet(localOption);
+    if (useTcp) {
+        const QHostAddress address(parser.value(hostOption));
+        const quint16 port = static_cast<quint16>(parser.isSet(tcpOption) ? parser.value(tcpOption).toUInt() : 7345);
+        if (!server.listenTcp(address, port, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        out << "listening on " << address.toString() << ':' << server.tcpPort() << '\n';
+    }
+    if (parser.isSet(localOption)) {
+        if (!server.listenLocal(parser.value(localOption), errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        out << "listening on local socket " << parser.value(localOption) << '\n';
+    }
+    out << server.workerCount() << " workers, maps: " << server.mapNames().join(QStringLiteral(", ")) << '\n';
+    if (!options.journalDir.isEmpty()) {
+        out << "recording games to " << options.journalDir << '\n';
+    }
+    out.flush();
+
+    QTimer statsTimer;
+    GameServerStats previous;
+    const int statsSeconds = parser.value(statsOption).toInt();
+    QObject::connect(&statsTimer, &QTimer::timeout, [&]() {
+        const GameServerStats now = server.stats();
+        out << "connections " << now.connections << "  sessions " << now.sessions
+            << "  frames/s " << (now.frames - previous.frames) / statsSeconds
+            << "  in KB/s " << (now.bytesIn - previous.bytesIn) / 1024 / statsSeconds
+            << "  out KB/s " << (now.bytesOut - previous.bytesOut) / 1024 / statsSeconds
+            << "  paused " << now.pausedConnections << '\n';
+        out.flush();
+        previous = now;
+    });
+    if (statsSeconds > 0) {
+        statsTimer.start(statsSeconds * 1000);
+    }
+
+    return app.exec();
+}
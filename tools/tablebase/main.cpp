@@ -0,0 +1,133 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QTextStream>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-tablebase"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Solves single-agent endgames reached from a scenario and writes a tablebase."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("board"), QStringLiteral("Board file (src/assets/boards/*.txt)."));
+    parser.addPositionalArgument(QStringLiteral("scenario"), QStringLiteral("Scenario file (src/assets/maps/*.txt)."));
+
+    const QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("Output file (default: <board>.udtb next to the board)."), QStringLiteral("path"));
+    const QCommandLineOption gamesOption(QStringLiteral("games"), QStringLiteral("Random games played to collect endgame positions."), QStringLiteral("n"), QStringLiteral("500"));
+    const QCommandLineOption maxCardsOption(QStringLiteral("max-cards"), QStringLiteral("Largest card count per side that is covered."), QStringLiteral("n"), QStringLiteral("3"));
+    const QCommandLineOption maxStatesOption(QStringLiteral("max-states"), QStringLiteral("Upper bound on solved positions."), QStringLiteral("n"), QStringLiteral("1000000"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for the random games."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption setupSeedOption(QStringLiteral("setup-seed"), QStringLiteral("Seed for the initial deck shuffle."), QStringLiteral("seed"), QStringLiteral("1"));
+    parser.addOption(outOption);
+    parser.addOption(gamesOption);
+    parser.addOption(maxCardsOption);
+    parser.addOption(maxStatesOption);
+    parser.addOption(seedOption);
+    parser.addOption(setupSeedOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList args = parser.positionalArguments();
+    if (args.size() != 2) {
+        parser.showHelp(1);
+    }
+
+    model::GameState state;
+    model::GameSession session(state);
+    session.setSeed(parser.value(setupSeedOption).toUInt());
+
+    QString errorMessage;
+    if (!session.initializeNewBattle(QStringLiteral("A"), QStringLiteral("B"), args[0], args[1], true, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::PackedBoard board;
+    model::PackedState start;
+    if (!model::buildPackedBoard(state.board, board, errorMessage) ||
+        !model::packGameState(state, board, start, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::EndgameSolveOptions options;
+    options.maxCards = std::clamp(parser.value(maxCardsOption).toInt(), 1, model::kMaxDeckCards);
+    options.maxStates = std::max(parser.value(maxStatesOption).toInt(), 1);
+    options.maxSeedStates = std::min(options.maxSeedStates, options.maxStates);
+    model::EndgameSolver solver(board, options);
+
+    // Random games from the scenario start; every covered position met on
+    // the way becomes a seed, so marks and control look like real play.
+    const int games = std::max(parser.value(gamesOption).toInt(), 0);
+    QRandomGenerator rng(parser.value(seedOption).toUInt());
+    qint64 endgamesSeen = 0;
+    for (int game = 0; game < games; ++game) {
+        model::PackedState current = start;
+        for (int turn = 0; turn < 1000 && current.status == model::GameStatus::InProgress; ++turn) {
+            if (model::isEndgamePosition(current, options.maxCards)) {
+                ++endgamesSeen;
+                solver.addSeed(current);
+                break;
+            }
+
+            model::PackedAction actions[model::kMaxPackedActions];
+            const int count = model::packedLegalActions(board, current, actions);
+            if (count == 0) {
+                break;
+            }
+            const model::PackedAction &action = actions[rng.bounded(count)];
+            bool hit = false;
+            if (action.kind == model::PackedActionKind::Attack) {
+                const int threshold = model::packedAttackThreshold(board, current, action);
+                hit = int(rng.bounded(1000)) < model::attackHitChance(model::packedAttackDice(current.activeCard), threshold);
+            }
+            model::applyPackedAction(board, current, action, hit);
+            if (current.status != model::GameStatus::InProgress) {
+                break;
+            }
+            model::endPackedTurn(current);
+            model::drawPackedCard(current);
+        }
+    }
+
+    const model::EndgameSolveStats &collected = solver.stats();
+    out << "games " << games << "  endgames " << endgamesSeen << "  seeds " << collected.seeds
+        << "  skipped " << collected.skippedSeeds << "  states " << collected.states << '\n';
+    if (collected.states == 0) {
+        err << "no endgame positions to solve\n";
+        return 1;
+    }
+
+    solver.solve();
+    const model::EndgameSolveStats &solved = solver.stats();
+    out << "iterations " << solved.iterations << "  residual " << QString::number(solved.residual, 'g', 3)
+        << "  time " << QString::number(solved.elapsedMs / 1000.0, 'f', 3) << " s\n";
+
+    QString outPath = parser.value(outOption);
+    if (outPath.isEmpty()) {
+        const QFileInfo boardInfo(args[0]);
+        outPath = boardInfo.dir().filePath(boardInfo.completeBaseName() + QStringLiteral(".udtb"));
+    }
+    if (!model::writeTablebase(outPath, board, options.maxCards, solver.entries(), errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::Tablebase tablebase;
+    if (!tablebase.open(outPath, board, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+    out << "wrote " << tablebase.size() << " positions to " << outPath << '\n';
+    return 0;
+}
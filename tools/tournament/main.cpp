@@ -0,0 +1,202 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QTextStream>
+#include <QThread>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+#include <numeric>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-tournament"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Round-robin tournament between bot configurations on every given map."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("scenarios"), QStringLiteral("Scenario files (src/assets/maps/*.txt); boards are looked up in ../boards."), QStringLiteral("scenario..."));
+
+    const QCommandLineOption botOption(QStringLiteral("bot"), QStringLiteral("Bot spec, repeat per bot: name=x[,weights=path][,net=path][,depth=n][,time=ms]."), QStringLiteral("spec"));
+    const QCommandLineOption roundsOption(QStringLiteral("rounds"), QStringLiteral("Deals per bot pair and map (each played in both seatings)."), QStringLiteral("n"), QStringLiteral("2"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turns before a game counts as a draw."), QStringLiteral("n"), QStringLiteral("300"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Games played at once (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Seed for decks and dice."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption gamesOutOption(QStringLiteral("games-out"), QStringLiteral("Write every game as CSV."), QStringLiteral("path"));
+    parser.addOption(botOption);
+    parser.addOption(roundsOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(gamesOutOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList scenarios = parser.positionalArguments();
+    const QStringList botSpecs = parser.values(botOption);
+    if (scenarios.isEmpty() || botSpecs.size() < 2) {
+        err << "need at least one scenario and two --bot options\n";
+        parser.showHelp(1);
+    }
+
+    QString errorMessage;
+    QVector<model::BotConfig> bots;
+    for (const QString &spec : botSpecs) {
+        model::BotConfig bot;
+        if (!model::parseBotConfig(spec, bot, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        bots.append(bot);
+    }
+
+    QVector<model::SelfPlayOpening> maps;
+    for (const QString &scenario : scenarios) {
+        const QFileInfo scenarioInfo(scenario);
+        const QString board = scenarioInfo.dir().filePath(QStringLiteral("../boards/") + scenarioInfo.fileName());
+        model::SelfPlayOpening opening;
+        if (!model::loadSelfPlayOpening(board, scenario, 1, opening, errorMessage)) {
+            err << scenario << ": " << errorMessage << '\n';
+            return 1;
+        }
+        maps.append(opening);
+    }
+    if (!model::checkBotMaps(maps, bots, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::TournamentOptions options;
+    options.rounds = std::max(parser.value(roundsOption).toInt(), 1);
+    options.maxTurns = std::max(parser.value(maxTurnsOption).toInt(), 1);
+    options.threads = parser.value(threadsOption).toInt();
+    options.seed = parser.value(seedOption).toUInt();
+
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    out << bots.size() << " bots, " << maps.size() << " maps, " << threads << " threads\n";
+    out.flush();
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<model::TournamentGame> games = model::runTournament(maps, bots, options, [&](int finished, int total) {
+        if (finished % 50 == 0 || finished == total) {
+            err << "\r" << finished << '/' << total << " games";
+            if (finished == total) {
+                err << '\n';
+            }
+            err.flush();
+        }
+    });
+    const model::TournamentRatings ratings = model::rateTournament(games, bots.size());
+
+    const auto percent = [](double value) {
+        return QString::number(value * 100.0, 'f', 1);
+    };
+
+    QVector<int> order(bots.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return ratings.bots[a].elo > ratings.bots[b].elo;
+    });
+
+    int nameWidth = 4;
+    for (const model::BotConfig &bot : bots) {
+        nameWidth = std::max(nameWidth, int(bot.name.size()));
+    }
+
+    out << "\nrank  " << QStringLiteral("bot").leftJustified(nameWidth) << "   elo     +/-   games  score\n";
+    for (int rank = 0; rank < order.size(); ++rank) {
+        const model::BotRating &rating = ratings.bots[order[rank]];
+        out << QString::number(rank + 1).leftJustified(4) << "  " << bots[order[rank]].name.leftJustified(nameWidth)
+            << "  " << QString::number(rating.elo, 'f', 0).rightJustified(5) << "  " << QString::number(rating.error, 'f', 0).rightJustified(5)
+            << "  " << QString::number(rating.games).rightJustified(6) << "  " << percent(rating.score) << "%\n";
+    }
+    out << "first move (side A): " << QString::number(ratings.firstMoveElo, 'f', 0) << " elo\n";
+
+    // Crosstable: row bot's score against the column bot.
+    out << "\ncrosstable (row score %)\n" << QString().leftJustified(nameWidth);
+    for (int column : order) {
+        out << "  " << bots[column].name.left(8).rightJustified(8);
+    }
+    out << '\n';
+    for (int row : order) {
+        out << bots[row].name.leftJustified(nameWidth);
+        for (int column : order) {
+            double total = 0.0;
+            int played = 0;
+            for (const model::TournamentGame &game : games) {
+                if ((game.botA == row && game.botB == column) || (game.botA == column && game.botB == row)) {
+                    total += model::tournamentScore(game, row);
+                    ++played;
+                }
+            }
+            out << "  " << (row == column || played == 0 ? QStringLiteral("-") : percent(total / played)).rightJustified(8);
+        }
+        out << '\n';
+    }
+
+    // Per map: each bot's score, plus how often side A won there.
+    out << "\nper map (score %)\n" << QStringLiteral("map").leftJustified(8);
+    for (int bot : order) {
+        out << "  " << bots[bot].name.left(8).rightJustified(8);
+    }
+    out << "    A wins  draws\n";
+    for (int map = 0; map < maps.size(); ++map) {
+        out << maps[map].name.leftJustified(8);
+        for (int bot : order) {
+            double total = 0.0;
+            int played = 0;
+            for (const model::TournamentGame &game : games) {
+                const double score = model::tournamentScore(game, bot);
+                if (game.map == map && score >= 0.0) {
+                    total += score;
+                    ++played;
+                }
+            }
+            out << "  " << percent(played > 0 ? total / played : 0.0).rightJustified(8);
+        }
+        int mapGames = 0;
+        int winsA = 0;
+        int draws = 0;
+        for (const model::TournamentGame &game : games) {
+            if (game.map != map) {
+                continue;
+            }
+            ++mapGames;
+            winsA += game.result.status == model::GameStatus::WonByA ? 1 : 0;
+            draws += game.result.status == model::GameStatus::InProgress ? 1 : 0;
+        }
+        out << "    " << (percent(double(winsA) / std::max(mapGames, 1)) + '%').rightJustified(6)
+            << "  " << QString::number(draws).rightJustified(5) << '\n';
+    }
+    out << "\n" << games.size() << " games in " << QString::number(timer.elapsed() / 1000.0, 'f', 1) << " s\n";
+
+    if (parser.isSet(gamesOutOption)) {
+        QSaveFile file(parser.value(gamesOutOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << "Cannot write games: " << parser.value(gamesOutOption) << '\n';
+            return 1;
+        }
+        QTextStream csv(&file);
+        csv << "map,round,seed,bot_a,bot_b,result,turns\n";
+        for (const model::TournamentGame &game : games) {
+            const QString result = game.result.status == model::GameStatus::WonByA ? QStringLiteral("1-0")
+                : game.result.status == model::GameStatus::WonByB ? QStringLiteral("0-1") : QStringLiteral("1/2");
+            csv << maps[game.map].name << ',' << game.round << ',' << game.seed << ',' << bots[game.botA].name << ','
+                << bots[game.botB].name << ',' << result << ',' << game.result.turns << '\n';
+        }
+        csv.flush();
+        if (!file.commit()) {
+            err << "Failed to write games: " << parser.value(gamesOutOption) << '\n';
+            return 1;
+        }
+    }
+    return 0;
+}
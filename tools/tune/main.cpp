@@ -0,0 +1,172 @@
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QThread>
+
+#include "game/GameModel.h"
+
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("undaunted-tune"));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Tunes evaluation weights with SPSA over parallel self-play games."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("scenarios"), QStringLiteral("Scenario files (src/assets/maps/*.txt); boards are looked up in ../boards."), QStringLiteral("scenario..."));
+
+    const QCommandLineOption weightsOption(QStringLiteral("weights"), QStringLiteral("Starting weights."), QStringLiteral("path"), QStringLiteral("src/assets/eval/default.txt"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Total SPSA iterations, including resumed ones."), QStringLiteral("n"), QStringLiteral("100"));
+    const QCommandLineOption pairsOption(QStringLiteral("pairs"), QStringLiteral("Game pairs per iteration (both seatings each)."), QStringLiteral("n"), QStringLiteral("16"));
+    const QCommandLineOption depthOption(QStringLiteral("depth"), QStringLiteral("Search depth of both players."), QStringLiteral("n"), QStringLiteral("2"));
+    const QCommandLineOption maxTurnsOption(QStringLiteral("max-turns"), QStringLiteral("Turns before a game is scored as a draw."), QStringLiteral("n"), QStringLiteral("300"));
+    const QCommandLineOption setupsOption(QStringLiteral("setups"), QStringLiteral("Deck shuffles (setup seeds 1..n) per scenario."), QStringLiteral("n"), QStringLiteral("4"));
+    const QCommandLineOption threadsOption(QStringLiteral("threads"), QStringLiteral("Worker threads (0 = all cores)."), QStringLiteral("n"), QStringLiteral("0"));
+    const QCommandLineOption seedOption(QStringLiteral("seed"), QStringLiteral("Run seed."), QStringLiteral("seed"), QStringLiteral("1"));
+    const QCommandLineOption rateOption(QStringLiteral("rate"), QStringLiteral("SPSA step size a."), QStringLiteral("a"), QStringLiteral("4.0"));
+    const QCommandLineOption checkpointOption(QStringLiteral("checkpoint"), QStringLiteral("Checkpoint file, rewritten after every iteration."), QStringLiteral("path"), QStringLiteral("tune.ckpt"));
+    const QCommandLineOption resumeOption(QStringLiteral("resume"), QStringLiteral("Continue from the checkpoint file."));
+    const QCommandLineOption outOption(QStringLiteral("out"), QStringLiteral("Tuned weights file."), QStringLiteral("path"), QStringLiteral("tuned.txt"));
+    parser.addOption(weightsOption);
+    parser.addOption(iterationsOption);
+    parser.addOption(pairsOption);
+    parser.addOption(depthOption);
+    parser.addOption(maxTurnsOption);
+    parser.addOption(setupsOption);
+    parser.addOption(threadsOption);
+    parser.addOption(seedOption);
+    parser.addOption(rateOption);
+    parser.addOption(checkpointOption);
+    parser.addOption(resumeOption);
+    parser.addOption(outOption);
+    parser.process(app);
+
+    QTextStream out(stdout);
+    QTextStream err(stderr);
+
+    const QStringList scenarios = parser.positionalArguments();
+    if (scenarios.isEmpty()) {
+        parser.showHelp(1);
+    }
+
+    QString errorMessage;
+    QStringList openingFiles;
+    for (const QString &scenario : scenarios) {
+        const QFileInfo scenarioInfo(scenario);
+        openingFiles << scenarioInfo.dir().filePath(QStringLiteral("../boards/") + scenarioInfo.fileName()) << scenario;
+    }
+    QString openingsDigest;
+    if (!model::spsaOpeningsDigest(openingFiles, openingsDigest, errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+
+    model::SpsaOptions options;
+    options.gamePairs = std::max(parser.value(pairsOption).toInt(), 1);
+    options.depth = std::max(parser.value(depthOption).toInt(), 1);
+    options.maxTurns = std::max(parser.value(maxTurnsOption).toInt(), 1);
+    options.setups = std::max(parser.value(setupsOption).toInt(), 1);
+    options.threads = parser.value(threadsOption).toInt();
+    options.learningRate = parser.value(rateOption).toDouble();
+
+    const QString checkpointPath = parser.value(checkpointOption);
+    model::SpsaState state;
+    if (parser.isSet(resumeOption)) {
+        if (!model::loadSpsaCheckpoint(checkpointPath, state, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        // Flags left out take the checkpoint's values; flags given must
+        // match them, or the resumed run would not be the one checkpointed.
+        model::SpsaOptions requested = state.options;
+        if (parser.isSet(pairsOption)) {
+            requested.gamePairs = options.gamePairs;
+        }
+        if (parser.isSet(depthOption)) {
+            requested.depth = options.depth;
+        }
+        if (parser.isSet(maxTurnsOption)) {
+            requested.maxTurns = options.maxTurns;
+        }
+        if (parser.isSet(setupsOption)) {
+            requested.setups = options.setups;
+        }
+        if (parser.isSet(rateOption)) {
+            requested.learningRate = options.learningRate;
+        }
+        QStringList differences = model::spsaOptionDifferences(state.options, requested);
+        if (parser.isSet(seedOption) && parser.value(seedOption).toUInt() != state.seed) {
+            differences.append(QStringLiteral("seed"));
+        }
+        if (openingsDigest != state.openings) {
+            differences.append(QStringLiteral("scenarios"));
+        }
+        if (!differences.isEmpty()) {
+            err << checkpointPath << " was started with other " << differences.join(QStringLiteral(", "))
+                << "; resume it with the same scenarios and without those flags, or start a new run without --resume.\n";
+            return 1;
+        }
+        const int threadCount = options.threads;
+        options = state.options;
+        options.threads = threadCount;
+        out << "resumed " << checkpointPath << " at iteration " << state.history.size()
+            << ", seed " << state.seed << '\n';
+    } else {
+        model::EvalWeights initial;
+        if (!model::loadEvalWeights(initial, parser.value(weightsOption), errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+        state = model::startSpsa(initial, parser.value(seedOption).toUInt(), options);
+        state.openings = openingsDigest;
+    }
+
+    QVector<model::SelfPlayOpening> openings;
+    for (int i = 0; i < scenarios.size(); ++i) {
+        for (int setup = 1; setup <= options.setups; ++setup) {
+            model::SelfPlayOpening opening;
+            if (!model::loadSelfPlayOpening(openingFiles[2 * i], scenarios[i], quint32(setup), opening, errorMessage)) {
+                err << scenarios[i] << ": " << errorMessage << '\n';
+                return 1;
+            }
+            openings.append(opening);
+        }
+    }
+
+    const int threads = options.threads > 0 ? options.threads : QThread::idealThreadCount();
+    out << openings.size() << " openings, " << options.gamePairs * 2 << " games per iteration, depth "
+        << options.depth << ", " << threads << " threads\n";
+
+    const int iterations = parser.value(iterationsOption).toInt();
+    QElapsedTimer timer;
+    timer.start();
+    while (state.history.size() < iterations) {
+        const model::SpsaIteration record = model::runSpsaIteration(openings, options, state);
+        if (!model::saveSpsaCheckpoint(checkpointPath, state, errorMessage)) {
+            err << errorMessage << '\n';
+            return 1;
+        }
+
+        const QVector<int> values = model::evalWeightValues(model::spsaWeights(state));
+        QStringList weights;
+        for (int i = 0; i < values.size(); ++i) {
+            weights.append(QStringLiteral("%1=%2").arg(state.keys[i]).arg(values[i]));
+        }
+        out << "iter " << record.iteration << "  seed " << record.seed << "  +" << record.plusWins
+            << " -" << record.minusWins << " =" << record.draws << "  " << weights.join(QLatin1Char(' '))
+            << "  (" << QString::number(timer.elapsed() / 1000.0, 'f', 1) << " s)\n";
+        out.flush();
+    }
+
+    if (!model::saveEvalWeights(model::spsaWeights(state), parser.value(outOption), errorMessage)) {
+        err << errorMessage << '\n';
+        return 1;
+    }
+    out << "wrote " << parser.value(outOption) << '\n';
+    return 0;
+}